@@ -0,0 +1,53 @@
+/*
+*	FILE:			bench.h
+*	ASSIGNMENT:	The "Histogram System"
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This header file defines the interface for histo-bench, which
+*                 times the building blocks of the pipeline one at a time: the
+*                 circular buffer calls, the semaphore and DC's counting loop.
+*                 Each benchmark is a body that runs a given number of operations
+*                 and is called once to warm up, then once per repetition.
+*/
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "circular_buffer.h"
+
+#define BENCH_MAX_REPS 100
+#define BENCH_MAX_PROCS 4
+
+typedef struct {
+    CircularBuffer *cb;            /* the ring under test */
+    int sem_id;                    /* its semaphore, -1 for a private ring */
+    int size;                      /* bytes per operation, 0 if not byte-sized */
+    int procs;                     /* processes taking part */
+    char data[BUFFER_SIZE];        /* letters to write or decode */
+    char out[BUFFER_SIZE];         /* scratch space for reads */
+    uint64_t counts[CHAR_END - CHAR_START + 1];
+} BenchCtx;
+
+/* Runs 'ops' operations and returns how many it ran */
+typedef uint64_t (*BenchBody)(BenchCtx *ctx, uint64_t ops);
+
+uint64_t bench_now_ns(void);
+uint64_t bench_cycles(void);
+int bench_run(const char *name, BenchBody body, BenchCtx *ctx, uint64_t ops, int reps);
+void bench_header(FILE *out);
+int bench_all(uint64_t ops, int reps, const char *filter);
+void bench_usage(const char *prog);
+
+uint64_t bench_write_char(BenchCtx *ctx, uint64_t ops);
+uint64_t bench_write_multi(BenchCtx *ctx, uint64_t ops);
+uint64_t bench_read_multi(BenchCtx *ctx, uint64_t ops);
+uint64_t bench_free_space(BenchCtx *ctx, uint64_t ops);
+uint64_t bench_lock_unlock(BenchCtx *ctx, uint64_t ops);
+uint64_t bench_transfer(BenchCtx *ctx, uint64_t ops);
+uint64_t bench_count(BenchCtx *ctx, uint64_t ops);
+uint64_t bench_count_packed(BenchCtx *ctx, uint64_t ops);
+
+#endif /* BENCH_H */
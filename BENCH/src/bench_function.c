@@ -0,0 +1,595 @@
+/*
+*	FILE:			bench_function.c
+*	ASSIGNMENT:	The "Histogram System"
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This file implements histo-bench. The circular buffer and
+*					semaphore benchmarks call the common objects the programs link,
+*					so a change there shows up here as built. The counting
+*					benchmarks run rec_decode and the tally loops DC counts with, from
+*					the same common object.
+*
+*					Times are wall-clock nanoseconds from CLOCK_MONOTONIC. Cycles are
+*					x86 time-stamp counter ticks; elsewhere those columns show "-".
+*/
+
+#include <time.h>
+#include <sched.h>
+#include <sys/wait.h>
+#include "../../common/inc/constants.h"
+#include "../../common/inc/ipc_utils.h"
+#include "../../common/inc/record.h"
+#include "../../common/inc/tally.h"
+#include "../inc/bench.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAVE_CYCLES 1
+#else
+#define BENCH_HAVE_CYCLES 0
+#endif
+
+static volatile int sink_value;
+
+static void bench_on_packed(void *ctx, int first_key, int bits, const unsigned char *words, int count);
+
+//==================================================FUNCTION========================|
+//Name:           bench_now_ns                                                       |
+//Params:         NONE                                                              |
+//Returns:        uint64_t                Monotonic time in nanoseconds.             |
+//Outputs:        NONE                                                              |
+//Description:    Reads CLOCK_MONOTONIC.                                            |
+//==================================================================================|
+uint64_t bench_now_ns(void) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+//==================================================FUNCTION========================|
+//Name:           bench_cycles                                                       |
+//Params:         NONE                                                              |
+//Returns:        uint64_t                The time-stamp counter, or 0 where there   |
+//                                        is none.                                   |
+//Outputs:        NONE                                                              |
+//Description:    Reads the x86 time-stamp counter.                                 |
+//==================================================================================|
+uint64_t bench_cycles(void) {
+#if BENCH_HAVE_CYCLES
+    return (uint64_t)__rdtsc();
+#else
+    return 0;
+#endif
+}
+
+//==================================================FUNCTION========================|
+//Name:           bench_compare                                                      |
+//Params:         const void* a, b        Two doubles.                               |
+//Returns:        int                     qsort order.                               |
+//Outputs:        NONE                                                              |
+//Description:    Orders repetition results for the median.                         |
+//==================================================================================|
+static int bench_compare(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+//==================================================FUNCTION========================|
+//Name:           bench_run                                                          |
+//Params:         const char* name        Benchmark name for the report.             |
+//                BenchBody body          The operation loop.                        |
+//                BenchCtx* ctx           Its state; size and procs are reported.    |
+//                uint64_t ops            Operations per repetition.                 |
+//                int reps                Timed repetitions, 1 to BENCH_MAX_REPS.    |
+//Returns:        int                     0 on success, -1 if the body failed.       |
+//Outputs:        Prints one result line to stdout                                  |
+//Description:    Warms up with a tenth of the operations, then times 'reps' runs   |
+//                and reports the median and best ns/op, the median cycles/op and,  |
+//                for byte-sized operations, the median cycles/byte.                |
+//==================================================================================|
+int bench_run(const char *name, BenchBody body, BenchCtx *ctx, uint64_t ops, int reps) {
+    double ns[BENCH_MAX_REPS];
+    double cycles[BENCH_MAX_REPS];
+    uint64_t t0, t1, c0, c1;
+    uint64_t done;
+    int r;
+
+    if (body(ctx, ops / 10 + 1) == 0) {
+        return -1;
+    }
+
+    for (r = 0; r < reps; r++) {
+        t0 = bench_now_ns();
+        c0 = bench_cycles();
+        done = body(ctx, ops);
+        c1 = bench_cycles();
+        t1 = bench_now_ns();
+        if (done == 0) {
+            return -1;
+        }
+        ns[r] = (double)(t1 - t0) / (double)done;
+        cycles[r] = (double)(c1 - c0) / (double)done;
+    }
+
+    qsort(ns, (size_t)reps, sizeof(double), bench_compare);
+    qsort(cycles, (size_t)reps, sizeof(double), bench_compare);
+
+    printf("%-24s %5d %5d %10.2f %10.2f", name, ctx->size, ctx->procs, ns[reps / 2], ns[0]);
+    if (BENCH_HAVE_CYCLES) {
+        printf(" %10.1f", cycles[reps / 2]);
+    } else {
+        printf(" %10s", "-");
+    }
+    if (BENCH_HAVE_CYCLES && ctx->size > 0) {
+        printf(" %11.2f\n", cycles[reps / 2] / ctx->size);
+    } else {
+        printf(" %11s\n", "-");
+    }
+    fflush(stdout);
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           bench_header                                                       |
+//Params:         FILE* out               Where to print it.                         |
+//Returns:        NONE                                                              |
+//Outputs:        Prints the column names                                           |
+//Description:    Prints the header for the lines bench_run prints.                 |
+//==================================================================================|
+void bench_header(FILE *out) {
+    fprintf(out, "%-24s %5s %5s %10s %10s %10s %11s\n", "benchmark", "size", "procs",
+            "ns/op", "best ns/op", "cycles/op", "cycles/byte");
+}
+
+//==================================================FUNCTION========================|
+//Name:           bench_write_char                                                   |
+//Params:         BenchCtx* ctx           A private ring.                            |
+//                uint64_t ops            Characters to write.                       |
+//Returns:        uint64_t                Characters written.                        |
+//Outputs:        NONE                                                              |
+//Description:    Calls cb_write_char. A full ring is emptied by moving read_index, |
+//                so no read is timed with it.                                      |
+//==================================================================================|
+uint64_t bench_write_char(BenchCtx *ctx, uint64_t ops) {
+    CircularBuffer *cb = ctx->cb;
+    uint64_t done = 0;
+
+    while (done < ops) {
+        if (cb_write_char(cb, ctx->data[done % 20]) == 0) {
+            done++;
+        } else {
+            cb->read_index = cb->write_index;
+        }
+    }
+    return done;
+}
+
+//==================================================FUNCTION========================|
+//Name:           bench_write_multi                                                  |
+//Params:         BenchCtx* ctx           A private ring; size bytes per call.       |
+//                uint64_t ops            Calls to make.                             |
+//Returns:        uint64_t                Calls made.                                |
+//Outputs:        NONE                                                              |
+//Description:    Calls cb_write_multi with whole chunks. The ring is emptied by    |
+//                moving read_index before a chunk would not fit.                   |
+//==================================================================================|
+uint64_t bench_write_multi(BenchCtx *ctx, uint64_t ops) {
+    CircularBuffer *cb = ctx->cb;
+    uint64_t done;
+    int used;
+
+    for (done = 0; done < ops; done++) {
+        used = (cb->write_index - cb->read_index + BUFFER_SIZE) % BUFFER_SIZE;
+        if (BUFFER_SIZE - 1 - used < ctx->size) {
+            cb->read_index = cb->write_index;
+        }
+        cb_write_multi(cb, ctx->data, (size_t)ctx->size);
+    }
+    return done;
+}
+
+//==================================================FUNCTION========================|
+//Name:           bench_read_multi                                                   |
+//Params:         BenchCtx* ctx           A private ring; size bytes per call.       |
+//                uint64_t ops            Calls to make.                             |
+//Returns:        uint64_t                Calls made.                                |
+//Outputs:        NONE                                                              |
+//Description:    Fills the ring, then calls cb_read_multi and moves read_index     |
+//                back after each call, so every call reads a full chunk.           |
+//==================================================================================|
+uint64_t bench_read_multi(BenchCtx *ctx, uint64_t ops) {
+    CircularBuffer *cb = ctx->cb;
+    uint64_t done;
+    int n;
+
+    cb->read_index = cb->write_index;
+    cb_write_multi(cb, ctx->data, BUFFER_SIZE - 1);
+
+    for (done = 0; done < ops; done++) {
+        n = cb_read_multi(cb, ctx->out, (size_t)ctx->size);
+        cb->read_index = (cb->read_index - n + BUFFER_SIZE) % BUFFER_SIZE;
+    }
+    sink_value = ctx->out[0];
+    return done;
+}
+
+//==================================================FUNCTION========================|
+//Name:           bench_free_space                                                   |
+//Params:         BenchCtx* ctx           A private ring with procs gate consumers.  |
+//                uint64_t ops            Calls to make.                             |
+//Returns:        uint64_t                Calls made.                                |
+//Outputs:        NONE                                                              |
+//Description:    Calls cb_get_free_space, which also scans the consumer slots.     |
+//==================================================================================|
+uint64_t bench_free_space(BenchCtx *ctx, uint64_t ops) {
+    uint64_t done;
+    int sum = 0;
+
+    for (done = 0; done < ops; done++) {
+        sum += cb_get_free_space(ctx->cb);
+    }
+    sink_value = sum;
+    return done;
+}
+
+//==================================================FUNCTION========================|
+//Name:           bench_lock_unlock                                                  |
+//Params:         BenchCtx* ctx           sem_id, and procs processes to run.        |
+//                uint64_t ops            Lock/unlock pairs per process.             |
+//Returns:        uint64_t                Pairs run by all processes, 0 on failure.  |
+//Outputs:        NONE                                                              |
+//Description:    Calls lock_semaphore and unlock_semaphore back to back. With more |
+//                than one process the others are forked to contend for the same    |
+//                semaphore, and the result is the time per pair across all of them.|
+//==================================================================================|
+uint64_t bench_lock_unlock(BenchCtx *ctx, uint64_t ops) {
+    pid_t pids[BENCH_MAX_PROCS];
+    uint64_t i;
+    int failed = 0;
+    int status;
+    int p;
+
+    fflush(stdout);
+    for (p = 1; p < ctx->procs; p++) {
+        pids[p] = fork();
+        if (pids[p] == 0) {
+            for (i = 0; i < ops; i++) {
+                if (lock_semaphore(ctx->sem_id) == -1) {
+                    _exit(EXIT_FAILURE);
+                }
+                unlock_semaphore(ctx->sem_id);
+            }
+            _exit(EXIT_SUCCESS);
+        }
+        if (pids[p] == -1) {
+            perror("fork");
+            failed = 1;
+            break;
+        }
+    }
+
+    for (i = 0; i < ops && !failed; i++) {
+        if (lock_semaphore(ctx->sem_id) == -1) {
+            failed = 1;
+            break;
+        }
+        unlock_semaphore(ctx->sem_id);
+    }
+
+    while (--p >= 1) {
+        if (waitpid(pids[p], &status, 0) == -1 || !WIFEXITED(status) ||
+            WEXITSTATUS(status) != EXIT_SUCCESS) {
+            failed = 1;
+        }
+    }
+    return failed ? 0 : ops * (uint64_t)ctx->procs;
+}
+
+//==================================================FUNCTION========================|
+//Name:           bench_transfer                                                     |
+//Params:         BenchCtx* ctx           A shared ring and its semaphore; procs     |
+//                                        producers writing size-byte chunks.        |
+//                uint64_t ops            Chunks to move in total.                   |
+//Returns:        uint64_t                Chunks moved, 0 on failure.                |
+//Outputs:        NONE                                                              |
+//Description:    Moves chunks from forked producers to this process the way the    |
+//                pipeline does: each side takes the semaphore per call, producers  |
+//                write only whole chunks, and whoever finds nothing to do yields.  |
+//==================================================================================|
+uint64_t bench_transfer(BenchCtx *ctx, uint64_t ops) {
+    pid_t pids[BENCH_MAX_PROCS];
+    CircularBuffer *cb = ctx->cb;
+    uint64_t share;
+    uint64_t total = ops * (uint64_t)ctx->size;
+    uint64_t got = 0;
+    int failed = 0;
+    int wrote;
+    int status;
+    int n;
+    int p;
+
+    fflush(stdout);
+    for (p = 0; p < ctx->procs; p++) {
+        share = ops / (uint64_t)ctx->procs + ((uint64_t)p < ops % (uint64_t)ctx->procs ? 1 : 0);
+        pids[p] = fork();
+        if (pids[p] == 0) {
+            while (share > 0) {
+                if (lock_buffer(cb, ctx->sem_id) == -1) {
+                    _exit(EXIT_FAILURE);
+                }
+                wrote = 0;
+                if (cb_get_free_space(cb) >= ctx->size) {
+                    cb_write_multi(cb, ctx->data, (size_t)ctx->size);
+                    wrote = 1;
+                    share--;
+                }
+                unlock_buffer(cb, ctx->sem_id);
+                if (!wrote) {
+                    sched_yield();
+                }
+            }
+            _exit(EXIT_SUCCESS);
+        }
+        if (pids[p] == -1) {
+            perror("fork");
+            failed = 1;
+            break;
+        }
+    }
+
+    while (!failed && got < total) {
+        if (lock_buffer(cb, ctx->sem_id) == -1) {
+            failed = 1;
+            break;
+        }
+        n = cb_read_multi(cb, ctx->out, BUFFER_SIZE);
+        unlock_buffer(cb, ctx->sem_id);
+        got += (uint64_t)n;
+        if (n == 0) {
+            sched_yield();
+        }
+    }
+
+    while (--p >= 0) {
+        if (failed) {
+            kill(pids[p], SIGKILL);
+        }
+        if (waitpid(pids[p], &status, 0) == -1 || !WIFEXITED(status) ||
+            WEXITSTATUS(status) != EXIT_SUCCESS) {
+            failed = 1;
+        }
+    }
+    return failed ? 0 : ops;
+}
+
+//==================================================FUNCTION========================|
+//Name:           bench_count                                                        |
+//Params:         BenchCtx* ctx           size letters of plain data.                |
+//                uint64_t ops            Drains to count.                           |
+//Returns:        uint64_t                Drains counted.                            |
+//Outputs:        NONE                                                              |
+//Description:    Decodes and counts one drain of plain letters per operation, as   |
+//                dc_consume does without channels, sketches or n-grams.            |
+//==================================================================================|
+uint64_t bench_count(BenchCtx *ctx, uint64_t ops) {
+    static const RecordSink sink = { NULL, NULL, NULL, NULL, NULL };
+    RecordDecoder decoder;
+    char symbols[BUFFER_SIZE];
+    uint64_t done;
+    int symbol_count;
+
+    rec_decoder_init(&decoder);
+    for (done = 0; done < ops; done++) {
+        symbol_count = rec_decode(&decoder, ctx->data, ctx->size, symbols, &sink);
+        tally_symbols(symbols, symbol_count, ctx->counts, NULL);
+    }
+    return done;
+}
+
+//==================================================FUNCTION========================|
+//Name:           bench_count_packed                                                 |
+//Params:         BenchCtx* ctx           A packed record of size letters in data.   |
+//                uint64_t ops            Records to count.                          |
+//Returns:        uint64_t                Records counted.                           |
+//Outputs:        NONE                                                              |
+//Description:    Decodes and counts one packed record per operation, as            |
+//                dc_on_packed does without channels, sketches or n-grams.          |
+//==================================================================================|
+uint64_t bench_count_packed(BenchCtx *ctx, uint64_t ops) {
+    const RecordSink sink = { NULL, NULL, NULL, bench_on_packed, ctx };
+    RecordDecoder decoder;
+    char symbols[BUFFER_SIZE];
+    uint64_t done;
+    int len;
+
+    len = rec_packed_size(ctx->size, rec_packed_bits(CHAR_END - CHAR_START + 1));
+    rec_decoder_init(&decoder);
+    for (done = 0; done < ops; done++) {
+        rec_decode(&decoder, ctx->data, len, symbols, &sink);
+    }
+    return done;
+}
+
+//==================================================FUNCTION========================|
+//Name:           bench_on_packed                                                    |
+//Params:         void* ctx               The BenchCtx.                              |
+//                int first_key           Key of rank 0.                             |
+//                int bits                Bits per symbol.                           |
+//                const unsigned char* words  The packed words.                      |
+//                int count               Number of symbols.                         |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    Counts a packed record as dc_on_packed does.                      |
+//==================================================================================|
+static void bench_on_packed(void *ctx, int first_key, int bits, const unsigned char *words, int count) {
+    BenchCtx *bench = (BenchCtx *)ctx;
+    unsigned char ranks[REC_PACKED_MAX_SYMBOLS];
+
+    tally_packed(words, count, bits, first_key, ranks, bench->counts, NULL);
+}
+
+//==================================================FUNCTION========================|
+//Name:           bench_selected                                                     |
+//Params:         const char* name        A benchmark name.                          |
+//                const char* filter      The name filter, or NULL.                  |
+//Returns:        int                     1 if the benchmark should run.             |
+//Outputs:        NONE                                                              |
+//Description:    Matches a benchmark name against the command-line filter.         |
+//==================================================================================|
+static int bench_selected(const char *name, const char *filter) {
+    return filter == NULL || strstr(name, filter) != NULL;
+}
+
+//==================================================FUNCTION========================|
+//Name:           bench_all                                                          |
+//Params:         uint64_t ops            Operations per repetition for the          |
+//                                        in-process benchmarks.                     |
+//                int reps                Timed repetitions per benchmark.           |
+//                const char* filter      Only names containing this, or NULL.       |
+//Returns:        int                     0 on success, -1 on failure.               |
+//Outputs:        Prints the header and one line per benchmark and setting          |
+//Description:    Runs every selected benchmark over its sizes and process counts.  |
+//                The ring benchmarks use a ring in this process's memory. The      |
+//                semaphore and transfer benchmarks use a private semaphore and     |
+//                shared segment, removed again at the end, so they can run next to |
+//                a live pipeline. Operations that cross processes run a tenth as   |
+//                many times.                                                       |
+//==================================================================================|
+int bench_all(uint64_t ops, int reps, const char *filter) {
+    static const int sizes[] = { 1, 4, 16, 64, 128, 255 };
+    static const int transfer_sizes[] = { 16, 64, 200 };
+    static const int procs[] = { 1, 2, 4 };
+    static CircularBuffer ring;
+    BenchCtx ctx;
+    CircularBuffer *shared = NULL;
+    int shm_id = -1;
+    int result = 0;
+    size_t s;
+    size_t p;
+    int i;
+
+    memset(&ctx, 0, sizeof(ctx));
+    for (i = 0; i < BUFFER_SIZE; i++) {
+        ctx.data[i] = (char)(CHAR_START + i % (CHAR_END - CHAR_START + 1));
+    }
+    cb_init(&ring);
+    ctx.cb = &ring;
+    ctx.sem_id = -1;
+    ctx.procs = 1;
+
+    bench_header(stdout);
+
+    if (bench_selected("cb_write_char", filter)) {
+        ctx.size = 1;
+        result |= bench_run("cb_write_char", bench_write_char, &ctx, ops, reps);
+    }
+    for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        ctx.size = sizes[s];
+        if (bench_selected("cb_write_multi", filter)) {
+            result |= bench_run("cb_write_multi", bench_write_multi, &ctx, ops, reps);
+        }
+        if (bench_selected("cb_read_multi", filter)) {
+            result |= bench_run("cb_read_multi", bench_read_multi, &ctx, ops, reps);
+        }
+    }
+
+    if (bench_selected("cb_get_free_space", filter)) {
+        ctx.size = 0;
+        cb_init(&ring);
+        for (i = 0; i <= CB_MAX_CONSUMERS; i++) {
+            if (i > 0) {
+                cb_consumer_register(&ring, CB_CONSUMER_GATE, getpid());
+            }
+            ctx.procs = i;
+            result |= bench_run("cb_get_free_space", bench_free_space, &ctx, ops, reps);
+        }
+        cb_init(&ring);
+        ctx.procs = 1;
+    }
+
+    for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        if (sizes[s] < 4 || !bench_selected("dc_count", filter)) {
+            continue;
+        }
+        ctx.size = sizes[s];
+        result |= bench_run("dc_count", bench_count, &ctx, ops, reps);
+    }
+    if (bench_selected("dc_count_packed", filter)) {
+        char letters[REC_PACKED_MAX_SYMBOLS];
+
+        for (i = 0; i < REC_PACKED_MAX_SYMBOLS; i++) {
+            letters[i] = (char)(CHAR_START + (i * 7) % (CHAR_END - CHAR_START + 1));
+        }
+        ctx.size = REC_PACKED_MAX_SYMBOLS;
+        rec_encode_packed(ctx.data, letters, ctx.size, CHAR_START,
+                          rec_packed_bits(CHAR_END - CHAR_START + 1));
+        result |= bench_run("dc_count_packed", bench_count_packed, &ctx, ops, reps);
+        for (i = 0; i < BUFFER_SIZE; i++) {
+            ctx.data[i] = (char)(CHAR_START + i % (CHAR_END - CHAR_START + 1));
+        }
+    }
+
+    if (!bench_selected("lock_unlock", filter) && !bench_selected("transfer", filter)) {
+        return result;
+    }
+
+    ctx.sem_id = create_semaphore(IPC_PRIVATE);
+    if (ctx.sem_id == -1) {
+        return -1;
+    }
+
+    if (bench_selected("lock_unlock", filter)) {
+        ctx.size = 0;
+        for (p = 0; p < sizeof(procs) / sizeof(procs[0]); p++) {
+            ctx.procs = procs[p];
+            result |= bench_run("lock_unlock", bench_lock_unlock, &ctx, ops / 10 + 1, reps);
+        }
+    }
+
+    if (bench_selected("transfer", filter)) {
+        shm_id = create_shared_memory(IPC_PRIVATE, sizeof(CircularBuffer));
+        if (shm_id != -1) {
+            shared = (CircularBuffer *)attach_shared_memory(shm_id);
+        }
+        if (shared == NULL) {
+            result = -1;
+        } else {
+            cb_init(shared);
+            ctx.cb = shared;
+            for (s = 0; s < sizeof(transfer_sizes) / sizeof(transfer_sizes[0]); s++) {
+                ctx.size = transfer_sizes[s];
+                for (p = 0; p < 2; p++) {
+                    ctx.procs = procs[p];
+                    result |= bench_run("transfer", bench_transfer, &ctx, ops / 10 + 1, reps);
+                }
+            }
+            ctx.cb = &ring;
+            detach_shared_memory(shared);
+        }
+        if (shm_id != -1) {
+            remove_shared_memory(shm_id);
+        }
+    }
+
+    remove_semaphore(ctx.sem_id);
+    return result;
+}
+
+//==================================================FUNCTION========================|
+//Name:           bench_usage                                                        |
+//Params:         const char* prog        The program name.                          |
+//Returns:        NONE                                                              |
+//Outputs:        Prints the usage to stderr                                        |
+//Description:    Prints how to run histo-bench.                                    |
+//==================================================================================|
+void bench_usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [-n ops] [-r reps] [name]\n"
+            "  -n  operations per repetition (default %d; a tenth for the\n"
+            "      lock_unlock and transfer benchmarks)\n"
+            "  -r  timed repetitions after the warm-up, 1 to %d (default %d)\n"
+            "  name  only run benchmarks whose name contains it\n",
+            prog, BENCH_ITERATIONS_DEFAULT, BENCH_MAX_REPS, BENCH_REPS_DEFAULT);
+}
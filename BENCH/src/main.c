@@ -0,0 +1,39 @@
+/*
+*	FILE:			main.c
+*	ASSIGNMENT:	The "Histogram System"
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This is the entry point for histo-bench.
+*/
+
+#include "../../common/inc/constants.h"
+#include "../inc/bench.h"
+
+int main(int argc, char *argv[]) {
+    long long ops = BENCH_ITERATIONS_DEFAULT;
+    int reps = BENCH_REPS_DEFAULT;
+    const char *filter = NULL;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:r:")) != -1) {
+        switch (opt) {
+        case 'n':
+            ops = atoll(optarg);
+            break;
+        case 'r':
+            reps = atoi(optarg);
+            break;
+        default:
+            bench_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (optind < argc) {
+        filter = argv[optind++];
+    }
+    if (optind != argc || ops < 1 || reps < 1 || reps > BENCH_MAX_REPS) {
+        bench_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    return (bench_all((uint64_t)ops, reps, filter) == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
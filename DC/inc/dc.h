@@ -14,16 +14,70 @@
 #include <string.h>
 #include <unistd.h>
 #include <signal.h>
+#include <time.h>
+#include <stdint.h>
 #include <sys/types.h>
+#include <limits.h>
+#include <math.h>
+#include "histo_file.h"
+#include "control.h"
+#include "dc_export.h"
+#include "dc_record.h"
+#include "dc_ngram.h"
+#include "dc_history.h"
+#include "dc_rt.h"
+
+/* Bins per channel, padded so each channel is two whole cache lines */
+#define DC_CHANNEL_BINS 32
+
+/* Sketch key of a symbol: its channel id above its byte value */
+#define DC_SKETCH_KEY(channel, symbol) (((uint64_t)(channel) << 8) | (unsigned char)(symbol))
+
+typedef struct {
+    uint32_t counts[DC_CHANNEL_BINS];
+} __attribute__((aligned(64))) ChannelHistogram;
+
+/* Restoring a hand-off file: counts are only taken after a matching origin */
+typedef struct {
+    uint64_t origin[3];            /* shm id, its creation time, DP-1's pid */
+    int matched;                   /* 1 once the file's origin section matched */
+} DcRestore;
 
 int dc_init(int shm_id, pid_t dp1_pid, pid_t dp2_pid);
 int dc_process(void);
 int dc_read_data(void);
+void dc_consume(const char *buffer, int len);
+void dc_apply_control(void *ctx, const ControlCommand *command);
+int dc_sketch_init(void);
+int dc_hll_init(void);
+int dc_samples_init(void);
+void dc_on_sample(void *ctx, uint64_t value);
+int dc_dist_init(void);
+int dc_channels_init(void);
+void dc_on_span(void *ctx, int channel, const char *symbols, int count);
+void dc_on_delta(void *ctx, int channel, int first_key, const uint32_t *bins, int count);
+void dc_on_packed(void *ctx, int first_key, int bits, const unsigned char *words, int count);
+void dc_display_channels(void);
+void dc_update_sketches(int channel, const char *buffer, int len);
+void dc_update_sketch_key(uint64_t key, uint32_t count);
 void dc_display_histogram(void);
+int dc_dump_histogram(const char *path, const HfSection *origin);
+int dc_dump_channels(const char *path, const HfSection *all, const HfSection *origin);
+void dc_build_snapshot(DcSnapshot *snapshot);
+int dc_handoff(void);
+int dc_origin(uint64_t *origin);
+void dc_restore_section(void *ctx, const HfSection *section);
+int dc_restore(const char *path);
+void dc_display_top_keys(void);
+void dc_display_quantiles(void);
+void dc_display_distribution(void);
+void dc_print_stats(FILE *out);
 void dc_clear_screen(void);
 void dc_cleanup(void);
 void dc_exit(void);
 void dc_sigint_handler(int sig);
 void dc_alarm_handler(int sig);
+void dc_handoff_handler(int sig);
+void dc_dump_handler(int sig);
 
 #endif /* DC_H */
\ No newline at end of file
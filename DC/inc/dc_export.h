@@ -0,0 +1,59 @@
+/*
+*	FILE:			dc_export.h
+*	ASSIGNMENT:	The "Histogram System"
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This file defines the interface for DC's background exporter. The
+*                 main loop publishes a snapshot of the histogram and pipeline stats;
+*                 a writer thread turns the latest snapshot into a CSV, JSON or
+*                 Prometheus textfile-collector file. Channels with no data are left
+*                 out of the per-channel part of the output.
+*/
+
+#ifndef DC_EXPORT_H
+#define DC_EXPORT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define DC_EXPORT_MAX_BINS 26
+#define DC_EXPORT_MAX_NGRAMS 10
+
+enum { EXPORT_CSV = 0, EXPORT_JSON, EXPORT_PROMETHEUS };
+
+typedef struct {
+    uint64_t timestamp_ms;
+    char first_key;
+    int bin_count;
+    uint64_t counts[DC_EXPORT_MAX_BINS];
+    const uint32_t *channel_counts;    /* channel_count rows of channel_stride bins */
+    int channel_count;
+    int channel_stride;
+    uint64_t total;                    /* distribution statistics, see dist_stats.h */
+    char min_key;
+    uint64_t min_count;
+    char max_key;
+    uint64_t max_count;
+    double entropy;
+    double chi_square;                 /* infinite if an unexpected bin has counts */
+    int has_skew;                      /* HISTO_SKEW_ALERT is set */
+    uint64_t skew_batches;
+    uint64_t bytes_read;
+    uint64_t reads;
+    int has_distinct;
+    double distinct;
+    uint64_t samples;
+    double sample_sum;
+    uint64_t sample_p50;
+    uint64_t sample_p99;
+    uint64_t sample_p9999;
+    int ngram_count;                   /* top n-grams, most frequent first */
+    char ngrams[DC_EXPORT_MAX_NGRAMS][4];
+    uint64_t ngram_counts[DC_EXPORT_MAX_NGRAMS];
+} DcSnapshot;
+
+int dc_export_start(size_t channel_cells);
+int dc_export_due(void);
+void dc_export_publish(const DcSnapshot *snapshot);
+void dc_export_stop(const DcSnapshot *final_snapshot);
+
+#endif /* DC_EXPORT_H */
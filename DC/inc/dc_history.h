@@ -0,0 +1,19 @@
+/*
+*	FILE:			dc_history.h
+*	ASSIGNMENT:	The "Histogram System"
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This file defines the interface for DC's history stage, which
+*                 appends the counts of every interval to a time series (see
+*                 tseries.h) and keeps its hour and day rollups up to date.
+*/
+
+#ifndef DC_HISTORY_H
+#define DC_HISTORY_H
+
+#include <stdint.h>
+
+int dc_history_start(int first_key, const uint64_t *counts, int bin_count);
+void dc_history_tick(int first_key, const uint64_t *counts, int bin_count);
+void dc_history_stop(int first_key, const uint64_t *counts, int bin_count);
+
+#endif /* DC_HISTORY_H */
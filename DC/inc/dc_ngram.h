@@ -0,0 +1,38 @@
+/*
+*	FILE:			dc_ngram.h
+*	ASSIGNMENT:	The "Histogram System"
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This file defines the interface for DC's n-gram mode, which counts
+*                 which symbol follows which (HISTO_NGRAM=2) or follows which pair
+*                 (HISTO_NGRAM=3) in one dense matrix over CHAR_START..CHAR_END.
+*                 Only symbols DC knows came from one producer in order are
+*                 counted: channel spans, each channel with its own context, and
+*                 packed records, each on its own. Plain bytes are not counted:
+*                 DP-1 and DP-2 write them into the ring batch by batch, DC cannot
+*                 see where one write ends, so their n-grams would cross from one
+*                 producer to the other. Run DP-1 with HISTO_DP1_CHANNELS or
+*                 HISTO_DP1_PACKED to get transitions.
+*/
+
+#ifndef DC_NGRAM_H
+#define DC_NGRAM_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "constants.h"
+
+#define DC_NGRAM_ALPHABET (CHAR_END - CHAR_START + 1)
+#define DC_NGRAM_MAX_ORDER 3
+#define DC_NGRAM_TOP 10
+/* One context per 16-bit channel id */
+#define DC_NGRAM_CONTEXTS 65536
+
+int dc_ngram_init(int streams);
+int dc_ngram_order(void);
+void dc_ngram_update(int context, const char *symbols, int count);
+void dc_ngram_break(int context);
+int dc_ngram_top(char keys[][DC_NGRAM_MAX_ORDER + 1], uint64_t *counts, int max);
+void dc_ngram_display(FILE *out);
+void dc_ngram_free(void);
+
+#endif /* DC_NGRAM_H */
@@ -0,0 +1,20 @@
+/*
+*	FILE:			dc_record.h
+*	ASSIGNMENT:	The "Histogram System"
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This file defines the interface for DC's recording stage, which
+*                 appends every drained span to a stream log (see stream_log.h) so
+*                 the input can be replayed later.
+*/
+
+#ifndef DC_RECORD_H
+#define DC_RECORD_H
+
+#include <stdint.h>
+
+int dc_record_start(void);
+void dc_record_span(const char *span, int len);
+uint64_t dc_record_dropped(void);
+void dc_record_stop(void);
+
+#endif /* DC_RECORD_H */
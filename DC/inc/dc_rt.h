@@ -0,0 +1,22 @@
+/*
+*	FILE:			dc_rt.h
+*	ASSIGNMENT:	The "Histogram System"
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This file defines the interface for DC's low-jitter mode, which
+*                 locks DC's memory, can run the drain loop under SCHED_FIFO, and
+*                 times every pass of the loop.
+*/
+
+#ifndef DC_RT_H
+#define DC_RT_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+int dc_rt_start(const void *shared, size_t shared_size);
+void dc_rt_pass_begin(void);
+void dc_rt_pass_end(void);
+void dc_rt_print_stats(FILE *out);
+void dc_rt_stop(void);
+
+#endif /* DC_RT_H */
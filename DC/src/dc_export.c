@@ -0,0 +1,507 @@
+/*
+*	FILE:			dc_export.c
+*	ASSIGNMENT:	The "Histogram System"
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This file implements DC's background exporter. Publishing only
+*                 try-locks the shared slot, so the ingest loop never waits for the
+*                 writer; a snapshot that cannot be handed over is simply skipped and
+*                 the next one carries newer data. The writer formats into a reused
+*                 buffer, writes "<path>.tmp" and renames it over the target.
+*/
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+#include "../../common/inc/constants.h"
+#include "../../common/inc/config.h"
+#include "../../common/inc/instance.h"
+#include "../inc/dc_export.h"
+
+static pthread_t writer;
+static pthread_mutex_t slot_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t slot_cond = PTHREAD_COND_INITIALIZER;
+static DcSnapshot slot;                 /* latest published snapshot */
+static uint32_t *slot_channels = NULL;  /* per-channel counts owned by the slot */
+static uint32_t *local_channels = NULL; /* the writer's copy of them */
+static size_t channel_cap = 0;
+static int slot_ready = 0;
+static int stopping = 0;
+static int running = 0;
+static int format = EXPORT_CSV;
+static int interval = 0;
+static time_t next_export = 0;
+static char path[4096];
+static char tmp_path[sizeof(path) + 4];
+static char *text = NULL;               /* reused output buffer */
+static size_t text_cap = 0;
+static size_t text_len = 0;
+
+//==================================================FUNCTION========================|
+//Name:           dc_export_append                                                   |
+//Params:         const char* fmt, ...    printf-style text to append.               |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function appends to the output buffer, growing it only when  |
+//                a larger snapshot than ever before is written.                     |
+//==================================================================================|
+static void dc_export_append(const char *fmt, ...) {
+    va_list args;
+    char *grown;
+    int n;
+
+    for (;;) {
+        va_start(args, fmt);
+        n = vsnprintf(text + text_len, text_cap - text_len, fmt, args);
+        va_end(args);
+        if (n < 0) {
+            return;
+        }
+        if (text_len + (size_t)n < text_cap) {
+            text_len += (size_t)n;
+            return;
+        }
+        grown = realloc(text, text_cap * 2 + (size_t)n + 1);
+        if (grown == NULL) {
+            return;
+        }
+        text = grown;
+        text_cap = text_cap * 2 + (size_t)n + 1;
+    }
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_export_channel_total                                            |
+//Params:         const DcSnapshot* s     Snapshot holding the channel rows.         |
+//                int channel             Row to sum.                                |
+//Returns:        uint64_t                Symbols counted for the channel.           |
+//Outputs:        NONE                                                              |
+//Description:    This function lets the formatters skip idle channels.              |
+//==================================================================================|
+static uint64_t dc_export_channel_total(const DcSnapshot *s, int channel) {
+    const uint32_t *row = s->channel_counts + (size_t)channel * s->channel_stride;
+    uint64_t total = 0;
+    int i;
+
+    for (i = 0; i < s->bin_count; i++) {
+        total += row[i];
+    }
+
+    return total;
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_export_format                                                   |
+//Params:         const DcSnapshot* s     Snapshot to format.                        |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function renders the snapshot in the configured format. In    |
+//                CSV, per-channel rows are keyed "<channel>:<symbol>" and the top    |
+//                n-grams "ngram:<symbols>".                                         |
+//==================================================================================|
+static void dc_export_format(const DcSnapshot *s) {
+    const uint32_t *row;
+    int first;
+    int c, i;
+
+    text_len = 0;
+    switch (format) {
+    case EXPORT_JSON:
+        dc_export_append("{\"timestamp_ms\":%llu,\"counts\":{", (unsigned long long)s->timestamp_ms);
+        for (i = 0; i < s->bin_count; i++) {
+            dc_export_append("%s\"%c\":%llu", i ? "," : "", s->first_key + i,
+                             (unsigned long long)s->counts[i]);
+        }
+        dc_export_append("},\"channels\":{");
+        first = 1;
+        for (c = 0; c < s->channel_count; c++) {
+            if (dc_export_channel_total(s, c) == 0) {
+                continue;
+            }
+            row = s->channel_counts + (size_t)c * s->channel_stride;
+            dc_export_append("%s\"%d\":{", first ? "" : ",", c);
+            for (i = 0; i < s->bin_count; i++) {
+                dc_export_append("%s\"%c\":%u", i ? "," : "", s->first_key + i, row[i]);
+            }
+            dc_export_append("}");
+            first = 0;
+        }
+        dc_export_append("},\"total\":%llu,\"min_bin\":\"%c\",\"min_count\":%llu,"
+                         "\"max_bin\":\"%c\",\"max_count\":%llu,\"entropy_bits\":%.6f,",
+                         (unsigned long long)s->total, s->min_key,
+                         (unsigned long long)s->min_count, s->max_key,
+                         (unsigned long long)s->max_count, s->entropy);
+        if (isinf(s->chi_square)) {
+            dc_export_append("\"chi_square\":null");
+        } else {
+            dc_export_append("\"chi_square\":%.6f", s->chi_square);
+        }
+        if (s->has_skew) {
+            dc_export_append(",\"skew_batches\":%llu", (unsigned long long)s->skew_batches);
+        }
+        dc_export_append(",\"bytes_read\":%llu,\"reads\":%llu",
+                         (unsigned long long)s->bytes_read, (unsigned long long)s->reads);
+        if (s->has_distinct) {
+            dc_export_append(",\"distinct_keys\":%.0f", s->distinct);
+        }
+        if (s->ngram_count > 0) {
+            dc_export_append(",\"ngrams\":{");
+            for (i = 0; i < s->ngram_count; i++) {
+                dc_export_append("%s\"%s\":%llu", i ? "," : "", s->ngrams[i],
+                                 (unsigned long long)s->ngram_counts[i]);
+            }
+            dc_export_append("}");
+        }
+        dc_export_append(",\"samples\":%llu,\"sample_p50\":%llu,\"sample_p99\":%llu,"
+                         "\"sample_p9999\":%llu}\n",
+                         (unsigned long long)s->samples, (unsigned long long)s->sample_p50,
+                         (unsigned long long)s->sample_p99, (unsigned long long)s->sample_p9999);
+        break;
+    case EXPORT_PROMETHEUS:
+        dc_export_append("# HELP histo_symbol_count Symbols counted by DC.\n"
+                         "# TYPE histo_symbol_count counter\n");
+        for (i = 0; i < s->bin_count; i++) {
+            dc_export_append("histo_symbol_count{symbol=\"%c\"} %llu\n", s->first_key + i,
+                             (unsigned long long)s->counts[i]);
+        }
+        if (s->channel_count > 0) {
+            dc_export_append("# HELP histo_channel_symbol_count Symbols counted per channel.\n"
+                             "# TYPE histo_channel_symbol_count counter\n");
+        }
+        for (c = 0; c < s->channel_count; c++) {
+            if (dc_export_channel_total(s, c) == 0) {
+                continue;
+            }
+            row = s->channel_counts + (size_t)c * s->channel_stride;
+            for (i = 0; i < s->bin_count; i++) {
+                dc_export_append("histo_channel_symbol_count{channel=\"%d\",symbol=\"%c\"} %u\n",
+                                 c, s->first_key + i, row[i]);
+            }
+        }
+        dc_export_append("# HELP histo_bin_min Smallest symbol count.\n"
+                         "# TYPE histo_bin_min gauge\n"
+                         "histo_bin_min{symbol=\"%c\"} %llu\n"
+                         "# HELP histo_bin_max Largest symbol count.\n"
+                         "# TYPE histo_bin_max gauge\n"
+                         "histo_bin_max{symbol=\"%c\"} %llu\n"
+                         "# HELP histo_entropy_bits Shannon entropy of the symbol counts.\n"
+                         "# TYPE histo_entropy_bits gauge\n"
+                         "histo_entropy_bits %.6f\n"
+                         "# HELP histo_chi_square Chi-square of the counts against the expected "
+                         "distribution.\n"
+                         "# TYPE histo_chi_square gauge\n",
+                         s->min_key, (unsigned long long)s->min_count, s->max_key,
+                         (unsigned long long)s->max_count, s->entropy);
+        if (isinf(s->chi_square)) {
+            dc_export_append("histo_chi_square +Inf\n");
+        } else {
+            dc_export_append("histo_chi_square %.6f\n", s->chi_square);
+        }
+        if (s->has_skew) {
+            dc_export_append("# HELP histo_skew_batches_total Batches with chi-square above the "
+                             "alert level.\n"
+                             "# TYPE histo_skew_batches_total counter\n"
+                             "histo_skew_batches_total %llu\n",
+                             (unsigned long long)s->skew_batches);
+        }
+        dc_export_append("# HELP histo_bytes_read_total Bytes drained from the ring.\n"
+                         "# TYPE histo_bytes_read_total counter\n"
+                         "histo_bytes_read_total %llu\n"
+                         "# HELP histo_reads_total Drains of the ring.\n"
+                         "# TYPE histo_reads_total counter\n"
+                         "histo_reads_total %llu\n",
+                         (unsigned long long)s->bytes_read, (unsigned long long)s->reads);
+        if (s->has_distinct) {
+            dc_export_append("# HELP histo_distinct_keys Estimated distinct keys.\n"
+                             "# TYPE histo_distinct_keys gauge\n"
+                             "histo_distinct_keys %.0f\n", s->distinct);
+        }
+        if (s->ngram_count > 0) {
+            dc_export_append("# HELP histo_ngram_count Most frequent symbol n-grams.\n"
+                             "# TYPE histo_ngram_count counter\n");
+            for (i = 0; i < s->ngram_count; i++) {
+                dc_export_append("histo_ngram_count{ngram=\"%s\"} %llu\n", s->ngrams[i],
+                                 (unsigned long long)s->ngram_counts[i]);
+            }
+        }
+        if (s->samples > 0) {
+            dc_export_append("# HELP histo_samples Numeric samples received.\n"
+                             "# TYPE histo_samples summary\n"
+                             "histo_samples{quantile=\"0.5\"} %llu\n"
+                             "histo_samples{quantile=\"0.99\"} %llu\n"
+                             "histo_samples{quantile=\"0.9999\"} %llu\n"
+                             "histo_samples_sum %.0f\n"
+                             "histo_samples_count %llu\n",
+                             (unsigned long long)s->sample_p50, (unsigned long long)s->sample_p99,
+                             (unsigned long long)s->sample_p9999, s->sample_sum,
+                             (unsigned long long)s->samples);
+        }
+        break;
+    default:
+        dc_export_append("key,value\ntimestamp_ms,%llu\n", (unsigned long long)s->timestamp_ms);
+        for (i = 0; i < s->bin_count; i++) {
+            dc_export_append("%c,%llu\n", s->first_key + i, (unsigned long long)s->counts[i]);
+        }
+        for (c = 0; c < s->channel_count; c++) {
+            if (dc_export_channel_total(s, c) == 0) {
+                continue;
+            }
+            row = s->channel_counts + (size_t)c * s->channel_stride;
+            for (i = 0; i < s->bin_count; i++) {
+                dc_export_append("%d:%c,%u\n", c, s->first_key + i, row[i]);
+            }
+        }
+        dc_export_append("total,%llu\nmin_bin,%c\nmin_count,%llu\nmax_bin,%c\nmax_count,%llu\n"
+                         "entropy_bits,%.6f\nchi_square,%.6f\n",
+                         (unsigned long long)s->total, s->min_key, (unsigned long long)s->min_count,
+                         s->max_key, (unsigned long long)s->max_count, s->entropy, s->chi_square);
+        if (s->has_skew) {
+            dc_export_append("skew_batches,%llu\n", (unsigned long long)s->skew_batches);
+        }
+        dc_export_append("bytes_read,%llu\nreads,%llu\n", (unsigned long long)s->bytes_read,
+                         (unsigned long long)s->reads);
+        if (s->has_distinct) {
+            dc_export_append("distinct_keys,%.0f\n", s->distinct);
+        }
+        for (i = 0; i < s->ngram_count; i++) {
+            dc_export_append("ngram:%s,%llu\n", s->ngrams[i], (unsigned long long)s->ngram_counts[i]);
+        }
+        dc_export_append("samples,%llu\nsample_p50,%llu\nsample_p99,%llu\nsample_p9999,%llu\n",
+                         (unsigned long long)s->samples, (unsigned long long)s->sample_p50,
+                         (unsigned long long)s->sample_p99, (unsigned long long)s->sample_p9999);
+        break;
+    }
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_export_write                                                    |
+//Params:         NONE                                                              |
+//Returns:        int                    Returns 0 on success, -1 on failure.        |
+//Outputs:        Replaces the export file                                          |
+//Description:    This function writes the formatted buffer to the temporary file    |
+//                and renames it into place atomically. On failure the temporary    |
+//                file is removed.                                                   |
+//==================================================================================|
+static int dc_export_write(void) {
+    FILE *fp;
+    int ok;
+
+    fp = fopen(tmp_path, "w");
+    if (fp == NULL) {
+        perror("export fopen");
+        return -1;
+    }
+    ok = fwrite(text, 1, text_len, fp) == text_len;
+    if (fclose(fp) != 0 || !ok) {
+        perror("export write");
+        remove(tmp_path);
+        return -1;
+    }
+    if (rename(tmp_path, path) == -1) {
+        perror("export rename");
+        remove(tmp_path);
+        return -1;
+    }
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_export_thread                                                   |
+//Params:         void* arg              Unused.                                     |
+//Returns:        void*                  NULL                                        |
+//Outputs:        NONE                                                              |
+//Description:    This function is the writer thread. It copies the latest snapshot  |
+//                out of the slot, releases the lock, and only then does the slow    |
+//                formatting and file I/O.                                           |
+//==================================================================================|
+static void *dc_export_thread(void *arg) {
+    DcSnapshot local;
+    int done;
+
+    (void)arg;
+    for (;;) {
+        pthread_mutex_lock(&slot_lock);
+        while (!slot_ready && !stopping) {
+            pthread_cond_wait(&slot_cond, &slot_lock);
+        }
+        done = stopping && !slot_ready;
+        if (slot_ready) {
+            local = slot;
+            if (local.channel_count > 0) {
+                memcpy(local_channels, slot_channels,
+                       (size_t)local.channel_count * local.channel_stride * sizeof(uint32_t));
+                local.channel_counts = local_channels;
+            }
+            slot_ready = 0;
+        }
+        pthread_mutex_unlock(&slot_lock);
+
+        if (done) {
+            break;
+        }
+        dc_export_format(&local);
+        dc_export_write();
+    }
+
+    return NULL;
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_export_start                                                    |
+//Params:         size_t channel_cells   Per-channel counters in a snapshot.         |
+//Returns:        int                    Returns 0 on success, -1 on failure.        |
+//Outputs:        NONE                                                              |
+//Description:    This function reads HISTO_EXPORT_INTERVAL (seconds, 0 = off),      |
+//                HISTO_EXPORT_FORMAT (csv, json or prom) and HISTO_EXPORT_PATH, and |
+//                starts the writer thread.                                          |
+//==================================================================================|
+int dc_export_start(size_t channel_cells) {
+    char instance_default[sizeof(path)];
+    const char *name;
+    const char *default_path;
+
+    interval = config_get_int("HISTO_EXPORT_INTERVAL", DC_EXPORT_INTERVAL_DEFAULT);
+    if (interval <= 0) {
+        return 0;
+    }
+
+    name = config_get_str("HISTO_EXPORT_FORMAT", DC_EXPORT_FORMAT_DEFAULT);
+    if (strcasecmp(name, "json") == 0) {
+        format = EXPORT_JSON;
+        default_path = "histogram.json";
+    } else if (strcasecmp(name, "prom") == 0 || strcasecmp(name, "prometheus") == 0) {
+        format = EXPORT_PROMETHEUS;
+        default_path = "histogram.prom";
+    } else if (strcasecmp(name, "csv") == 0) {
+        format = EXPORT_CSV;
+        default_path = "histogram.csv";
+    } else {
+        fprintf(stderr, "DC: unknown export format '%s'\n", name);
+        return -1;
+    }
+
+    snprintf(path, sizeof(path), "%s",
+             config_get_str("HISTO_EXPORT_PATH",
+                            instance_path(default_path, instance_default,
+                                          sizeof(instance_default))));
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+    text_cap = 4096;
+    text = malloc(text_cap);
+    if (text == NULL) {
+        return -1;
+    }
+    if (channel_cells > 0) {
+        channel_cap = channel_cells;
+        slot_channels = malloc(channel_cap * sizeof(uint32_t));
+        local_channels = malloc(channel_cap * sizeof(uint32_t));
+        if (slot_channels == NULL || local_channels == NULL) {
+            return -1;
+        }
+    }
+
+    if (pthread_create(&writer, NULL, dc_export_thread, NULL) != 0) {
+        fprintf(stderr, "DC: cannot start export thread\n");
+        return -1;
+    }
+    running = 1;
+    next_export = time(NULL) + interval;
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_export_due                                                      |
+//Params:         NONE                                                              |
+//Returns:        int                    1 if a snapshot should be published now.    |
+//Outputs:        NONE                                                              |
+//Description:    This function tells the main loop when the export interval has     |
+//                passed, so snapshots are only built when they will be used.        |
+//==================================================================================|
+int dc_export_due(void) {
+    if (!running || time(NULL) < next_export) {
+        return 0;
+    }
+
+    next_export = time(NULL) + interval;
+    return 1;
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_export_fill_slot                                                |
+//Params:         const DcSnapshot* snapshot  Snapshot to copy; its channel rows may |
+//                                            point at DC's live counters.           |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function copies a snapshot into the slot, including the       |
+//                channel rows. The caller holds slot_lock.                          |
+//==================================================================================|
+static void dc_export_fill_slot(const DcSnapshot *snapshot) {
+    size_t cells;
+
+    slot = *snapshot;
+    cells = (size_t)slot.channel_count * slot.channel_stride;
+    if (cells > channel_cap) {
+        slot.channel_count = 0;
+        cells = 0;
+    }
+    if (cells > 0) {
+        memcpy(slot_channels, snapshot->channel_counts, cells * sizeof(uint32_t));
+        slot.channel_counts = slot_channels;
+    }
+    slot_ready = 1;
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_export_publish                                                  |
+//Params:         const DcSnapshot* snapshot  Snapshot to hand to the writer.        |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function offers a snapshot to the writer without blocking. If |
+//                the writer is holding the slot, the snapshot is dropped.           |
+//==================================================================================|
+void dc_export_publish(const DcSnapshot *snapshot) {
+    if (!running || pthread_mutex_trylock(&slot_lock) != 0) {
+        return;
+    }
+
+    dc_export_fill_slot(snapshot);
+    pthread_cond_signal(&slot_cond);
+    pthread_mutex_unlock(&slot_lock);
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_export_stop                                                     |
+//Params:         const DcSnapshot* final_snapshot  Last snapshot, or NULL.          |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function hands over the final snapshot (blocking, since the   |
+//                loop has ended), lets the writer finish it and joins the thread.   |
+//==================================================================================|
+void dc_export_stop(const DcSnapshot *final_snapshot) {
+    if (!running) {
+        return;
+    }
+
+    pthread_mutex_lock(&slot_lock);
+    if (final_snapshot != NULL) {
+        dc_export_fill_slot(final_snapshot);
+    }
+    stopping = 1;
+    pthread_cond_signal(&slot_cond);
+    pthread_mutex_unlock(&slot_lock);
+    pthread_join(writer, NULL);
+
+    running = 0;
+    free(text);
+    text = NULL;
+    free(slot_channels);
+    free(local_channels);
+    slot_channels = NULL;
+    local_channels = NULL;
+}
@@ -7,9 +7,23 @@
 *                 and displaying it. It also handles cleanup and shutdown procedures.
 */
 
+#include <sys/shm.h>
 #include "../../common/inc/constants.h"
 #include "../../common/inc/circular_buffer.h"
 #include "../../common/inc/ipc_utils.h"
+#include "../../common/inc/config.h"
+#include "../../common/inc/count_min.h"
+#include "../../common/inc/space_saving.h"
+#include "../../common/inc/hyperloglog.h"
+#include "../../common/inc/hdr_histogram.h"
+#include "../../common/inc/record.h"
+#include "../../common/inc/histo_file.h"
+#include "../../common/inc/trace.h"
+#include "../../common/inc/live.h"
+#include "../../common/inc/instance.h"
+#include "../../common/inc/generator.h"
+#include "../../common/inc/dist_stats.h"
+#include "../../common/inc/tally.h"
 #include "../inc/dc.h"
 
 /* Global variables */
@@ -21,8 +35,39 @@ static pid_t dp2_pid_g = -1;
 static int run = 1;              
 static int shutdown = 0;             
 static int read_count = 0;           
-static int letter_counts[26] = {0};  
+static uint64_t letter_counts[26] = {0};
 static int alarm_flag = 0;           
+static int sketch_enabled = 0;
+static int topk_size = 0;
+static CountMinSketch cms;
+static SpaceSaving topk;
+static int hll_enabled = 0;
+static const char *hll_checkpoint = NULL;
+static HyperLogLog distinct;
+static int hdr_enabled = 0;
+static HdrHistogram samples;
+static RecordDecoder decoder;
+static const RecordSink sink = { dc_on_sample, dc_on_span, dc_on_delta, dc_on_packed, NULL };
+static volatile sig_atomic_t dump_flag = 0;
+static const char *dump_path = NULL;
+static int dump_interval = 0;
+static time_t next_dump = 0;
+static uint64_t bytes_drained = 0;
+static uint64_t drain_count = 0;
+static ChannelHistogram *channels = NULL;
+static int channel_count = 0;
+static uint64_t channel_dropped = 0;
+static int display_channel = -1;
+static int display_interval = DC_DISPLAY_INTERVAL;
+static int read_bytes = DC_READ_BYTES_DEFAULT;
+static int read_interval = DC_READ_INTERVAL_DEFAULT;
+static uint32_t control_cursor = 0;
+static volatile sig_atomic_t handoff = 0;
+static const char *handoff_path = NULL;
+static DistStats dist;
+static const char *dist_expected = NULL;
+static double skew_alert = 0.0;
+static uint64_t skew_batches = 0;
 
 //==================================================FUNCTION========================|
 //Name:           dc_init                                                            |
@@ -34,18 +79,28 @@ static int alarm_flag = 0;
 //Description:    This function initializes the DC process by creating a semaphore, attaching shared memory, and setting up signal handlers. |
 //==================================================================================|
 int dc_init(int shm_id, pid_t dp1_pid, pid_t dp2_pid) {
+    static char handoff_default[PATH_MAX];
+    static char dump_default[PATH_MAX];
+    key_t sem_key;
+    key_t shm_key;
+
     shm_id_g = shm_id;
     dp1_pid_g = dp1_pid;
     dp2_pid_g = dp2_pid;
+    trace_init("DC");
     
-    sem_id = create_semaphore(SEM_KEY);
+    if (instance_keys(&sem_key, &shm_key) == -1) {
+        return -1;
+    }
+    sem_id = create_semaphore(sem_key);
     if (sem_id == -1) {
         return -1;
     }
     cb = (CircularBuffer *)attach_shared_memory(shm_id_g);
-    if (cb == NULL) {
+    if (cb == NULL || instance_check(cb, "DC") == -1) {
         return -1;
     }
+    control_cursor = ctl_cursor(&cb->control);
     
     if (setup_signal_handler(SIGINT, dc_sigint_handler) == -1) {
         return -1;
@@ -54,75 +109,641 @@ int dc_init(int shm_id, pid_t dp1_pid, pid_t dp2_pid) {
     if (setup_signal_handler(SIGALRM, dc_alarm_handler) == -1) {
         return -1;
     }
-    alarm(2); 
+    alarm(read_interval); 
+
+    if (dc_sketch_init() == -1) {
+        return -1;
+    }
+
+    if (dc_hll_init() == -1) {
+        return -1;
+    }
+
+    if (dc_samples_init() == -1) {
+        return -1;
+    }
+
+    if (dc_channels_init() == -1) {
+        return -1;
+    }
+
+    if (dc_ngram_init(DC_NGRAM_CONTEXTS) == -1) {
+        return -1;
+    }
+
+    if (dc_dist_init() == -1) {
+        return -1;
+    }
+
+    handoff_path = config_get_str("HISTO_HANDOFF_PATH",
+                                  instance_path(DC_HANDOFF_PATH_DEFAULT, handoff_default,
+                                                sizeof(handoff_default)));
+    if (dc_restore(handoff_path) == -1) {
+        return -1;
+    }
+    dist_sync(&dist, letter_counts);
+    live_publish(&cb->live, CHAR_START, letter_counts, CHAR_END - CHAR_START + 1, drain_count);
+    if (setup_signal_handler(SIGUSR2, dc_handoff_handler) == -1) {
+        return -1;
+    }
+    if (setup_signal_handler(SIGHUP, dc_handoff_handler) == -1) {
+        return -1;
+    }
+
+    dump_path = config_get_str("HISTO_DUMP_PATH",
+                               instance_path(DC_DUMP_PATH_DEFAULT, dump_default,
+                                             sizeof(dump_default)));
+    dump_interval = config_get_int("HISTO_DUMP_INTERVAL", DC_DUMP_INTERVAL_DEFAULT);
+    if (dump_interval > 0) {
+        next_dump = time(NULL) + dump_interval;
+    }
+    if (setup_signal_handler(SIGUSR1, dc_dump_handler) == -1) {
+        return -1;
+    }
+
+    if (dc_export_start((size_t)channel_count * DC_CHANNEL_BINS) == -1) {
+        return -1;
+    }
+
+    if (dc_record_start() == -1) {
+        return -1;
+    }
+
+    if (dc_history_start(CHAR_START, letter_counts, CHAR_END - CHAR_START + 1) == -1) {
+        return -1;
+    }
+
+    if (dc_rt_start(cb, sizeof(CircularBuffer)) == -1) {
+        return -1;
+    }
     
     return 0;
 }
 
+//==================================================FUNCTION========================|
+//Name:           dc_sketch_init                                                     |
+//Params:         NONE                                                              |
+//Returns:        int                    Returns 0 on success, -1 on failure.        |
+//Outputs:        NONE                                                              |
+//Description:    This function sets up the approximate heavy-hitter mode when       |
+//                HISTO_SKETCH is set. The Count-Min sketch and the Space-Saving     |
+//                summary are sized once here and never grow.                        |
+//==================================================================================|
+int dc_sketch_init(void) {
+    sketch_enabled = config_get_int("HISTO_SKETCH", DC_SKETCH_DEFAULT);
+    if (!sketch_enabled) {
+        return 0;
+    }
+
+    topk_size = config_get_int("HISTO_TOPK", TOPK_DEFAULT);
+    if (cms_init(&cms, config_get_int("HISTO_CMS_WIDTH", CMS_DEFAULT_WIDTH),
+                 config_get_int("HISTO_CMS_DEPTH", CMS_DEFAULT_DEPTH)) == -1) {
+        fprintf(stderr, "DC: Count-Min sketch width must be 1..%d and depth 1..%d\n",
+                CMS_MAX_WIDTH, CMS_MAX_DEPTH);
+        return -1;
+    }
+    if (ss_init(&topk, topk_size) == -1) {
+        fprintf(stderr, "DC: invalid top-K size\n");
+        cms_free(&cms);
+        return -1;
+    }
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_hll_init                                                        |
+//Params:         NONE                                                              |
+//Returns:        int                    Returns 0 on success, -1 on failure.        |
+//Outputs:        NONE                                                              |
+//Description:    This function sets up the distinct-key estimator, which counts     |
+//                (channel, symbol) keys. If a checkpoint file is configured and     |
+//                exists, it is merged in so the estimate continues across restarts  |
+//                and can combine several shards. A checkpoint that cannot be merged |
+//                stops DC rather than being overwritten with a fresh sketch.        |
+//==================================================================================|
+int dc_hll_init(void) {
+    int precision = config_get_int("HISTO_HLL_PRECISION", HLL_DEFAULT_PRECISION);
+
+    if (precision == 0) {
+        return 0;
+    }
+
+    if (hll_init(&distinct, precision) == -1) {
+        fprintf(stderr, "DC: HyperLogLog precision must be %d..%d\n",
+                HLL_MIN_PRECISION, HLL_MAX_PRECISION);
+        return -1;
+    }
+    hll_enabled = 1;
+
+    hll_checkpoint = config_get_str("HISTO_HLL_CHECKPOINT", NULL);
+    if (hll_checkpoint != NULL && hll_load_merge(&distinct, hll_checkpoint) == -1 &&
+        access(hll_checkpoint, F_OK) == 0) {
+        fprintf(stderr, "DC: cannot merge HyperLogLog checkpoint %s (corrupt, or not "
+                "precision %d)\n", hll_checkpoint, precision);
+        hll_free(&distinct);
+        hll_enabled = 0;
+        return -1;
+    }
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_samples_init                                                    |
+//Params:         NONE                                                              |
+//Returns:        int                    Returns 0 on success, -1 on failure.        |
+//Outputs:        NONE                                                              |
+//Description:    This function sets up the record decoder and the log-linear        |
+//                histogram for numeric samples (HISTO_HDR_DIGITS, HISTO_HDR_HIGHEST). |
+//==================================================================================|
+int dc_samples_init(void) {
+    const char *highest_str;
+    long long highest = HDR_DEFAULT_HIGHEST;
+    int digits;
+
+    rec_decoder_init(&decoder);
+
+    digits = config_get_int("HISTO_HDR_DIGITS", HDR_DEFAULT_DIGITS);
+    if (digits == 0) {
+        return 0;
+    }
+
+    highest_str = config_get_str("HISTO_HDR_HIGHEST", NULL);
+    if (highest_str != NULL) {
+        highest = atoll(highest_str);
+    }
+
+    if (highest < 2 || hdr_init(&samples, (uint64_t)highest, digits) == -1) {
+        fprintf(stderr, "DC: invalid sample histogram settings\n");
+        return -1;
+    }
+    hdr_enabled = 1;
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_on_sample                                                       |
+//Params:         void* ctx              Unused.                                     |
+//                uint64_t value         A numeric sample decoded from the buffer.   |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function is the record decoder callback for sample records.   |
+//==================================================================================|
+void dc_on_sample(void *ctx, uint64_t value) {
+    (void)ctx;
+    if (hdr_enabled) {
+        hdr_record(&samples, value);
+    }
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_dist_init                                                       |
+//Params:         NONE                                                              |
+//Returns:        int                    Returns 0 on success, -1 on failure.        |
+//Outputs:        Prints an error on a bad setting                                  |
+//Description:    This function sets up the running distribution statistics. The    |
+//                expected distribution is HISTO_EXPECTED, or else the producers'   |
+//                HISTO_DIST, so by default the check matches what DP-1 and DP-2    |
+//                were told to generate. With HISTO_SKEW_ALERT set, every batch     |
+//                whose chi-square is above it counts as a skewed batch.            |
+//==================================================================================|
+int dc_dist_init(void) {
+    double weights[CHAR_END - CHAR_START + 1];
+
+    dist_expected = config_get_str("HISTO_EXPECTED", config_get_str("HISTO_DIST", GEN_DIST_DEFAULT));
+    skew_alert = config_get_double("HISTO_SKEW_ALERT", DC_SKEW_ALERT_DEFAULT);
+    if (gen_weights(dist_expected, weights, CHAR_END - CHAR_START + 1) == -1 ||
+        dist_init(&dist, weights, CHAR_END - CHAR_START + 1) == -1 || skew_alert < 0.0) {
+        fprintf(stderr, "DC: invalid expected distribution settings\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_channels_init                                                   |
+//Params:         NONE                                                              |
+//Returns:        int                    Returns 0 on success, -1 on failure.        |
+//Outputs:        NONE                                                              |
+//Description:    This function allocates one ChannelHistogram per channel id below  |
+//                HISTO_CHANNELS in a single cache-aligned block, so a channel's     |
+//                counters never share a line with its neighbour's.                  |
+//==================================================================================|
+int dc_channels_init(void) {
+    size_t size;
+
+    if (CHAR_END - CHAR_START + 1 > DC_CHANNEL_BINS) {
+        fprintf(stderr, "DC: too many symbols for a channel histogram\n");
+        return -1;
+    }
+
+    channel_count = config_get_int("HISTO_CHANNELS", DC_CHANNELS_DEFAULT);
+    if (channel_count <= 0) {
+        channel_count = 0;
+        return 0;
+    }
+    if (channel_count > 65536) {
+        channel_count = 65536;
+    }
+
+    size = (size_t)channel_count * sizeof(ChannelHistogram);
+    channels = aligned_alloc(64, size);
+    if (channels == NULL) {
+        perror("aligned_alloc");
+        return -1;
+    }
+    memset(channels, 0, size);
+
+    display_channel = config_get_int("HISTO_DISPLAY_CHANNEL", DC_DISPLAY_CHANNEL_DEFAULT);
+    if (display_channel >= channel_count) {
+        display_channel = -1;
+    }
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_on_span                                                         |
+//Params:         void* ctx              Unused.                                     |
+//                int channel            Channel the symbols belong to.              |
+//                const char* symbols    The symbols (not NUL-terminated).           |
+//                int count              Number of symbols.                          |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function is the RecordSink callback for channel spans. The    |
+//                symbols count towards their channel and towards the overall        |
+//                histogram; ids beyond HISTO_CHANNELS are only counted overall, and |
+//                reported as dropped when channel histograms are on.                |
+//==================================================================================|
+void dc_on_span(void *ctx, int channel, const char *symbols, int count) {
+    uint32_t *bins = NULL;
+    int i;
+
+    (void)ctx;
+    if (channel < channel_count) {
+        bins = channels[channel].counts;
+    } else if (channel_count > 0) {
+        channel_dropped += (uint64_t)count;
+    }
+
+    for (i = 0; i < count; i++) {
+        if (symbols[i] >= CHAR_START && symbols[i] <= CHAR_END) {
+            letter_counts[symbols[i] - CHAR_START]++;
+            if (bins != NULL) {
+                bins[symbols[i] - CHAR_START]++;
+            }
+        }
+    }
+
+    if (sketch_enabled || hll_enabled) {
+        dc_update_sketches(channel, symbols, count);
+    }
+    dc_ngram_update(channel, symbols, count);
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_on_delta                                                        |
+//Params:         void* ctx              Unused.                                     |
+//                int channel            Channel the counts belong to.               |
+//                int first_key          Key of bins[0].                             |
+//                const uint32_t* bins   Counts a producer aggregated itself.        |
+//                int count              Number of bins.                             |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function is the RecordSink callback for delta records. It    |
+//                folds the counts in with one addition per bin, so its cost does    |
+//                not depend on how many symbols the producer counted. Keys outside  |
+//                CHAR_START..CHAR_END are ignored, as they are for plain symbols.   |
+//==================================================================================|
+void dc_on_delta(void *ctx, int channel, int first_key, const uint32_t *bins, int count) {
+    uint32_t *channel_bins = NULL;
+    int key;
+    int i;
+
+    (void)ctx;
+    if (channel < channel_count) {
+        channel_bins = channels[channel].counts;
+    }
+
+    for (i = 0; i < count; i++) {
+        key = first_key + i;
+        if (bins[i] == 0 || key < CHAR_START || key > CHAR_END) {
+            continue;
+        }
+        letter_counts[key - CHAR_START] += bins[i];
+        if (channel_bins != NULL) {
+            channel_bins[key - CHAR_START] += bins[i];
+        } else if (channel_count > 0) {
+            channel_dropped += bins[i];
+        }
+        dc_update_sketch_key(DC_SKETCH_KEY(channel, key), bins[i]);
+    }
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_on_packed                                                       |
+//Params:         void* ctx              Unused.                                     |
+//                int first_key          The record's lowest symbol.                 |
+//                int bits               Bits per symbol.                            |
+//                const unsigned char* words  The packed words.                      |
+//                int count              Number of symbols.                          |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function is the RecordSink callback for packed records, which |
+//                hold channel-0 symbols, counted by tally_packed. Symbols are only  |
+//                rebuilt as characters when the sketches or the n-gram matrix need  |
+//                them.                                                              |
+//==================================================================================|
+void dc_on_packed(void *ctx, int first_key, int bits, const unsigned char *words, int count) {
+    unsigned char ranks[REC_PACKED_MAX_SYMBOLS];
+    char symbols[REC_PACKED_MAX_SYMBOLS];
+    int n;
+    int i;
+
+    (void)ctx;
+    n = tally_packed(words, count, bits, first_key, ranks, letter_counts,
+                     (channel_count > 0) ? channels[0].counts : NULL);
+
+    if (sketch_enabled || hll_enabled || dc_ngram_order() > 0) {
+        for (i = 0; i < n; i++) {
+            symbols[i] = (char)(first_key + ranks[i]);
+        }
+        if (sketch_enabled || hll_enabled) {
+            dc_update_sketches(0, symbols, n);
+        }
+        /* one record is one producer's write; its n-grams start and end with it */
+        dc_ngram_break(0);
+        dc_ngram_update(0, symbols, n);
+        dc_ngram_break(0);
+    }
+}
+
 //==================================================FUNCTION========================|
 //Name:           dc_process                                                         |
 //Params:         NONE                                                              |
 //Returns:        int                    Returns 0 when completed.                 |
 //Outputs:        NONE                                                              |
 //Description:    This function runs the DC process in a loop, periodically reading data from the circular buffer and displaying the histogram. |
+//                Commands from histo-ctl are applied at the top of each pass.       |
+//                On a hand-off signal it leaves the loop without waiting for the    |
+//                buffer to empty and without stopping the producers.                |
 //==================================================================================|
 int dc_process(void) {
-    while (run) {
+    while (run && !handoff) {
+        dc_rt_pass_begin();
+        ctl_poll(&cb->control, &control_cursor, CTL_DC, dc_apply_control, NULL);
+
         if (alarm_flag) {
             alarm_flag = 0;
             dc_read_data();
             read_count++;
-            if (read_count >= DC_DISPLAY_INTERVAL) {
+            if (read_count >= display_interval) {
                 read_count = 0;
                 dc_display_histogram();
             }
-            alarm(2);
+            alarm(read_interval);
+        }
+
+        if (dump_flag || (dump_interval > 0 && time(NULL) >= next_dump)) {
+            dump_flag = 0;
+            if (dump_interval > 0) {
+                next_dump = time(NULL) + dump_interval;
+            }
+            dc_dump_histogram(dump_path, NULL);
+        }
+
+        dc_history_tick(CHAR_START, letter_counts, CHAR_END - CHAR_START + 1);
+
+        if (dc_export_due()) {
+            DcSnapshot snapshot;
+
+            dc_build_snapshot(&snapshot);
+            dc_export_publish(&snapshot);
         }
         
         if (shutdown) {
-            if (lock_semaphore(sem_id) != -1) {
+            if (lock_buffer(cb, sem_id) != -1) {
                 if (cb->read_index == cb->write_index) {
-                    unlock_semaphore(sem_id);
+                    unlock_buffer(cb, sem_id);
                     break;
                 }
-                unlock_semaphore(sem_id);
+                unlock_buffer(cb, sem_id);
             }
         }
-        usleep(10000); /* 10ms */
+        dc_rt_pass_end();
+        usleep(DC_LOOP_SLEEP_US);
+    }
+
+    if (handoff) {
+        return dc_handoff();
     }
     
     dc_display_histogram();
+    dc_print_stats(stdout);
+    if (dump_interval > 0) {
+        dc_dump_histogram(dump_path, NULL);
+    }
+    {
+        DcSnapshot snapshot;
+
+        dc_build_snapshot(&snapshot);
+        dc_export_stop(&snapshot);
+    }
+    dc_record_stop();
+    dc_history_stop(CHAR_START, letter_counts, CHAR_END - CHAR_START + 1);
+    dc_rt_stop();
     dc_exit();
     
     return 0;
 }
 
+//==================================================FUNCTION========================|
+//Name:           dc_apply_control                                                   |
+//Params:         void* ctx              Unused.                                     |
+//                const ControlCommand* command  A command from histo-ctl.           |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function applies a live setting between drains. A new read    |
+//                interval re-arms the alarm so it takes effect at once.             |
+//==================================================================================|
+void dc_apply_control(void *ctx, const ControlCommand *command) {
+    (void)ctx;
+    switch (command->op) {
+    case CTL_OP_DISPLAY_INTERVAL:
+        display_interval = (command->value < 1) ? 1 : (command->value > INT_MAX) ? INT_MAX
+                                                                             : (int)command->value;
+        break;
+    case CTL_OP_READ_BYTES:
+        read_bytes = (command->value < 1) ? 1 : (command->value > BUFFER_SIZE - 1) ? BUFFER_SIZE - 1
+                                                                                 : (int)command->value;
+        break;
+    case CTL_OP_READ_INTERVAL:
+        read_interval = (command->value < 1) ? 1 : (command->value > INT_MAX) ? INT_MAX
+                                                                          : (int)command->value;
+        alarm(read_interval);
+        break;
+    case CTL_OP_TRACE:
+        trace_set_enabled(command->value != 0);
+        break;
+    default:
+        break;
+    }
+}
+
 //==================================================FUNCTION========================|
 //Name:           dc_read_data                                                       |
 //Params:         NONE                                                              |
 //Returns:        int                    The number of letters processed.           |
 //Outputs:        NONE                                                              |
 //Description:    This function reads data from the circular buffer, updates the letter counts based on the read data. |
+//                While it holds the semaphore it also frees the slots of extra      |
+//                consumers that died without releasing them.                        |
 //==================================================================================|
 int dc_read_data(void) {
-    char buffer[60]; 
+    char buffer[BUFFER_SIZE]; 
     int read_count = 0;
-    int i;
-    if (lock_semaphore(sem_id) == -1) {
+    if (lock_buffer(cb, sem_id) == -1) {
         return 0;
     }
     
-    read_count = cb_read_multi(cb, buffer, 40);
+    TRACE_BEGIN(TRACE_READ);
+    read_count = cb_read_multi(cb, buffer, (size_t)read_bytes);
+    TRACE_END(TRACE_READ, read_count);
+    cb_consumer_reap(cb);
     
-    unlock_semaphore(sem_id);
+    unlock_buffer(cb, sem_id);
+    dc_consume(buffer, read_count);
     
-    for (i = 0; i < read_count; i++) {
-        if (buffer[i] >= CHAR_START && buffer[i] <= CHAR_END) {
-            letter_counts[buffer[i] - CHAR_START]++;
+    return read_count;
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_consume                                                         |
+//Params:         const char* buffer     Bytes drained from the circular buffer.     |
+//                int len                Number of bytes in 'buffer'.                |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function records, decodes and counts one drained span, then   |
+//                publishes the counts to the live histogram for outside readers.    |
+//                The distribution statistics catch up with the counts once per      |
+//                span, whichever record types they came in.                         |
+//==================================================================================|
+void dc_consume(const char *buffer, int len) {
+    char symbols[BUFFER_SIZE];
+    int symbol_count;
+
+    bytes_drained += (uint64_t)len;
+    drain_count++;
+    dc_record_span(buffer, len);
+
+    symbol_count = rec_decode(&decoder, buffer, len, symbols, &sink);
+    tally_symbols(symbols, symbol_count, letter_counts,
+                  (channel_count > 0) ? channels[0].counts : NULL);
+
+    if (sketch_enabled || hll_enabled) {
+        dc_update_sketches(0, symbols, symbol_count);
+    }
+
+    if (dist_sync(&dist, letter_counts) > 0 && skew_alert > 0.0 &&
+        dist_chi_square(&dist) > skew_alert) {
+        skew_batches++;
+    }
+
+    live_publish(&cb->live, CHAR_START, letter_counts, CHAR_END - CHAR_START + 1, drain_count);
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_update_sketches                                                 |
+//Params:         int channel            Channel the bytes belong to, 0 for plain    |
+//                                       and packed symbols.                         |
+//                const char* buffer     The bytes drained from the circular buffer. |
+//                int len                Number of bytes in 'buffer'.                |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function feeds a batch into the heavy-hitter and distinct-key |
+//                sketches. The batch is first collapsed to one count per distinct   |
+//                byte, so the sketches are touched once per key rather than per     |
+//                byte. Keys are (channel, byte), see DC_SKETCH_KEY, so the sketches |
+//                track every channel's symbols apart.                               |
+//==================================================================================|
+void dc_update_sketches(int channel, const char *buffer, int len) {
+    unsigned int batch_counts[256] = {0};
+    int i;
+
+    for (i = 0; i < len; i++) {
+        batch_counts[(unsigned char)buffer[i]]++;
+    }
+
+    for (i = 0; i < 256; i++) {
+        if (batch_counts[i] != 0) {
+            dc_update_sketch_key(DC_SKETCH_KEY(channel, i), batch_counts[i]);
         }
     }
-    
-    return read_count;
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_update_sketch_key                                               |
+//Params:         uint64_t key           The key, from DC_SKETCH_KEY.                |
+//                uint32_t count         Occurrences of the key, at least one.       |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function adds one key's count to whichever sketches are on.   |
+//==================================================================================|
+void dc_update_sketch_key(uint64_t key, uint32_t count) {
+    if (sketch_enabled) {
+        cms_update(&cms, key, count);
+        ss_update(&topk, key, count);
+    }
+    if (hll_enabled) {
+        hll_add(&distinct, key);
+    }
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_display_top_keys                                                |
+//Params:         NONE                                                              |
+//Returns:        NONE                                                              |
+//Outputs:        Prints the top-K table to stdout                                  |
+//Description:    This function prints the heaviest keys from the Space-Saving       |
+//                summary, as channel:symbol, next to their Count-Min estimates and  |
+//                the error bounds.                                                  |
+//==================================================================================|
+void dc_display_top_keys(void) {
+    SsEntry top[TOPK_DEFAULT];
+    SsEntry *entries = top;
+    int symbol;
+    int n, i;
+
+    if (topk_size > TOPK_DEFAULT) {
+        entries = malloc((size_t)topk_size * sizeof(SsEntry));
+        if (entries == NULL) {
+            return;
+        }
+    }
+
+    n = ss_top(&topk, entries, topk_size);
+    printf("\nTop %d keys (N=%llu, CMS %dx%d, +/-%llu, %zu bytes)\n", topk_size,
+           (unsigned long long)cms.total, cms.depth, cms.width,
+           (unsigned long long)cms_error_bound(&cms),
+           cms_memory_size(&cms) + ss_memory_size(&topk));
+    for (i = 0; i < n; i++) {
+        symbol = (int)(entries[i].key & 0xff);
+        printf("  %5llu:", (unsigned long long)(entries[i].key >> 8));
+        if (symbol >= 0x20 && symbol < 0x7f) {
+            printf("'%c'  ", (char)symbol);
+        } else {
+            printf("0x%02x ", symbol);
+        }
+        printf("%10llu (err<=%llu, cms %u)\n", (unsigned long long)entries[i].count,
+               (unsigned long long)entries[i].error, cms_estimate(&cms, entries[i].key));
+    }
+
+    if (entries != top) {
+        free(entries);
+    }
 }
 
 //==================================================FUNCTION========================|
@@ -133,17 +754,26 @@ int dc_read_data(void) {
 //Description:    This function displays the histogram of letter frequencies on the screen. |
 //==================================================================================|
 void dc_display_histogram(void) {
-    int i, j;
-    int hundreds, tens, ones;
+    int i;
+    uint64_t j;
+    uint64_t hundreds, tens, ones;
     
+    uint64_t count;
+    
+    TRACE_BEGIN(TRACE_RENDER);
     dc_clear_screen();
+
+    if (display_channel >= 0) {
+        printf("Channel %d\n", display_channel);
+    }
     
     for (i = 0; i <= (CHAR_END - CHAR_START); i++) {
-        hundreds = letter_counts[i] / 100;
-        tens = (letter_counts[i] % 100) / 10;
-        ones = letter_counts[i] % 10;
+        count = (display_channel >= 0) ? channels[display_channel].counts[i] : letter_counts[i];
+        hundreds = count / 100;
+        tens = (count % 100) / 10;
+        ones = count % 10;
         
-        printf("%c-%03d ", CHAR_START + i, letter_counts[i]);
+        printf("%c-%03llu ", CHAR_START + i, (unsigned long long)count);
         
         for (j = 0; j < hundreds; j++) {
             putchar(HISTOGRAM_HUNDREDS);
@@ -157,6 +787,518 @@ void dc_display_histogram(void) {
         
         putchar('\n');
     }
+
+    if (channel_count > 0) {
+        dc_display_channels();
+    }
+
+    dc_ngram_display(stdout);
+
+    if (hll_enabled) {
+        printf("\nDistinct keys: ~%.0f (HLL p=%d, +/-%.1f%%)\n", hll_estimate(&distinct),
+               distinct.precision, hll_relative_error(&distinct) * 100.0);
+    }
+
+    if (sketch_enabled) {
+        dc_display_top_keys();
+    }
+
+    if (hdr_enabled && samples.total > 0) {
+        dc_display_quantiles();
+    }
+
+    if (dist.total > 0) {
+        dc_display_distribution();
+    }
+    fflush(stdout);
+    TRACE_END(TRACE_RENDER, 0);
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_display_channels                                                |
+//Params:         NONE                                                              |
+//Returns:        NONE                                                              |
+//Outputs:        Prints the busiest channels to stdout                             |
+//Description:    This function prints how many channels have data and the totals    |
+//                of the DC_CHANNEL_SUMMARY busiest ones.                            |
+//==================================================================================|
+void dc_display_channels(void) {
+    uint64_t best_total[DC_CHANNEL_SUMMARY];
+    int best[DC_CHANNEL_SUMMARY];
+    int shown = 0;
+    int active = 0;
+    uint64_t total;
+    int c, i, j;
+
+    for (c = 0; c < channel_count; c++) {
+        total = 0;
+        for (i = 0; i <= (CHAR_END - CHAR_START); i++) {
+            total += channels[c].counts[i];
+        }
+        if (total == 0) {
+            continue;
+        }
+        active++;
+
+        for (j = shown; j > 0 && best_total[j - 1] < total; j--) {
+            if (j < DC_CHANNEL_SUMMARY) {
+                best_total[j] = best_total[j - 1];
+                best[j] = best[j - 1];
+            }
+        }
+        if (j < DC_CHANNEL_SUMMARY) {
+            best_total[j] = total;
+            best[j] = c;
+            if (shown < DC_CHANNEL_SUMMARY) {
+                shown++;
+            }
+        }
+    }
+
+    if (active <= 1 && channel_dropped == 0) {
+        return;
+    }
+
+    printf("\nChannels: %d active", active);
+    if (channel_dropped > 0) {
+        printf(", %llu symbols beyond HISTO_CHANNELS", (unsigned long long)channel_dropped);
+    }
+    putchar('\n');
+    for (i = 0; i < shown; i++) {
+        printf("  #%-5d %llu\n", best[i], (unsigned long long)best_total[i]);
+    }
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_display_quantiles                                               |
+//Params:         NONE                                                              |
+//Returns:        NONE                                                              |
+//Outputs:        Prints the sample quantiles to stdout                             |
+//Description:    This function prints a one-line latency style summary of the       |
+//                numeric samples received so far.                                   |
+//==================================================================================|
+void dc_display_quantiles(void) {
+    printf("\nSamples: n=%llu min=%llu mean=%.1f p50=%llu p99=%llu p99.99=%llu max=%llu\n",
+           (unsigned long long)samples.total, (unsigned long long)samples.min,
+           hdr_mean(&samples),
+           (unsigned long long)hdr_value_at_quantile(&samples, 0.50),
+           (unsigned long long)hdr_value_at_quantile(&samples, 0.99),
+           (unsigned long long)hdr_value_at_quantile(&samples, 0.9999),
+           (unsigned long long)samples.max);
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_display_distribution                                            |
+//Params:         NONE                                                              |
+//Returns:        NONE                                                              |
+//Outputs:        Prints the distribution statistics to stdout                      |
+//Description:    This function prints the total, the smallest and largest bins, the |
+//                entropy against its maximum, and the chi-square against the        |
+//                expected distribution with its degrees of freedom. SKEW marks a    |
+//                chi-square above HISTO_SKEW_ALERT.                                 |
+//==================================================================================|
+void dc_display_distribution(void) {
+    double chi_square = dist_chi_square(&dist);
+
+    printf("\nDistribution: n=%llu min=%c:%llu max=%c:%llu entropy=%.3f/%.3f bits "
+           "chi2=%.1f (%d df, %s)%s\n",
+           (unsigned long long)dist.total, CHAR_START + dist.min_bin,
+           (unsigned long long)dist.counts[dist.min_bin], CHAR_START + dist.max_bin,
+           (unsigned long long)dist.counts[dist.max_bin], dist_entropy(&dist),
+           log2((double)dist.bins), chi_square, dist.bins - 1, dist_expected,
+           (skew_alert > 0.0 && chi_square > skew_alert) ? " SKEW" : "");
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_print_stats                                                     |
+//Params:         FILE* out              Stream to write the statistics to.          |
+//Returns:        NONE                                                              |
+//Outputs:        Prints one "key=value" statistic per line                         |
+//Description:    This function prints the run statistics in a form that scripts can |
+//                parse, as opposed to the bar display.                              |
+//==================================================================================|
+void dc_print_stats(FILE *out) {
+    uint64_t total = 0;
+    int i;
+
+    for (i = 0; i <= (CHAR_END - CHAR_START); i++) {
+        total += letter_counts[i];
+    }
+
+    fprintf(out, "total_letters=%llu\n", (unsigned long long)total);
+    fprintf(out, "min_bin=%c\nmin_count=%llu\n", CHAR_START + dist.min_bin,
+            (unsigned long long)dist.counts[dist.min_bin]);
+    fprintf(out, "max_bin=%c\nmax_count=%llu\n", CHAR_START + dist.max_bin,
+            (unsigned long long)dist.counts[dist.max_bin]);
+    fprintf(out, "entropy_bits=%.4f\n", dist_entropy(&dist));
+    fprintf(out, "chi_square=%.4f\n", dist_chi_square(&dist));
+    if (skew_alert > 0.0) {
+        fprintf(out, "skew_batches=%llu\n", (unsigned long long)skew_batches);
+    }
+    if (channel_count > 0) {
+        fprintf(out, "channel_dropped=%llu\n", (unsigned long long)channel_dropped);
+    }
+    if (cb != NULL && cb->lock_recoveries > 0) {
+        fprintf(out, "lock_recoveries=%llu\n", (unsigned long long)cb->lock_recoveries);
+        fprintf(out, "lock_dead_owner=%d\n", (int)cb->lock_dead_owner);
+    }
+    if (dc_record_dropped() > 0) {
+        fprintf(out, "record_dropped=%llu\n", (unsigned long long)dc_record_dropped());
+    }
+    if (hll_enabled) {
+        fprintf(out, "distinct_keys=%.0f\n", hll_estimate(&distinct));
+        fprintf(out, "distinct_keys_rel_error=%.4f\n", hll_relative_error(&distinct));
+    }
+    if (sketch_enabled) {
+        fprintf(out, "sketch_total=%llu\n", (unsigned long long)cms.total);
+        fprintf(out, "sketch_error_bound=%llu\n", (unsigned long long)cms_error_bound(&cms));
+    }
+    if (hdr_enabled) {
+        fprintf(out, "samples=%llu\n", (unsigned long long)samples.total);
+        fprintf(out, "samples_clamped=%llu\n", (unsigned long long)samples.clamped);
+        fprintf(out, "sample_p50=%llu\n", (unsigned long long)hdr_value_at_quantile(&samples, 0.50));
+        fprintf(out, "sample_p99=%llu\n", (unsigned long long)hdr_value_at_quantile(&samples, 0.99));
+        fprintf(out, "sample_p9999=%llu\n", (unsigned long long)hdr_value_at_quantile(&samples, 0.9999));
+    }
+    dc_rt_print_stats(out);
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_build_snapshot                                                  |
+//Params:         DcSnapshot* snapshot   Snapshot to fill.                           |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function copies the counts and pipeline statistics into a     |
+//                snapshot for the exporter thread, which never touches DC's live    |
+//                state.                                                             |
+//==================================================================================|
+void dc_build_snapshot(DcSnapshot *snapshot) {
+    struct timespec now;
+    int i;
+
+    clock_gettime(CLOCK_REALTIME, &now);
+    memset(snapshot, 0, sizeof(*snapshot));
+    snapshot->timestamp_ms = (uint64_t)now.tv_sec * 1000 + (uint64_t)now.tv_nsec / 1000000;
+    snapshot->first_key = CHAR_START;
+    snapshot->bin_count = CHAR_END - CHAR_START + 1;
+    for (i = 0; i < snapshot->bin_count; i++) {
+        snapshot->counts[i] = letter_counts[i];
+    }
+    snapshot->channel_counts = (channel_count > 0) ? channels[0].counts : NULL;
+    snapshot->channel_count = channel_count;
+    snapshot->channel_stride = DC_CHANNEL_BINS;
+    snapshot->total = dist.total;
+    snapshot->min_key = (char)(CHAR_START + dist.min_bin);
+    snapshot->min_count = dist.counts[dist.min_bin];
+    snapshot->max_key = (char)(CHAR_START + dist.max_bin);
+    snapshot->max_count = dist.counts[dist.max_bin];
+    snapshot->entropy = dist_entropy(&dist);
+    snapshot->chi_square = dist_chi_square(&dist);
+    snapshot->has_skew = (skew_alert > 0.0);
+    snapshot->skew_batches = skew_batches;
+    snapshot->bytes_read = bytes_drained;
+    snapshot->reads = drain_count;
+    if (hll_enabled) {
+        snapshot->has_distinct = 1;
+        snapshot->distinct = hll_estimate(&distinct);
+    }
+    if (hdr_enabled && samples.total > 0) {
+        snapshot->samples = samples.total;
+        snapshot->sample_sum = samples.sum;
+        snapshot->sample_p50 = hdr_value_at_quantile(&samples, 0.50);
+        snapshot->sample_p99 = hdr_value_at_quantile(&samples, 0.99);
+        snapshot->sample_p9999 = hdr_value_at_quantile(&samples, 0.9999);
+    }
+    snapshot->ngram_count = dc_ngram_top(snapshot->ngrams, snapshot->ngram_counts,
+                                         DC_EXPORT_MAX_NGRAMS);
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_dump_histogram                                                  |
+//Params:         const char* path       File to write.                              |
+//                const HfSection* origin  An origin section to write first, or      |
+//                                       NULL.                                       |
+//Returns:        int                    Returns 0 on success, -1 on failure.        |
+//Outputs:        Writes the binary histogram file                                  |
+//Description:    This function writes the letter counts in the binary histogram     |
+//                format (see histo_file.h) for histo-merge to combine.              |
+//==================================================================================|
+int dc_dump_histogram(const char *path, const HfSection *origin) {
+    uint64_t bins[CHAR_END - CHAR_START + 1];
+    HfSection sections[2];
+    HfSection section;
+    int i;
+
+    for (i = 0; i <= (CHAR_END - CHAR_START); i++) {
+        bins[i] = letter_counts[i];
+    }
+
+    section.type = HF_SECTION_SYMBOLS;
+    section.channel = 0;
+    section.first_key = CHAR_START;
+    section.bin_count = CHAR_END - CHAR_START + 1;
+    section.bins = bins;
+
+    if (channel_count > 0) {
+        return dc_dump_channels(path, &section, origin);
+    }
+    if (origin == NULL) {
+        return hf_write_file(path, &section, 1);
+    }
+    sections[0] = *origin;
+    sections[1] = section;
+    return hf_write_file(path, sections, 2);
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_dump_channels                                                   |
+//Params:         const char* path       File to write.                              |
+//                const HfSection* all   The overall symbols section.                |
+//                const HfSection* origin  An origin section to write first, or      |
+//                                       NULL.                                       |
+//Returns:        int                    Returns 0 on success, -1 on failure.        |
+//Outputs:        Writes the binary histogram file                                  |
+//Description:    This function writes the overall section followed by one           |
+//                HF_SECTION_CHANNEL section for every channel that has data.        |
+//==================================================================================|
+int dc_dump_channels(const char *path, const HfSection *all, const HfSection *origin) {
+    int bin_count = CHAR_END - CHAR_START + 1;
+    HfSection *sections;
+    uint64_t *bins;
+    uint64_t total;
+    int count = 1;
+    int result;
+    int c, i;
+
+    sections = malloc(((size_t)channel_count + 2) * sizeof(HfSection));
+    bins = malloc((size_t)channel_count * (size_t)bin_count * sizeof(uint64_t));
+    if (sections == NULL || bins == NULL) {
+        free(sections);
+        free(bins);
+        return -1;
+    }
+
+    if (origin != NULL) {
+        sections[0] = *origin;
+        count++;
+    }
+    sections[count - 1] = *all;
+    for (c = 0; c < channel_count; c++) {
+        total = 0;
+        for (i = 0; i < bin_count; i++) {
+            bins[(size_t)c * bin_count + i] = channels[c].counts[i];
+            total += channels[c].counts[i];
+        }
+        if (total == 0) {
+            continue;
+        }
+        sections[count].type = HF_SECTION_CHANNEL;
+        sections[count].channel = c;
+        sections[count].first_key = CHAR_START;
+        sections[count].bin_count = bin_count;
+        sections[count].bins = bins + (size_t)c * bin_count;
+        count++;
+    }
+
+    result = hf_write_file(path, sections, count);
+    free(sections);
+    free(bins);
+
+    return result;
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_handoff                                                         |
+//Params:         NONE                                                              |
+//Returns:        int                    Returns 0 on success, -1 on failure.        |
+//Outputs:        Writes the hand-off file                                          |
+//Description:    This function detaches DC for a hot restart. It first reads on to  |
+//                the end of the record in progress, which producers always write    |
+//                whole, so the ring's read position is left on a record boundary   |
+//                for the next DC. The counts go to HISTO_HANDOFF_PATH, after an     |
+//                origin section naming this pipeline's segment. The shared memory,  |
+//                the semaphore and the producers are left running; after a SIGHUP   |
+//                DC then executes DC_PROCESS again in its place.                    |
+//==================================================================================|
+int dc_handoff(void) {
+    char buffer[BUFFER_SIZE];
+    uint64_t origin_bins[3];
+    HfSection origin;
+    int need;
+    int n;
+    int result;
+
+    if (lock_buffer(cb, sem_id) == -1) {
+        return -1;
+    }
+    while ((need = rec_decoder_pending(&decoder)) > 0) {
+        if (need > BUFFER_SIZE) {
+            need = BUFFER_SIZE;
+        }
+        n = cb_read_multi(cb, buffer, (size_t)need);
+        if (n <= 0) {
+            break;
+        }
+        dc_consume(buffer, n);
+    }
+    unlock_buffer(cb, sem_id);
+
+    origin.type = HF_SECTION_ORIGIN;
+    origin.channel = 0;
+    origin.first_key = 0;
+    origin.bin_count = 3;
+    origin.bins = origin_bins;
+    result = dc_origin(origin_bins);
+    if (result == 0) {
+        result = dc_dump_histogram(handoff_path, &origin);
+    }
+    {
+        DcSnapshot snapshot;
+
+        dc_build_snapshot(&snapshot);
+        dc_export_stop(&snapshot);
+    }
+    dc_record_stop();
+    dc_history_stop(CHAR_START, letter_counts, CHAR_END - CHAR_START + 1);
+    dc_rt_stop();
+    dc_cleanup();
+    if (result == -1) {
+        fprintf(stderr, "DC: could not write %s, counts not handed off\n", handoff_path);
+        return -1;
+    }
+
+    if (handoff == DC_HANDOFF_EXEC) {
+        char shm_id_str[20];
+        char dp1_pid_str[20];
+        char dp2_pid_str[20];
+        char path[PATH_MAX];
+
+        snprintf(shm_id_str, sizeof(shm_id_str), "%d", shm_id_g);
+        snprintf(dp1_pid_str, sizeof(dp1_pid_str), "%d", (int)dp1_pid_g);
+        snprintf(dp2_pid_str, sizeof(dp2_pid_str), "%d", (int)dp2_pid_g);
+        if (instance_program(DC_PROCESS, path, sizeof(path)) == -1) {
+            return -1;
+        }
+        /* the new DC sets up its SIGALRM handler only after attaching */
+        alarm(0);
+        execl(path, "dc", shm_id_str, dp1_pid_str, dp2_pid_str, NULL);
+        perror("execl");
+        return -1;
+    }
+
+    printf("DC detached, counts in %s\n", handoff_path);
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_origin                                                          |
+//Params:         uint64_t* origin       Receives the shm id, the segment's creation |
+//                                       time and DP-1's pid, three values.          |
+//Returns:        int                    Returns 0 on success, -1 on failure.        |
+//Outputs:        NONE                                                              |
+//Description:    This function names the pipeline DC is attached to. The creation   |
+//                time tells a new segment apart from an old one whose id the kernel |
+//                has handed out again, and DP-1's pid a new pipeline that reuses a  |
+//                segment left behind.                                               |
+//==================================================================================|
+int dc_origin(uint64_t *origin) {
+    struct shmid_ds info;
+
+    if (shmctl(shm_id_g, IPC_STAT, &info) == -1) {
+        perror("shmctl IPC_STAT");
+        return -1;
+    }
+    origin[0] = (uint64_t)shm_id_g;
+    origin[1] = (uint64_t)info.shm_ctime;
+    origin[2] = (uint64_t)dp1_pid_g;
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_restore_section                                                 |
+//Params:         void* ctx              The DcRestore.                              |
+//                const HfSection* section  A section of the hand-off file.         |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function adds one section of a hand-off file to the counts.   |
+//                Counts are only taken once the origin section, which comes first,  |
+//                has matched this pipeline.                                         |
+//==================================================================================|
+void dc_restore_section(void *ctx, const HfSection *section) {
+    DcRestore *restore = (DcRestore *)ctx;
+    uint32_t *channel_bins = NULL;
+    int key;
+    int i;
+
+    if (section->type == HF_SECTION_ORIGIN) {
+        restore->matched = section->bin_count == 3 &&
+                           section->bins[0] == restore->origin[0] &&
+                           section->bins[1] == restore->origin[1] &&
+                           section->bins[2] == restore->origin[2];
+        return;
+    }
+    if (!restore->matched) {
+        return;
+    }
+
+    if (section->type == HF_SECTION_CHANNEL) {
+        if (section->channel >= channel_count) {
+            return;
+        }
+        channel_bins = channels[section->channel].counts;
+    } else if (section->type != HF_SECTION_SYMBOLS) {
+        return;
+    }
+
+    for (i = 0; i < section->bin_count; i++) {
+        key = section->first_key + i;
+        if (key < CHAR_START || key > CHAR_END) {
+            continue;
+        }
+        if (channel_bins != NULL) {
+            channel_bins[key - CHAR_START] += (uint32_t)section->bins[i];
+        } else {
+            letter_counts[key - CHAR_START] += section->bins[i];
+        }
+    }
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_restore                                                         |
+//Params:         const char* path       The hand-off file.                          |
+//Returns:        int                    Returns 0 on success or when there is no    |
+//                                       file, -1 if it could not be read.           |
+//Outputs:        NONE                                                              |
+//Description:    This function picks up the counts a detached DC left behind and    |
+//                removes the file, so they are restored only once. A file left by   |
+//                another pipeline (another segment) is ignored and kept.            |
+//==================================================================================|
+int dc_restore(const char *path) {
+    HfReadBuffer rb = {0};
+    DcRestore restore = {{0, 0, 0}, 0};
+    int result;
+
+    if (access(path, F_OK) != 0) {
+        return 0;
+    }
+    if (dc_origin(restore.origin) == -1) {
+        return -1;
+    }
+
+    result = hf_read_file(path, &rb, dc_restore_section, &restore);
+    hf_read_buffer_free(&rb);
+    if (result == -1) {
+        fprintf(stderr, "DC: could not read %s\n", path);
+        return -1;
+    }
+    if (!restore.matched) {
+        fprintf(stderr, "DC: ignoring %s, it was left by another pipeline\n", path);
+        return 0;
+    }
+
+    unlink(path);
+    return 0;
 }
 
 //==================================================FUNCTION========================|
@@ -178,10 +1320,36 @@ void dc_clear_screen(void) {
 //Description:    This function performs cleanup tasks for the DC process, including detaching shared memory. |
 //==================================================================================|
 void dc_cleanup(void) {
+    trace_close();
+
     if (cb != NULL) {
         detach_shared_memory(cb);
         cb = NULL;
     }
+
+    if (sketch_enabled) {
+        cms_free(&cms);
+        ss_free(&topk);
+        sketch_enabled = 0;
+    }
+
+    if (hll_enabled) {
+        if (hll_checkpoint != NULL) {
+            hll_save(&distinct, hll_checkpoint);
+        }
+        hll_free(&distinct);
+        hll_enabled = 0;
+    }
+
+    if (hdr_enabled) {
+        hdr_free(&samples);
+        hdr_enabled = 0;
+    }
+
+    free(channels);
+    channels = NULL;
+    channel_count = 0;
+    dc_ngram_free();
 }
 
 //==================================================FUNCTION========================|
@@ -232,3 +1400,33 @@ void dc_alarm_handler(int sig) {
         alarm_flag = 1;
     }
 }
+
+//==================================================FUNCTION========================|
+//Name:           dc_handoff_handler                                                 |
+//Params:         int sig               The signal number received.                 |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function requests a hot restart: SIGUSR2 detaches DC and      |
+//                exits, SIGHUP detaches DC and starts it again in place.            |
+//==================================================================================|
+void dc_handoff_handler(int sig) {
+    if (sig == SIGUSR2) {
+        handoff = DC_HANDOFF_EXIT;
+    } else if (sig == SIGHUP) {
+        handoff = DC_HANDOFF_EXEC;
+    }
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_dump_handler                                                    |
+//Params:         int sig               The signal number received.                 |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function handles SIGUSR1 by requesting a histogram dump from  |
+//                the main loop.                                                     |
+//==================================================================================|
+void dc_dump_handler(int sig) {
+    if (sig == SIGUSR1) {
+        dump_flag = 1;
+    }
+}
@@ -0,0 +1,176 @@
+/*
+*	FILE:			dc_history.c
+*	ASSIGNMENT:	The "Histogram System"
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This file implements DC's history stage. DC's counts only grow,
+*                 so an interval's record is the difference from the counts at the
+*                 previous boundary. Intervals are aligned to the clock, and when one
+*                 closes the hour and day levels roll up whatever periods it
+*                 completed. A partial interval is written on exit and summed with
+*                 the rest of it after a restart.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "../../common/inc/constants.h"
+#include "../../common/inc/config.h"
+#include "../../common/inc/tseries.h"
+#include "../inc/dc_history.h"
+
+static TsWriter writers[TS_LEVELS];
+static char prefix[4096];
+static int running = 0;
+static uint32_t interval = DC_HISTORY_INTERVAL_DEFAULT;
+static uint64_t interval_start = 0;
+static uint64_t last_counts[TS_MAX_BINS];
+
+//==================================================FUNCTION========================|
+//Name:           dc_history_rollup                                                  |
+//Params:         uint64_t now           Current time in seconds.                    |
+//Returns:        NONE                                                              |
+//Outputs:        Prints an error if a rollup fails                                 |
+//Description:    This function brings the hour and day levels up to 'now'.          |
+//==================================================================================|
+static void dc_history_rollup(uint64_t now) {
+    int level;
+
+    for (level = 1; level < TS_LEVELS; level++) {
+        if (ts_rollup(&writers[level], prefix, now) == -1) {
+            fprintf(stderr, "DC: history rollup of level %d failed\n", level);
+        }
+    }
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_history_flush                                                   |
+//Params:         int first_key          Key of counts[0].                           |
+//                const uint64_t* counts DC's counts.                                |
+//                int bin_count          Number of counts.                           |
+//                uint64_t now           Current time in seconds.                    |
+//Returns:        NONE                                                              |
+//Outputs:        Prints an error if the record cannot be written                   |
+//Description:    This function writes the interval that started at interval_start,|
+//                unless nothing was counted in it, and starts the next one.        |
+//==================================================================================|
+static void dc_history_flush(int first_key, const uint64_t *counts, int bin_count, uint64_t now) {
+    TsRecord record;
+    uint64_t total = 0;
+    int i;
+
+    record.start_s = interval_start;
+    record.first_key = first_key;
+    record.bin_count = bin_count;
+    for (i = 0; i < bin_count; i++) {
+        record.counts[i] = counts[i] - last_counts[i];
+        total += record.counts[i];
+        last_counts[i] = counts[i];
+    }
+    if (total > 0 && ts_writer_append(&writers[0], &record) == -1) {
+        fprintf(stderr, "DC: history write failed, interval at %llu lost\n",
+                (unsigned long long)interval_start);
+    }
+
+    interval_start = now / interval * interval;
+    dc_history_rollup(now);
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_history_start                                                   |
+//Params:         int first_key          Key of counts[0].                           |
+//                const uint64_t* counts DC's counts so far, restored ones included. |
+//                int bin_count          Number of counts, up to TS_MAX_BINS.        |
+//Returns:        int                    Returns 0 on success, -1 on failure.        |
+//Outputs:        Prints an error on a bad setting                                  |
+//Description:    This function starts the history when HISTO_HISTORY_PATH (the     |
+//                series prefix) is set. HISTO_HISTORY_INTERVAL must divide an hour |
+//                so that intervals nest in the rollups. Rollups missed while DC   |
+//                was down are caught up here.                                      |
+//==================================================================================|
+int dc_history_start(int first_key, const uint64_t *counts, int bin_count) {
+    const char *path;
+    uint64_t data_size;
+    int level;
+    int value;
+
+    (void)first_key;
+    path = config_get_str("HISTO_HISTORY_PATH", NULL);
+    if (path == NULL || path[0] == '\0') {
+        return 0;
+    }
+    if (strlen(path) >= sizeof(prefix) || bin_count > TS_MAX_BINS) {
+        fprintf(stderr, "DC: cannot keep history at %s\n", path);
+        return -1;
+    }
+    strcpy(prefix, path);
+
+    value = config_get_int("HISTO_HISTORY_INTERVAL", DC_HISTORY_INTERVAL_DEFAULT);
+    if (value < 1 || value > 3600 || 3600 % value != 0) {
+        fprintf(stderr, "DC: HISTO_HISTORY_INTERVAL must divide 3600, not %d\n", value);
+        return -1;
+    }
+    interval = (uint32_t)value;
+    value = config_get_int("HISTO_HISTORY_SEGMENT_KB", DC_HISTORY_SEGMENT_KB_DEFAULT);
+    data_size = (uint64_t)((value < 4) ? 4 : value) * 1024;
+
+    for (level = 0; level < TS_LEVELS; level++) {
+        if (ts_writer_open(&writers[level], prefix, level,
+                           (level == 0) ? interval : ts_level_span(level), data_size) == -1) {
+            while (--level >= 0) {
+                ts_writer_close(&writers[level]);
+            }
+            return -1;
+        }
+    }
+
+    memcpy(last_counts, counts, sizeof(uint64_t) * (size_t)bin_count);
+    interval_start = (uint64_t)time(NULL) / interval * interval;
+    dc_history_rollup((uint64_t)time(NULL));
+    running = 1;
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_history_tick                                                    |
+//Params:         int first_key          Key of counts[0].                           |
+//                const uint64_t* counts DC's counts.                                |
+//                int bin_count          Number of counts.                           |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function is called every pass of DC's loop and writes the    |
+//                interval once it is over.                                         |
+//==================================================================================|
+void dc_history_tick(int first_key, const uint64_t *counts, int bin_count) {
+    uint64_t now;
+
+    if (!running) {
+        return;
+    }
+    now = (uint64_t)time(NULL);
+    if (now >= interval_start + interval) {
+        dc_history_flush(first_key, counts, bin_count, now);
+    }
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_history_stop                                                    |
+//Params:         int first_key          Key of counts[0].                           |
+//                const uint64_t* counts DC's final counts.                          |
+//                int bin_count          Number of counts.                           |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function writes the partial interval and closes the series.  |
+//==================================================================================|
+void dc_history_stop(int first_key, const uint64_t *counts, int bin_count) {
+    int level;
+
+    if (!running) {
+        return;
+    }
+    dc_history_flush(first_key, counts, bin_count, (uint64_t)time(NULL));
+    for (level = 0; level < TS_LEVELS; level++) {
+        ts_writer_close(&writers[level]);
+    }
+    running = 0;
+}
@@ -0,0 +1,254 @@
+/*
+*	FILE:			dc_ngram.c
+*	ASSIGNMENT:	The "Histogram System"
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This file implements DC's n-gram mode. The count for the n-gram
+*                 s1..sn lives at cell ((s1 * A) + s2) * A + ... + sn, with A the
+*                 alphabet size. The matrix is one cache-aligned block, 400 cells
+*                 for bigrams and 8000 for trigrams. The last symbols of every context are
+*                 carried between drains, so an n-gram split by a drain, or by the
+*                 ring wrapping around, is still counted. A byte outside the
+*                 alphabet breaks the chain, and so does dc_ngram_break.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "../../common/inc/config.h"
+#include "../inc/dc_ngram.h"
+
+typedef struct {
+    uint8_t filled;                /* symbols of context held, up to order - 1 */
+    uint8_t last;                  /* the latest symbol */
+    uint8_t before_last;           /* the one before it (trigrams only) */
+} NgramContext;
+
+static int order = 0;
+static uint64_t *matrix = NULL;
+static size_t cells = 0;
+static NgramContext *contexts = NULL;
+static int context_count = 0;
+
+//==================================================FUNCTION========================|
+//Name:           dc_ngram_init                                                      |
+//Params:         int streams            Number of independent streams to follow.    |
+//Returns:        int                    Returns 0 on success, -1 on failure.        |
+//Outputs:        NONE                                                              |
+//Description:    This function reads HISTO_NGRAM (0 off, 2 or 3) and allocates the  |
+//                matrix and one context per stream.                                 |
+//==================================================================================|
+int dc_ngram_init(int streams) {
+    size_t size;
+    int i;
+
+    order = config_get_int("HISTO_NGRAM", DC_NGRAM_DEFAULT);
+    if (order == 0) {
+        return 0;
+    }
+    if (order != 2 && order != 3) {
+        fprintf(stderr, "DC: HISTO_NGRAM must be 0, 2 or 3\n");
+        order = 0;
+        return -1;
+    }
+
+    cells = 1;
+    for (i = 0; i < order; i++) {
+        cells *= DC_NGRAM_ALPHABET;
+    }
+    size = (cells * sizeof(uint64_t) + 63) & ~(size_t)63;
+    matrix = aligned_alloc(64, size);
+    context_count = (streams > 0) ? streams : 1;
+    contexts = calloc((size_t)context_count, sizeof(NgramContext));
+    if (matrix == NULL || contexts == NULL) {
+        perror("ngram alloc");
+        dc_ngram_free();
+        return -1;
+    }
+    memset(matrix, 0, size);
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_ngram_order                                                     |
+//Params:         NONE                                                              |
+//Returns:        int                    2 or 3, or 0 when n-gram mode is off.       |
+//Outputs:        NONE                                                              |
+//Description:    This function reports the configured n.                            |
+//==================================================================================|
+int dc_ngram_order(void) {
+    return order;
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_ngram_update                                                    |
+//Params:         int context            Stream the symbols belong to.               |
+//                const char* symbols    The next symbols of that stream.            |
+//                int count              Number of symbols.                          |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function counts the n-grams ending in each symbol. There is a |
+//                loop per order so the inner loop has no divisions and no branch on |
+//                n; the context is kept in locals and stored once at the end.       |
+//                Contexts beyond the ones allocated are ignored.                    |
+//==================================================================================|
+void dc_ngram_update(int context, const char *symbols, int count) {
+    NgramContext *ctx;
+    unsigned int last;
+    unsigned int before_last;
+    unsigned int key;
+    int filled;
+    int i;
+
+    if (order == 0 || context < 0 || context >= context_count) {
+        return;
+    }
+
+    ctx = &contexts[context];
+    filled = ctx->filled;
+    last = ctx->last;
+    before_last = ctx->before_last;
+
+    if (order == 2) {
+        for (i = 0; i < count; i++) {
+            key = (unsigned int)(unsigned char)symbols[i] - CHAR_START;
+            if (key >= DC_NGRAM_ALPHABET) {
+                filled = 0;
+                continue;
+            }
+            if (filled) {
+                matrix[last * DC_NGRAM_ALPHABET + key]++;
+            }
+            filled = 1;
+            last = key;
+        }
+    } else {
+        for (i = 0; i < count; i++) {
+            key = (unsigned int)(unsigned char)symbols[i] - CHAR_START;
+            if (key >= DC_NGRAM_ALPHABET) {
+                filled = 0;
+                continue;
+            }
+            if (filled == 2) {
+                matrix[(before_last * DC_NGRAM_ALPHABET + last) * DC_NGRAM_ALPHABET + key]++;
+            } else {
+                filled++;
+            }
+            before_last = last;
+            last = key;
+        }
+    }
+
+    ctx->filled = (uint8_t)filled;
+    ctx->last = (uint8_t)last;
+    ctx->before_last = (uint8_t)before_last;
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_ngram_break                                                     |
+//Params:         int context            Stream to restart.                          |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function forgets a context's last symbols, so the next symbol |
+//                starts a new chain. It marks the end of a write that DC knows is   |
+//                complete, such as a packed record.                                 |
+//==================================================================================|
+void dc_ngram_break(int context) {
+    if (order == 0 || context < 0 || context >= context_count) {
+        return;
+    }
+    contexts[context].filled = 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_ngram_top                                                       |
+//Params:         char keys[][]          Receives the n-grams as strings.            |
+//                uint64_t* counts       Receives their counts.                      |
+//                int max                Most n-grams to return.                     |
+//Returns:        int                    Number of n-grams returned, most frequent   |
+//                                       first. N-grams never seen are left out.     |
+//Outputs:        NONE                                                              |
+//Description:    This function finds the most frequent n-grams by insertion into a  |
+//                short sorted list, one pass over the matrix.                       |
+//==================================================================================|
+int dc_ngram_top(char keys[][DC_NGRAM_MAX_ORDER + 1], uint64_t *counts, int max) {
+    size_t top_cells[DC_NGRAM_TOP];
+    size_t cell;
+    size_t rest;
+    int found = 0;
+    int i, j;
+
+    if (order == 0 || max <= 0) {
+        return 0;
+    }
+    if (max > DC_NGRAM_TOP) {
+        max = DC_NGRAM_TOP;
+    }
+
+    for (cell = 0; cell < cells; cell++) {
+        if (matrix[cell] == 0 || (found == max && matrix[cell] <= counts[found - 1])) {
+            continue;
+        }
+        i = (found < max) ? found++ : max - 1;
+        while (i > 0 && counts[i - 1] < matrix[cell]) {
+            counts[i] = counts[i - 1];
+            top_cells[i] = top_cells[i - 1];
+            i--;
+        }
+        counts[i] = matrix[cell];
+        top_cells[i] = cell;
+    }
+
+    for (i = 0; i < found; i++) {
+        rest = top_cells[i];
+        for (j = order - 1; j >= 0; j--) {
+            keys[i][j] = (char)(CHAR_START + rest % DC_NGRAM_ALPHABET);
+            rest /= DC_NGRAM_ALPHABET;
+        }
+        keys[i][order] = '\0';
+    }
+
+    return found;
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_ngram_display                                                   |
+//Params:         FILE* out              Where to print.                             |
+//Returns:        NONE                                                              |
+//Outputs:        Prints the most frequent transitions                              |
+//Description:    This function prints the top transitions under the histogram, as   |
+//                "AB->C 42" for trigrams and "A->B 42" for bigrams.                 |
+//==================================================================================|
+void dc_ngram_display(FILE *out) {
+    char keys[DC_NGRAM_TOP][DC_NGRAM_MAX_ORDER + 1];
+    uint64_t counts[DC_NGRAM_TOP];
+    int found;
+    int i;
+
+    found = dc_ngram_top(keys, counts, DC_NGRAM_TOP);
+    if (found == 0) {
+        return;
+    }
+
+    fprintf(out, "\nTop transitions (n=%d):\n", order);
+    for (i = 0; i < found; i++) {
+        fprintf(out, "  %.*s->%c %llu\n", order - 1, keys[i], keys[i][order - 1],
+                (unsigned long long)counts[i]);
+    }
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_ngram_free                                                      |
+//Params:         NONE                                                              |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function releases the matrix and the contexts.                |
+//==================================================================================|
+void dc_ngram_free(void) {
+    free(matrix);
+    free(contexts);
+    matrix = NULL;
+    contexts = NULL;
+    context_count = 0;
+    cells = 0;
+    order = 0;
+}
@@ -0,0 +1,225 @@
+/*
+*	FILE:			dc_record.c
+*	ASSIGNMENT:	The "Histogram System"
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This file implements DC's recording stage. The main loop copies
+*                 each drained span into the block being filled; full blocks are
+*                 queued for a writer thread that codes them and appends them to the
+*                 segment log. Blocks come from a fixed pool, so if the disk falls
+*                 behind, spans are dropped and counted rather than stalling DC.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "../../common/inc/constants.h"
+#include "../../common/inc/config.h"
+#include "../../common/inc/stream_log.h"
+#include "../inc/dc_record.h"
+
+static pthread_t writer_thread;
+static pthread_mutex_t queue_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t queue_cond = PTHREAD_COND_INITIALIZER;
+static SlBlock blocks[DC_RECORD_BLOCKS];
+static int free_list[DC_RECORD_BLOCKS];
+static int free_count = 0;
+static int queue[DC_RECORD_BLOCKS];      /* full blocks, oldest first */
+static int queue_head = 0;
+static int queue_count = 0;
+static int filling = -1;                 /* block the main loop appends to */
+static int stopping = 0;
+static int running = 0;
+static uint64_t dropped = 0;
+static uint64_t start_ns = 0;
+static SlWriter log_writer;
+
+//==================================================FUNCTION========================|
+//Name:           dc_record_now_us                                                   |
+//Params:         NONE                                                              |
+//Returns:        uint64_t               Microseconds since recording started.       |
+//Outputs:        NONE                                                              |
+//Description:    This function timestamps spans on the monotonic clock.             |
+//==================================================================================|
+static uint64_t dc_record_now_us(void) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec - start_ns) / 1000;
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_record_thread                                                   |
+//Params:         void* arg              Unused.                                     |
+//Returns:        void*                  NULL                                        |
+//Outputs:        Appends blocks to the stream log                                  |
+//Description:    This function is the writer thread. It takes the oldest full       |
+//                block, writes it without holding the lock, and returns it to the   |
+//                free list.                                                         |
+//==================================================================================|
+static void *dc_record_thread(void *arg) {
+    int index;
+
+    (void)arg;
+    for (;;) {
+        pthread_mutex_lock(&queue_lock);
+        while (queue_count == 0 && !stopping) {
+            pthread_cond_wait(&queue_cond, &queue_lock);
+        }
+        if (queue_count == 0) {
+            pthread_mutex_unlock(&queue_lock);
+            break;
+        }
+        index = queue[queue_head];
+        queue_head = (queue_head + 1) % DC_RECORD_BLOCKS;
+        queue_count--;
+        pthread_mutex_unlock(&queue_lock);
+
+        if (sl_writer_write_block(&log_writer, &blocks[index]) == -1) {
+            fprintf(stderr, "DC: stream log write failed\n");
+        }
+        sl_block_reset(&blocks[index]);
+
+        pthread_mutex_lock(&queue_lock);
+        free_list[free_count++] = index;
+        pthread_mutex_unlock(&queue_lock);
+    }
+
+    return NULL;
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_record_start                                                    |
+//Params:         NONE                                                              |
+//Returns:        int                    Returns 0 on success, -1 on failure.        |
+//Outputs:        NONE                                                              |
+//Description:    This function starts recording when HISTO_RECORD_PATH (the segment |
+//                prefix) is set. HISTO_RECORD_BLOCK_KB sizes the blocks and         |
+//                HISTO_RECORD_SEGMENT_MB the segments.                              |
+//==================================================================================|
+int dc_record_start(void) {
+    const char *prefix;
+    struct timespec now;
+    size_t block_size;
+    int i;
+
+    prefix = config_get_str("HISTO_RECORD_PATH", NULL);
+    if (prefix == NULL || prefix[0] == '\0') {
+        return 0;
+    }
+
+    block_size = (size_t)config_get_int("HISTO_RECORD_BLOCK_KB", DC_RECORD_BLOCK_KB_DEFAULT) * 1024;
+    if (block_size < 1024) {
+        block_size = 1024;
+    }
+    if (sl_writer_open(&log_writer, prefix,
+                       (uint64_t)config_get_int("HISTO_RECORD_SEGMENT_MB",
+                                                DC_RECORD_SEGMENT_MB_DEFAULT) << 20) == -1) {
+        return -1;
+    }
+
+    for (i = 0; i < DC_RECORD_BLOCKS; i++) {
+        if (sl_block_init(&blocks[i], block_size) == -1) {
+            fprintf(stderr, "DC: cannot allocate record blocks\n");
+            return -1;
+        }
+        if (i > 0) {
+            free_list[free_count++] = i;
+        }
+    }
+    filling = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    start_ns = (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+
+    if (pthread_create(&writer_thread, NULL, dc_record_thread, NULL) != 0) {
+        fprintf(stderr, "DC: cannot start record thread\n");
+        return -1;
+    }
+    running = 1;
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_record_span                                                     |
+//Params:         const char* span       Bytes just drained from the ring.           |
+//                int len                Number of bytes.                            |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function appends a span to the filling block. When the block  |
+//                is full, or older than DC_RECORD_FLUSH_MS, it is queued and a free |
+//                one taken; with none free, the span is dropped.                    |
+//==================================================================================|
+void dc_record_span(const char *span, int len) {
+    uint64_t now;
+
+    if (!running || len <= 0) {
+        return;
+    }
+
+    now = dc_record_now_us();
+    if (filling != -1 &&
+        (blocks[filling].span_count == 0 || now - blocks[filling].base_us < DC_RECORD_FLUSH_MS * 1000ULL) &&
+        sl_block_add(&blocks[filling], now, span, len) == 0) {
+        return;
+    }
+
+    pthread_mutex_lock(&queue_lock);
+    if (filling != -1) {
+        queue[(queue_head + queue_count) % DC_RECORD_BLOCKS] = filling;
+        queue_count++;
+        pthread_cond_signal(&queue_cond);
+    }
+    filling = (free_count > 0) ? free_list[--free_count] : -1;
+    pthread_mutex_unlock(&queue_lock);
+
+    if (filling == -1 || sl_block_add(&blocks[filling], now, span, len) == -1) {
+        dropped += (uint64_t)len;
+    }
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_record_dropped                                                  |
+//Params:         NONE                                                              |
+//Returns:        uint64_t               Bytes left out of the recording.            |
+//Outputs:        NONE                                                              |
+//Description:    This function reports how much the writer could not keep up with. |
+//==================================================================================|
+uint64_t dc_record_dropped(void) {
+    return dropped;
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_record_stop                                                     |
+//Params:         NONE                                                              |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function queues the partly filled block, waits for the writer |
+//                to drain the queue, and closes the log.                            |
+//==================================================================================|
+void dc_record_stop(void) {
+    int i;
+
+    if (!running) {
+        return;
+    }
+
+    pthread_mutex_lock(&queue_lock);
+    if (filling != -1 && blocks[filling].span_count > 0) {
+        queue[(queue_head + queue_count) % DC_RECORD_BLOCKS] = filling;
+        queue_count++;
+        filling = -1;
+    }
+    stopping = 1;
+    pthread_cond_signal(&queue_cond);
+    pthread_mutex_unlock(&queue_lock);
+    pthread_join(writer_thread, NULL);
+
+    sl_writer_close(&log_writer);
+    for (i = 0; i < DC_RECORD_BLOCKS; i++) {
+        sl_block_free(&blocks[i]);
+    }
+    running = 0;
+}
@@ -0,0 +1,359 @@
+/*
+*	FILE:			dc_rt.c
+*	ASSIGNMENT:	The "Histogram System"
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This file implements DC's low-jitter mode (HISTO_RT=1). At start
+*                 it touches every page of the shared segment and DC_RT_STACK_KB of
+*                 stack, then locks all of DC's memory, so the drain loop takes no
+*                 page faults. With HISTO_RT_PRIORITY it moves the drain loop, and
+*                 only it, to SCHED_FIFO. The exporter and recorder threads stay on
+*                 the normal scheduler. The watchdog is RLIMIT_RTTIME: if the loop
+*                 runs HISTO_RT_WATCHDOG_MS without blocking, the kernel sends
+*                 SIGXCPU and DC drops back to the normal scheduler instead of
+*                 starving the CPU. Every pass is timed: how long its work took,
+*                 and how late it woke from the sleep between passes.
+*/
+
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <sched.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include "../../common/inc/constants.h"
+#include "../../common/inc/config.h"
+#include "../../common/inc/ipc_utils.h"
+#include "../../common/inc/hdr_histogram.h"
+#include "../inc/dc_rt.h"
+
+static int running = 0;
+static int locked = 0;
+static int priority = 0;
+static int watchdog_ms = 0;
+static struct rlimit saved_rttime;
+static pid_t loop_tid = 0;
+static volatile sig_atomic_t watchdog_fired = 0;
+static int watchdog_reported = 0;
+static HdrHistogram pass_us;
+static HdrHistogram late_us;
+static uint64_t pass_start_ns = 0;
+static uint64_t pass_end_ns = 0;
+
+//==================================================FUNCTION========================|
+//Name:           dc_rt_now_ns                                                       |
+//Params:         NONE                                                              |
+//Returns:        uint64_t               Monotonic time in nanoseconds.              |
+//Outputs:        NONE                                                              |
+//Description:    This function reads the clock the passes are timed with.           |
+//==================================================================================|
+static uint64_t dc_rt_now_ns(void) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_rt_prefault_stack                                               |
+//Params:         NONE                                                              |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function writes DC_RT_STACK_KB of stack so those pages are   |
+//                mapped before mlockall. The drain buffers live well inside it.    |
+//==================================================================================|
+static void __attribute__((noinline)) dc_rt_prefault_stack(void) {
+    volatile unsigned char stack[DC_RT_STACK_KB * 1024];
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t i;
+
+    for (i = 0; i < sizeof(stack); i += page) {
+        stack[i] = 0;
+    }
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_rt_prefault_shared                                              |
+//Params:         const void* shared     The attached segment.                       |
+//                size_t size            Its size in bytes.                          |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function reads one byte of every page of the segment, so     |
+//                the first drain does not fault them in. Reading is enough and      |
+//                does not race the producers.                                      |
+//==================================================================================|
+static void dc_rt_prefault_shared(const void *shared, size_t size) {
+    const volatile unsigned char *bytes = (const volatile unsigned char *)shared;
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t i;
+
+    for (i = 0; i < size; i += page) {
+        (void)bytes[i];
+    }
+    if (size > 0) {
+        (void)bytes[size - 1];
+    }
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_rt_watchdog_handler                                             |
+//Params:         int sig               The signal number received.                 |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function handles SIGXCPU from RLIMIT_RTTIME. It may run on   |
+//                any of DC's threads, so it demotes the drain loop by thread id.   |
+//                It is reported from the loop by dc_rt_pass_begin.                 |
+//==================================================================================|
+static void dc_rt_watchdog_handler(int sig) {
+    struct sched_param param;
+
+    if (sig == SIGXCPU) {
+        memset(&param, 0, sizeof(param));
+        sched_setscheduler(loop_tid, SCHED_OTHER, &param);
+        watchdog_fired = 1;
+    }
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_rt_schedule                                                     |
+//Params:         NONE                                                              |
+//Returns:        int                    Returns 0 on success, -1 on failure.        |
+//Outputs:        Prints an error if the class cannot be changed                    |
+//Description:    This function arms the watchdog and then moves the calling thread |
+//                to SCHED_FIFO at 'priority'. The watchdog goes first so there is  |
+//                never an unguarded real-time loop.                                |
+//==================================================================================|
+static int dc_rt_schedule(void) {
+    struct sched_param param;
+    struct rlimit limit;
+
+    loop_tid = (pid_t)syscall(SYS_gettid);
+    if (getrlimit(RLIMIT_RTTIME, &saved_rttime) == -1) {
+        perror("DC: getrlimit");
+        return -1;
+    }
+    limit = saved_rttime;
+    limit.rlim_cur = (rlim_t)watchdog_ms * 1000;
+    if (limit.rlim_max != RLIM_INFINITY && limit.rlim_cur > limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+    }
+    if (setup_signal_handler(SIGXCPU, dc_rt_watchdog_handler) == -1 ||
+        setrlimit(RLIMIT_RTTIME, &limit) == -1) {
+        perror("DC: watchdog");
+        return -1;
+    }
+
+    memset(&param, 0, sizeof(param));
+    param.sched_priority = priority;
+    if (sched_setscheduler(0, SCHED_FIFO, &param) == -1) {
+        perror("DC: SCHED_FIFO");
+        setrlimit(RLIMIT_RTTIME, &saved_rttime);
+        return -1;
+    }
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_rt_start                                                        |
+//Params:         const void* shared     The attached circular buffer segment.       |
+//                size_t shared_size     Its size in bytes.                          |
+//Returns:        int                    Returns 0 on success, -1 on failure.        |
+//Outputs:        Prints a warning if memory cannot be locked                       |
+//Description:    This function enters low-jitter mode when HISTO_RT is set. It is  |
+//                called last in dc_init, once the counts, sketches and stage       |
+//                buffers are allocated. mlockall(MCL_CURRENT) locks them along     |
+//                with the segment. MCL_FUTURE is not used, because under           |
+//                RLIMIT_MEMLOCK it would make later segment files fail to map. A   |
+//                failed lock is a warning: the mode still prefaults and times the  |
+//                loop, and rt_locked=0 in the statistics shows it. A bad priority, |
+//                or one the user may not set, fails DC.                            |
+//==================================================================================|
+int dc_rt_start(const void *shared, size_t shared_size) {
+    int max_priority;
+
+    if (config_get_int("HISTO_RT", 0) == 0) {
+        return 0;
+    }
+    priority = config_get_int("HISTO_RT_PRIORITY", 0);
+    watchdog_ms = config_get_int("HISTO_RT_WATCHDOG_MS", DC_RT_WATCHDOG_MS_DEFAULT);
+    max_priority = sched_get_priority_max(SCHED_FIFO);
+    if (priority < 0 || priority > max_priority || watchdog_ms < 1) {
+        fprintf(stderr, "DC: HISTO_RT_PRIORITY must be 0 to %d and HISTO_RT_WATCHDOG_MS "
+                        "at least 1\n", max_priority);
+        return -1;
+    }
+
+    if (hdr_init(&pass_us, DC_RT_HIGHEST_US, HDR_DEFAULT_DIGITS) == -1 ||
+        hdr_init(&late_us, DC_RT_HIGHEST_US, HDR_DEFAULT_DIGITS) == -1) {
+        hdr_free(&pass_us);
+        fprintf(stderr, "DC: cannot allocate the loop histograms\n");
+        return -1;
+    }
+
+    dc_rt_prefault_shared(shared, shared_size);
+    dc_rt_prefault_stack();
+    if (mlockall(MCL_CURRENT) == -1) {
+        fprintf(stderr, "DC: mlockall: %s, running unlocked (raise RLIMIT_MEMLOCK)\n",
+                strerror(errno));
+    } else {
+        locked = 1;
+    }
+
+    if (priority > 0 && dc_rt_schedule() == -1) {
+        if (locked) {
+            munlockall();
+            locked = 0;
+        }
+        hdr_free(&pass_us);
+        hdr_free(&late_us);
+        return -1;
+    }
+
+    running = 1;
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_rt_pass_begin                                                   |
+//Params:         NONE                                                              |
+//Returns:        NONE                                                              |
+//Outputs:        Reports a watchdog demotion once                                  |
+//Description:    This function is called at the top of each pass of DC's loop. It |
+//                records how far past DC_LOOP_SLEEP_US the sleep since the last |
+//                pass ran.                                                         |
+//==================================================================================|
+void dc_rt_pass_begin(void) {
+    uint64_t slept_us;
+
+    if (!running) {
+        return;
+    }
+    if (watchdog_fired && !watchdog_reported) {
+        watchdog_reported = 1;
+        fprintf(stderr, "DC: loop ran %d ms without blocking, back to the normal scheduler\n",
+                watchdog_ms);
+    }
+
+    pass_start_ns = dc_rt_now_ns();
+    if (pass_end_ns != 0) {
+        slept_us = (pass_start_ns - pass_end_ns) / 1000;
+        hdr_record(&late_us, (slept_us > DC_LOOP_SLEEP_US) ? slept_us - DC_LOOP_SLEEP_US : 0);
+    }
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_rt_pass_end                                                     |
+//Params:         NONE                                                              |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function is called before the sleep at the end of a pass and |
+//                records how long the pass worked.                                 |
+//==================================================================================|
+void dc_rt_pass_end(void) {
+    if (!running) {
+        return;
+    }
+    pass_end_ns = dc_rt_now_ns();
+    hdr_record(&pass_us, (pass_end_ns - pass_start_ns) / 1000);
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_rt_print_buckets                                                |
+//Params:         FILE* out              Stream to write to.                         |
+//                const char* name       Statistic name prefix.                      |
+//                const HdrHistogram* h  The histogram.                              |
+//Returns:        NONE                                                              |
+//Outputs:        Prints "<name>_le_<bound>=<count>" per non-empty bucket           |
+//Description:    This function prints the jitter histogram in power-of-two buckets |
+//                of microseconds: each line counts the passes above the previous   |
+//                bound and up to this one. The first bucket is 0 to 1 us.          |
+//==================================================================================|
+static void dc_rt_print_buckets(FILE *out, const char *name, const HdrHistogram *h) {
+    uint64_t buckets[64] = {0};
+    uint64_t value;
+    int bucket;
+    int i;
+
+    for (i = 0; i < h->counts_len; i++) {
+        if (h->counts[i] == 0) {
+            continue;
+        }
+        value = hdr_value_at_index(h, i);
+        bucket = 0;
+        while (bucket < 63 && (1ULL << bucket) < value) {
+            bucket++;
+        }
+        buckets[bucket] += h->counts[i];
+    }
+    for (bucket = 0; bucket < 64; bucket++) {
+        if (buckets[bucket] > 0) {
+            fprintf(out, "%s_le_%llu=%llu\n", name, 1ULL << bucket,
+                    (unsigned long long)buckets[bucket]);
+        }
+    }
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_rt_print_stats                                                  |
+//Params:         FILE* out              Stream to write the statistics to.          |
+//Returns:        NONE                                                              |
+//Outputs:        Prints "key=value" lines                                          |
+//Description:    This function prints the low-jitter mode's state, the quantiles of |
+//                the pass and wake-up times, and the pass time histogram.          |
+//==================================================================================|
+void dc_rt_print_stats(FILE *out) {
+    if (!running) {
+        return;
+    }
+    fprintf(out, "rt_locked=%d\n", locked);
+    fprintf(out, "rt_priority=%d\n", priority);
+    fprintf(out, "rt_watchdog_fired=%d\n", (int)watchdog_fired);
+    fprintf(out, "rt_passes=%llu\n", (unsigned long long)pass_us.total);
+    if (pass_us.total == 0) {
+        return;
+    }
+    fprintf(out, "rt_pass_us_p50=%llu\n", (unsigned long long)hdr_value_at_quantile(&pass_us, 0.50));
+    fprintf(out, "rt_pass_us_p99=%llu\n", (unsigned long long)hdr_value_at_quantile(&pass_us, 0.99));
+    fprintf(out, "rt_pass_us_p9999=%llu\n", (unsigned long long)hdr_value_at_quantile(&pass_us, 0.9999));
+    fprintf(out, "rt_pass_us_max=%llu\n", (unsigned long long)pass_us.max);
+    if (late_us.total > 0) {
+        fprintf(out, "rt_wake_late_us_p50=%llu\n", (unsigned long long)hdr_value_at_quantile(&late_us, 0.50));
+        fprintf(out, "rt_wake_late_us_p99=%llu\n", (unsigned long long)hdr_value_at_quantile(&late_us, 0.99));
+        fprintf(out, "rt_wake_late_us_max=%llu\n", (unsigned long long)late_us.max);
+    }
+    dc_rt_print_buckets(out, "rt_pass_us", &pass_us);
+}
+
+//==================================================FUNCTION========================|
+//Name:           dc_rt_stop                                                         |
+//Params:         NONE                                                              |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function leaves low-jitter mode. The scheduling class and    |
+//                RLIMIT_RTTIME survive exec, so they are put back before a hot     |
+//                restart; the new DC applies its own settings.                     |
+//==================================================================================|
+void dc_rt_stop(void) {
+    struct sched_param param;
+
+    if (!running) {
+        return;
+    }
+    if (priority > 0) {
+        memset(&param, 0, sizeof(param));
+        sched_setscheduler(0, SCHED_OTHER, &param);
+        setrlimit(RLIMIT_RTTIME, &saved_rttime);
+        signal(SIGXCPU, SIG_DFL);
+    }
+    if (locked) {
+        munlockall();
+        locked = 0;
+    }
+    hdr_free(&pass_us);
+    hdr_free(&late_us);
+    running = 0;
+}
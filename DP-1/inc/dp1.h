@@ -9,6 +9,7 @@
 #ifndef DP1_H
 #define DP1_H
 
+#include <stdint.h>
 #include <sys/types.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -17,9 +18,18 @@
 #include <time.h>
 #include <signal.h>
 #include <sys/wait.h>
+#include <limits.h>
+#include "control.h"
 
 int dp1_init(void);
 int dp1_process(void);
+int dp1_process_samples(void);
+void dp1_check_packing(void);
+int dp1_write_letters(const char *letters, int count);
+void dp1_count_letters(const char *letters, int count);
+int dp1_publish_delta(int force);
+void dp1_apply_control(void *ctx, const ControlCommand *command);
+void dp1_generate_samples(uint64_t *values, int count);
 void dp1_generate_letters(char *buffer, int count);
 pid_t dp1_launch_dp2(int shm_id);
 void dp1_cleanup(void);
@@ -10,6 +10,11 @@
 #include "../../common/inc/constants.h"
 #include "../../common/inc/circular_buffer.h"
 #include "../../common/inc/ipc_utils.h"
+#include "../../common/inc/config.h"
+#include "../../common/inc/record.h"
+#include "../../common/inc/trace.h"
+#include "../../common/inc/generator.h"
+#include "../../common/inc/instance.h"
 #include "../inc/dp1.h"
 
 static CircularBuffer *cb = NULL;
@@ -17,6 +22,21 @@ static int shm_id = -1;
 static int sem_id = -1;
 static pid_t dp2_pid = -1;
 static int run = 1;
+static int sample_mode = 0;
+static int channel_count = 0;
+static int next_channel = 0;
+static int sleep_base_us = DP1_SLEEP_TIME;
+static int batch = DP1_BATCH_DEFAULT;
+static int overload = CTL_OVERLOAD_DROP;
+static uint32_t control_cursor = 0;
+static int delta_mode = 0;
+static int pack_bits = 0;
+static int pack_min = 0;
+static int delta_interval_ms = DP1_DELTA_INTERVAL_MS_DEFAULT;
+static uint64_t delta_counts[CHAR_END - CHAR_START + 1];
+static uint64_t next_delta_ms = 0;
+static SymbolGenerator generator;
+static ArrivalPattern arrival;
 
 //==================================================FUNCTION========================|
 //Name:           dp1_init                                                           |
@@ -25,15 +45,54 @@ static int run = 1;
 //Outputs:        NONE                                                              |
 //Description:    Initializes shared memory, semaphore, circular buffer, sets       |
 //                up signal handler, and launches DP2 process.                      |
+//                The keys come from HISTO_INSTANCE; DP-1 refuses to start when      |
+//                that instance's segment is still attached by a running pipeline.   |
 //==================================================================================|
 int dp1_init(void) {
+    key_t sem_key;
+    key_t shm_key;
+
     srand(time(NULL));
-    sem_id = create_semaphore(SEM_KEY);
+    if (gen_init_from_config(&generator, (uint64_t)time(NULL)) == -1) {
+        return -1;
+    }
+    arrival_init_from_config(&arrival);
+    sample_mode = config_get_int("HISTO_DP1_SAMPLES", DP1_SAMPLES_DEFAULT);
+    channel_count = config_get_int("HISTO_DP1_CHANNELS", DP1_CHANNELS_DEFAULT);
+    if (channel_count > 65536) {
+        channel_count = 65536;
+    }
+    if (config_get_int("HISTO_DP1_PACKED", DP1_PACKED_DEFAULT)) {
+        pack_bits = rec_packed_bits(CHAR_END - CHAR_START + 1);
+        if (pack_bits == -1) {
+            fprintf(stderr, "DP-1: alphabet too large to pack, sending plain letters\n");
+            pack_bits = 0;
+        }
+        for (pack_min = 1; pack_bits > 0 && pack_min < REC_PACKED_MAX_SYMBOLS &&
+                           rec_packed_size(pack_min, pack_bits) >= pack_min; pack_min++) {
+        }
+        dp1_check_packing();
+    }
+    delta_mode = config_get_int("HISTO_DP1_DELTA", DP1_DELTA_DEFAULT);
+    delta_interval_ms = config_get_int("HISTO_DELTA_INTERVAL_MS", DP1_DELTA_INTERVAL_MS_DEFAULT);
+    if (delta_interval_ms < 1) {
+        delta_interval_ms = 1;
+    }
+    trace_init("DP-1");
+    if (instance_keys(&sem_key, &shm_key) == -1) {
+        return -1;
+    }
+    if (instance_in_use(shm_key)) {
+        fprintf(stderr, "DP-1: instance '%s' is already running\n", instance_name());
+        return -1;
+    }
+
+    sem_id = create_semaphore(sem_key);
     if (sem_id == -1) {
         return -1;
     }
 
-    shm_id = create_shared_memory(SHM_KEY, sizeof(CircularBuffer));
+    shm_id = create_shared_memory(shm_key, sizeof(CircularBuffer));
     if (shm_id == -1) {
         return -1;
     }
@@ -46,6 +105,8 @@ int dp1_init(void) {
     if (cb_init(cb) == -1) {
         return -1;
     }
+    instance_stamp(cb);
+    control_cursor = ctl_cursor(&cb->control);
 
     if (setup_signal_handler(SIGINT, dp1_signal_handler) == -1) {
         return -1;
@@ -66,34 +127,331 @@ int dp1_init(void) {
 //Outputs:        NONE                                                              |
 //Description:    Main loop that generates and writes letters to circular buffer.   |
 //                Locks/unlocks the semaphore for safe shared memory access.        |
+//                The pause between writes follows the configured arrival pattern. |
+//                Commands from histo-ctl are applied at the top of each pass.       |
+//                Under CTL_OVERLOAD_BLOCK a batch that does not fit is retried      |
+//                every DP1_BLOCK_RETRY_US instead of being cut short.               |
+//                With HISTO_DP1_DELTA set the letters are only counted here and a   |
+//                delta record is written every HISTO_DELTA_INTERVAL_MS.             |
 //==================================================================================|
 int dp1_process(void) {
-    char buffer[20];
-    int to_write;
+    char buffer[DP1_MAX_BATCH];
+    int count;
+    int written;
+    int n;
+    int sleep_us;
+    int send;
+
+    if (sample_mode) {
+        return dp1_process_samples();
+    }
 
     while (run) {
-        dp1_generate_letters(buffer, 20);
+        ctl_poll(&cb->control, &control_cursor, CTL_DP1, dp1_apply_control, NULL);
 
-        if (lock_semaphore(sem_id) == -1) {
+        sleep_us = arrival_next_sleep(&arrival, sleep_base_us, &send);
+        if (!send) {
+            usleep(sleep_us);
             continue;
         }
 
-        to_write = cb_get_free_space(cb);
-        if (to_write > 20) {
-            to_write = 20;
+        count = batch;
+        dp1_generate_letters(buffer, count);
+
+        if (delta_mode) {
+            dp1_count_letters(buffer, count);
+            dp1_publish_delta(0);
+            usleep(sleep_us);
+            continue;
+        }
+
+        written = 0;
+        while (run && written < count) {
+            if (lock_buffer(cb, sem_id) == -1) {
+                break;
+            }
+            TRACE_BEGIN(TRACE_WRITE);
+            n = dp1_write_letters(buffer + written, count - written);
+            written += n;
+            if (written < count) {
+                TRACE_INSTANT(TRACE_RING_FULL, count - written);
+            }
+            TRACE_END(TRACE_WRITE, n);
+            unlock_buffer(cb, sem_id);
+
+            if (overload == CTL_OVERLOAD_DROP) {
+                break;
+            }
+            if (written < count) {
+                usleep(DP1_BLOCK_RETRY_US);
+            }
+        }
+
+        usleep(sleep_us);
+    }
+
+    if (delta_mode) {
+        dp1_publish_delta(1);
+    }
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           dp1_count_letters                                                  |
+//Params:         const char* letters     Letters generated this pass.               |
+//                int count               Number of letters.                         |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    Adds the letters to the counts waiting for the next delta record.  |
+//==================================================================================|
+void dp1_count_letters(const char *letters, int count) {
+    int i;
+
+    for (i = 0; i < count; i++) {
+        if (letters[i] >= CHAR_START && letters[i] <= CHAR_END) {
+            delta_counts[letters[i] - CHAR_START]++;
+        }
+    }
+}
+
+//==================================================FUNCTION========================|
+//Name:           dp1_publish_delta                                                  |
+//Params:         int force               Non-zero to publish before the interval is |
+//                                        up, as on shutdown.                        |
+//Returns:        int                     0 if a record was written or none was due, |
+//                                        -1 if it did not fit in the buffer.        |
+//Outputs:        Writes a delta record to the circular buffer                      |
+//Description:    Writes the waiting counts as one delta record for channel 0 and    |
+//                clears them. A record that does not fit is not cut short; the      |
+//                counts stay and go out with the next attempt, so none are lost.    |
+//==================================================================================|
+int dp1_publish_delta(int force) {
+    char record[REC_DELTA_MAX_SIZE];
+    uint32_t bins[CHAR_END - CHAR_START + 1];
+    struct timespec now;
+    uint64_t now_ms;
+    int len;
+    int i;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    now_ms = (uint64_t)now.tv_sec * 1000 + (uint64_t)now.tv_nsec / 1000000;
+    if (!force && now_ms < next_delta_ms) {
+        return 0;
+    }
+
+    for (i = 0; i <= CHAR_END - CHAR_START; i++) {
+        bins[i] = (delta_counts[i] > UINT32_MAX) ? UINT32_MAX : (uint32_t)delta_counts[i];
+    }
+    len = rec_encode_delta(record, 0, CHAR_START, bins, CHAR_END - CHAR_START + 1);
+
+    if (lock_buffer(cb, sem_id) == -1) {
+        return -1;
+    }
+    TRACE_BEGIN(TRACE_WRITE);
+    if (cb_get_free_space(cb) < len) {
+        TRACE_INSTANT(TRACE_RING_FULL, len);
+        TRACE_END(TRACE_WRITE, 0);
+        unlock_buffer(cb, sem_id);
+        return -1;
+    }
+    cb_write_multi(cb, record, (size_t)len);
+    TRACE_END(TRACE_WRITE, len);
+    unlock_buffer(cb, sem_id);
+
+    for (i = 0; i <= CHAR_END - CHAR_START; i++) {
+        delta_counts[i] -= bins[i];
+    }
+    next_delta_ms = now_ms + (uint64_t)delta_interval_ms;
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           dp1_check_packing                                                  |
+//Params:         NONE                                                              |
+//Returns:        NONE                                                              |
+//Outputs:        Prints a warning to stderr                                        |
+//Description:    Warns when HISTO_DP1_PACKED is set but the batch is too small for  |
+//                a packed record to be shorter than the plain letters. With 20     |
+//                letters a record is a 4-byte header and two 8-byte words, the same|
+//                20 bytes, so packing only pays off from pack_min letters (21).    |
+//==================================================================================|
+void dp1_check_packing(void) {
+    if (pack_bits > 0 && channel_count == 0 && batch < pack_min) {
+        fprintf(stderr, "DP-1: packing saves nothing below %d letters per batch (batch is %d); "
+                "raise it with 'histo-ctl dp1 batch'\n", pack_min, batch);
+    }
+}
+
+//==================================================FUNCTION========================|
+//Name:           dp1_write_letters                                                  |
+//Params:         const char* letters     Letters to write.                          |
+//                int count               Number of letters.                         |
+//Returns:        int                     Letters written; the rest did not fit.     |
+//Outputs:        Writes to the circular buffer                                     |
+//Description:    Writes as many letters as fit. The caller holds the semaphore.    |
+//                With HISTO_DP1_CHANNELS set, they go out as channel spans and the  |
+//                channels are visited round-robin. Otherwise, with               |
+//                HISTO_DP1_PACKED set, they go out as packed records; a run too    |
+//                short for packing to save space (below pack_min) goes out plain.  |
+//==================================================================================|
+int dp1_write_letters(const char *letters, int count) {
+    char span[REC_CHANNEL_HEADER + REC_SPAN_MAX];
+    char packed[REC_PACKED_HEADER + REC_PACKED_MAX_SYMBOLS];
+    int per_word;
+    int to_write;
+    int written = 0;
+    int len;
+
+    if (channel_count == 0 && pack_bits > 0) {
+        per_word = 64 / pack_bits;
+        while (count - written >= pack_min) {
+            to_write = (cb_get_free_space(cb) - REC_PACKED_HEADER) / 8 * per_word;
+            if (to_write > count - written) {
+                to_write = count - written;
+            }
+            if (to_write > REC_PACKED_MAX_SYMBOLS) {
+                to_write = REC_PACKED_MAX_SYMBOLS;
+            }
+            if (to_write < pack_min) {
+                break;
+            }
+            len = rec_encode_packed(packed, letters + written, to_write, CHAR_START, pack_bits);
+            cb_write_multi(cb, packed, (size_t)len);
+            written += to_write;
         }
+    }
 
+    if (channel_count == 0) {
+        to_write = cb_get_free_space(cb);
+        if (to_write > count - written) {
+            to_write = count - written;
+        }
         if (to_write > 0) {
-            cb_write_multi(cb, buffer, to_write);
+            cb_write_multi(cb, letters + written, (size_t)to_write);
+            written += to_write;
+        }
+        return written;
+    }
+
+    while (written < count) {
+        to_write = cb_get_free_space(cb) - REC_CHANNEL_HEADER;
+        if (to_write > count - written) {
+            to_write = count - written;
+        }
+        if (to_write > REC_SPAN_MAX) {
+            to_write = REC_SPAN_MAX;
+        }
+        if (to_write <= 0) {
+            break;
         }
+        len = rec_encode_span(span, next_channel, letters + written, to_write);
+        cb_write_multi(cb, span, (size_t)len);
+        next_channel = (next_channel + 1) % channel_count;
+        written += to_write;
+    }
+
+    return written;
+}
 
-        unlock_semaphore(sem_id);
-        usleep(DP1_SLEEP_TIME);
+//==================================================FUNCTION========================|
+//Name:           dp1_apply_control                                                  |
+//Params:         void* ctx               Unused.                                    |
+//                const ControlCommand* command  A command from histo-ctl.           |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    Applies a live setting. Out-of-range values are clamped.          |
+//==================================================================================|
+void dp1_apply_control(void *ctx, const ControlCommand *command) {
+    (void)ctx;
+    switch (command->op) {
+    case CTL_OP_SLEEP_US:
+        sleep_base_us = (command->value < 0) ? 0 : (command->value > INT_MAX) ? INT_MAX
+                                                                             : (int)command->value;
+        break;
+    case CTL_OP_BATCH:
+        batch = (command->value < 1) ? 1 : (command->value > DP1_MAX_BATCH) ? DP1_MAX_BATCH
+                                                                           : (int)command->value;
+        dp1_check_packing();
+        break;
+    case CTL_OP_OVERLOAD:
+        overload = (command->value == CTL_OVERLOAD_BLOCK) ? CTL_OVERLOAD_BLOCK : CTL_OVERLOAD_DROP;
+        break;
+    case CTL_OP_TRACE:
+        trace_set_enabled(command->value != 0);
+        break;
+    default:
+        break;
+    }
+}
+
+//==================================================FUNCTION========================|
+//Name:           dp1_process_samples                                                |
+//Params:         NONE                                                              |
+//Returns:        int                     0 when terminated cleanly                 |
+//Outputs:        NONE                                                              |
+//Description:    Main loop used when HISTO_DP1_SAMPLES is set. Writes numeric      |
+//                sample records instead of letters. Only whole records are written, |
+//                so DC never sees a record that was cut off by a full buffer.       |
+//==================================================================================|
+int dp1_process_samples(void) {
+    uint64_t values[DP1_SAMPLES_PER_WRITE];
+    char buffer[DP1_SAMPLES_PER_WRITE * REC_SAMPLE_SIZE];
+    int fit;
+    int len;
+    int i;
+
+    while (run) {
+        ctl_poll(&cb->control, &control_cursor, CTL_DP1, dp1_apply_control, NULL);
+        dp1_generate_samples(values, DP1_SAMPLES_PER_WRITE);
+
+        if (lock_buffer(cb, sem_id) == -1) {
+            continue;
+        }
+
+        TRACE_BEGIN(TRACE_WRITE);
+        fit = cb_get_free_space(cb) / REC_SAMPLE_SIZE;
+        if (fit > DP1_SAMPLES_PER_WRITE) {
+            fit = DP1_SAMPLES_PER_WRITE;
+        }
+
+        len = 0;
+        for (i = 0; i < fit; i++) {
+            len += rec_encode_sample(buffer + len, values[i]);
+        }
+        if (len > 0) {
+            cb_write_multi(cb, buffer, len);
+        }
+        if (fit < DP1_SAMPLES_PER_WRITE) {
+            TRACE_INSTANT(TRACE_RING_FULL, (DP1_SAMPLES_PER_WRITE - fit) * REC_SAMPLE_SIZE);
+        }
+        TRACE_END(TRACE_WRITE, len);
+
+        unlock_buffer(cb, sem_id);
+        usleep(sleep_base_us);
     }
 
     return 0;
 }
 
+//==================================================FUNCTION========================|
+//Name:           dp1_generate_samples                                               |
+//Params:         uint64_t *values   Buffer to store generated samples               |
+//                int count          Number of samples to generate                   |
+//Returns:        NONE                                                              |
+//Outputs:        Fills values with synthetic latencies                              |
+//Description:    Generates latency-like values in microseconds: mostly a few       |
+//                hundred, with a long tail reaching into the seconds.               |
+//==================================================================================|
+void dp1_generate_samples(uint64_t *values, int count) {
+    int i;
+
+    for (i = 0; i < count; i++) {
+        values[i] = (uint64_t)(100 + rand() % 900) << (rand() % 8 == 0 ? rand() % 12 : 0);
+    }
+}
+
 //==================================================FUNCTION========================|
 //Name:           dp1_generate_letters                                               |
 //Params:         char *buffer       Buffer to store generated characters            |
@@ -101,15 +459,10 @@ int dp1_process(void) {
 //Returns:        NONE                                                              |
 //Outputs:        Fills buffer with characters                                       |
 //Description:    Generates 'count' random uppercase characters from CHAR_START to   |
-//                CHAR_END and stores them in buffer.                                |
+//                CHAR_END, following the configured distribution (HISTO_DIST).     |
 //==================================================================================|
 void dp1_generate_letters(char *buffer, int count) {
-    int i;
-    int range = CHAR_END - CHAR_START + 1;
-
-    for (i = 0; i < count; i++) {
-        buffer[i] = CHAR_START + (rand() % range);
-    }
+    gen_fill(&generator, buffer, count);
 }
 
 //==================================================FUNCTION========================|
@@ -122,15 +475,19 @@ void dp1_generate_letters(char *buffer, int count) {
 pid_t dp1_launch_dp2(int shm_id) {
     pid_t pid;
     char shm_id_str[20];
+    char path[PATH_MAX];
 
     snprintf(shm_id_str, sizeof(shm_id_str), "%d", shm_id);
+    if (instance_program(DP2_PROCESS, path, sizeof(path)) == -1) {
+        return -1;
+    }
 
     pid = fork();
     if (pid == -1) {
         perror("fork");
         return -1;
     } else if (pid == 0) {
-        execl(DP2_PROCESS, "dp2", shm_id_str, NULL);
+        execl(path, "dp2", shm_id_str, NULL);
         perror("execl");
         exit(EXIT_FAILURE);
     }
@@ -146,6 +503,8 @@ pid_t dp1_launch_dp2(int shm_id) {
 //Description:    Cleans up shared memory and semaphore if this is the last process. |
 //==================================================================================|
 void dp1_cleanup(void) {
+    trace_close();
+
     if (cb != NULL) {
         detach_shared_memory(cb);
         cb = NULL;
@@ -168,4 +527,11 @@ void dp1_cleanup(void) {
 //Name:           dp1_signal_handler                                                 |
 //Params:         int sig               Signal value (e.g., SIGINT)                  |
 //Returns:        NONE                                                              |
-//Outputs:        Sets run to
+//Outputs:        Sets run to 0                                                     |
+//Description:    Handles SIGINT by clearing the run flag so the main loop exits.   |
+//==================================================================================|
+void dp1_signal_handler(int sig) {
+    if (sig == SIGINT) {
+        run = 0;
+    }
+}
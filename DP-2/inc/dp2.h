@@ -10,11 +10,15 @@
 #include <signal.h>
 #include <sys/wait.h>
 #include <sys/types.h>
+#include <limits.h>
+#include "control.h"
 
 int dp2_init(int shm_id);
 int dp2_process(void);
 char dp2_generate_letter(void);
+void dp2_apply_control(void *ctx, const ControlCommand *command);
 pid_t dp2_launch_dc(int shm_id, pid_t dp1_pid);
+void dp2_cleanup(void);
 void dp2_signal_handler(int sig);
 
 #endif 
\ No newline at end of file
@@ -10,6 +10,9 @@
 #include "../../common/inc/constants.h"
 #include "../../common/inc/circular_buffer.h"
 #include "../../common/inc/ipc_utils.h"
+#include "../../common/inc/trace.h"
+#include "../../common/inc/generator.h"
+#include "../../common/inc/instance.h"
 #include "../inc/dp2.h"
 
 static CircularBuffer *cb = NULL;  
@@ -18,6 +21,12 @@ static int sem_id = -1;
 static pid_t dp1_pid = -1;        
 static pid_t dc_pid = -1;         
 static int run = 1;            
+static SymbolGenerator generator;
+static ArrivalPattern arrival;
+static int sleep_base_us = DP2_SLEEP_TIME;
+static int batch = DP2_BATCH_DEFAULT;
+static int overload = CTL_OVERLOAD_DROP;
+static uint32_t control_cursor = 0;
 
 //==================================================FUNCTION========================|
 //Name:           dp2_init                                                           |
@@ -28,11 +37,22 @@ static int run = 1;
 //                handling, and launching the DC process.                            |
 //==================================================================================|
 int dp2_init(int shm_id) {
+    key_t sem_key;
+    key_t shm_key;
+
     shm_id_g = shm_id;
     dp1_pid = getppid();
     srand(time(NULL) ^ getpid());
+    trace_init("DP-2");
+    if (gen_init_from_config(&generator, (uint64_t)(time(NULL) ^ getpid())) == -1) {
+        return -1;
+    }
+    arrival_init_from_config(&arrival);
 
-    sem_id = create_semaphore(SEM_KEY);
+    if (instance_keys(&sem_key, &shm_key) == -1) {
+        return -1;
+    }
+    sem_id = create_semaphore(sem_key);
     if (sem_id == -1) {
         return -1;
     }
@@ -43,9 +63,10 @@ int dp2_init(int shm_id) {
     }
 
     cb = (CircularBuffer *)attach_shared_memory(shm_id_g);
-    if (cb == NULL) {
+    if (cb == NULL || instance_check(cb, "DP-2") == -1) {
         return -1;
     }
+    control_cursor = ctl_cursor(&cb->control);
 
     if (setup_signal_handler(SIGINT, dp2_signal_handler) == -1) {
         return -1;
@@ -60,39 +81,107 @@ int dp2_init(int shm_id) {
 //Returns:        int                     0 on normal termination                    |
 //Outputs:        Writes letters to circular buffer                                 |
 //Description:    Generates letters and writes them to the circular buffer          |
-//                until the SIGINT signal is received.                              |
+//                until the SIGINT signal is received. The pause between writes     |
+//                follows the configured arrival pattern. Commands from histo-ctl   |
+//                are applied at the top of each pass.                              |
 //==================================================================================|
 int dp2_process(void) {
-    char letter;
+    char letters[DP2_MAX_BATCH];
+    int count;
+    int written;
+    int n;
+    int i;
+    int sleep_us;
+    int send;
 
     while (run) {
-        letter = dp2_generate_letter();
+        ctl_poll(&cb->control, &control_cursor, CTL_DP2, dp2_apply_control, NULL);
 
-        if (lock_semaphore(sem_id) == -1) {
+        sleep_us = arrival_next_sleep(&arrival, sleep_base_us, &send);
+        if (!send) {
+            usleep(sleep_us);
             continue;
         }
 
-        if (cb_get_free_space(cb) > 0) {
-            cb_write_char(cb, letter);
+        count = batch;
+        for (i = 0; i < count; i++) {
+            letters[i] = dp2_generate_letter();
+        }
+
+        written = 0;
+        while (run && written < count) {
+            if (lock_buffer(cb, sem_id) == -1) {
+                break;
+            }
+            TRACE_BEGIN(TRACE_WRITE);
+            n = cb_get_free_space(cb);
+            if (n > count - written) {
+                n = count - written;
+            }
+            if (n > 0) {
+                cb_write_multi(cb, letters + written, (size_t)n);
+                written += n;
+            }
+            if (written < count) {
+                TRACE_INSTANT(TRACE_RING_FULL, count - written);
+            }
+            TRACE_END(TRACE_WRITE, n);
+            unlock_buffer(cb, sem_id);
+
+            if (overload == CTL_OVERLOAD_DROP) {
+                break;
+            }
+            if (written < count) {
+                usleep(DP1_BLOCK_RETRY_US);
+            }
         }
 
-        unlock_semaphore(sem_id);
-        usleep(DP2_SLEEP_TIME);
+        usleep(sleep_us);
     }
 
     return 0;
 }
 
+//==================================================FUNCTION========================|
+//Name:           dp2_apply_control                                                  |
+//Params:         void* ctx               Unused.                                    |
+//                const ControlCommand* command  A command from histo-ctl.           |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    Applies a live setting. Out-of-range values are clamped.          |
+//==================================================================================|
+void dp2_apply_control(void *ctx, const ControlCommand *command) {
+    (void)ctx;
+    switch (command->op) {
+    case CTL_OP_SLEEP_US:
+        sleep_base_us = (command->value < 0) ? 0 : (command->value > INT_MAX) ? INT_MAX
+                                                                             : (int)command->value;
+        break;
+    case CTL_OP_BATCH:
+        batch = (command->value < 1) ? 1 : (command->value > DP2_MAX_BATCH) ? DP2_MAX_BATCH
+                                                                           : (int)command->value;
+        break;
+    case CTL_OP_OVERLOAD:
+        overload = (command->value == CTL_OVERLOAD_BLOCK) ? CTL_OVERLOAD_BLOCK : CTL_OVERLOAD_DROP;
+        break;
+    case CTL_OP_TRACE:
+        trace_set_enabled(command->value != 0);
+        break;
+    default:
+        break;
+    }
+}
+
 //==================================================FUNCTION========================|
 //Name:           dp2_generate_letter                                                |
 //Params:         NONE                                                              |
 //Returns:        char                    Random character in defined range          |
 //Outputs:        NONE                                                              |
 //Description:    Generates a single random character between CHAR_START and CHAR_END|
+//                following the configured distribution (HISTO_DIST).               |
 //==================================================================================|
 char dp2_generate_letter(void) {
-    int range = CHAR_END - CHAR_START + 1;
-    return CHAR_START + (rand() % range);
+    return gen_next(&generator);
 }
 
 //==================================================FUNCTION========================|
@@ -108,17 +197,21 @@ pid_t dp2_launch_dc(int shm_id, pid_t dp1_pid) {
     char shm_id_str[20];
     char dp1_pid_str[20];
     char dp2_pid_str[20];
+    char path[PATH_MAX];
 
     snprintf(shm_id_str, sizeof(shm_id_str), "%d", shm_id);
     snprintf(dp1_pid_str, sizeof(dp1_pid_str), "%d", dp1_pid);
     snprintf(dp2_pid_str, sizeof(dp2_pid_str), "%d", getpid());
+    if (instance_program(DC_PROCESS, path, sizeof(path)) == -1) {
+        return -1;
+    }
 
     pid = fork();
     if (pid == -1) {
         perror("fork");
         return -1;
     } else if (pid == 0) {
-        execl(DC_PROCESS, "dc", shm_id_str, dp1_pid_str, dp2_pid_str, NULL);
+        execl(path, "dc", shm_id_str, dp1_pid_str, dp2_pid_str, NULL);
         perror("execl");
         exit(EXIT_FAILURE);
     }
@@ -134,6 +227,8 @@ pid_t dp2_launch_dc(int shm_id, pid_t dp1_pid) {
 //Description:    Detaches the circular buffer from shared memory.                  |
 //==================================================================================|
 void dp2_cleanup(void) {
+    trace_close();
+
     if (cb != NULL) {
         detach_shared_memory(cb);
         cb = NULL;
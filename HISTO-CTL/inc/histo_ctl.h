@@ -0,0 +1,25 @@
+/*
+*	FILE:			histo_ctl.h
+*	ASSIGNMENT:	The "Histogram System"
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This header file defines the interface for histo-ctl, which posts
+*                 live setting changes to the control queue of a running pipeline.
+*/
+
+#ifndef HISTO_CTL_H
+#define HISTO_CTL_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "circular_buffer.h"
+
+CircularBuffer *hc_attach(int *sem_id);
+int hc_parse_target(const char *name);
+int hc_parse_value(int op, const char *text, int64_t *value);
+int hc_post(CircularBuffer *cb, int sem_id, uint32_t target, uint32_t op, int64_t value);
+void hc_print_status(const CircularBuffer *cb, FILE *out);
+void hc_usage(const char *prog);
+
+#endif /* HISTO_CTL_H */
@@ -0,0 +1,190 @@
+/*
+*	FILE:			histo_ctl_function.c
+*	ASSIGNMENT:	The "Histogram System"
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This file implements histo-ctl. It only attaches to an existing
+*					pipeline; it never creates the shared segment or semaphore.
+*/
+
+#include <errno.h>
+#include "../../common/inc/constants.h"
+#include "../../common/inc/ipc_utils.h"
+#include "../../common/inc/instance.h"
+#include "../../common/inc/control.h"
+#include "../inc/histo_ctl.h"
+
+static const struct {
+    const char *name;
+    int target;
+} targets[] = {
+    { "dp1", CTL_DP1 },
+    { "dp2", CTL_DP2 },
+    { "dc", CTL_DC },
+    { "producers", CTL_PRODUCERS },
+    { "all", CTL_ALL },
+};
+
+//==================================================FUNCTION========================|
+//Name:           hc_attach                                                          |
+//Params:         int* sem_id             Receives the pipeline's semaphore.         |
+//Returns:        CircularBuffer*         The shared segment, or NULL if no          |
+//                                        pipeline is running                        |
+//Outputs:        Prints an error when the pipeline is not found                    |
+//Description:    Attaches to the running pipeline's segment and semaphore.         |
+//==================================================================================|
+CircularBuffer *hc_attach(int *sem_id) {
+    CircularBuffer *cb;
+    key_t sem_key;
+    key_t shm_key;
+    int shm_id;
+
+    if (instance_keys(&sem_key, &shm_key) == -1) {
+        return NULL;
+    }
+    shm_id = shmget(shm_key, sizeof(CircularBuffer), 0);
+    *sem_id = semget(sem_key, 1, 0);
+    if (shm_id == -1 || *sem_id == -1) {
+        fprintf(stderr, "histo-ctl: no running pipeline (%s)\n", strerror(errno));
+        return NULL;
+    }
+
+    cb = (CircularBuffer *)attach_shared_memory(shm_id);
+    if (cb != NULL && instance_check(cb, "histo-ctl") == -1) {
+        detach_shared_memory(cb);
+        return NULL;
+    }
+    return cb;
+}
+
+//==================================================FUNCTION========================|
+//Name:           hc_parse_target                                                    |
+//Params:         const char* name        dp1, dp2, dc, producers or all.            |
+//Returns:        int                     The CTL_* mask, or -1 if unknown.          |
+//Outputs:        NONE                                                              |
+//Description:    Maps a target name to the processes it addresses.                 |
+//==================================================================================|
+int hc_parse_target(const char *name) {
+    size_t i;
+
+    for (i = 0; i < sizeof(targets) / sizeof(targets[0]); i++) {
+        if (strcmp(targets[i].name, name) == 0) {
+            return targets[i].target;
+        }
+    }
+
+    return -1;
+}
+
+//==================================================FUNCTION========================|
+//Name:           hc_parse_value                                                     |
+//Params:         int op                  The setting being changed.                 |
+//                const char* text        The value as typed.                        |
+//                int64_t* value          Receives the parsed value.                 |
+//Returns:        int                     0 on success, -1 if invalid                |
+//Outputs:        NONE                                                              |
+//Description:    Accepts drop/block for overload, on/off for trace, and a          |
+//                non-negative integer otherwise.                                    |
+//==================================================================================|
+int hc_parse_value(int op, const char *text, int64_t *value) {
+    char *end;
+    long long number;
+
+    if (op == CTL_OP_OVERLOAD && strcmp(text, "drop") == 0) {
+        *value = CTL_OVERLOAD_DROP;
+        return 0;
+    }
+    if (op == CTL_OP_OVERLOAD && strcmp(text, "block") == 0) {
+        *value = CTL_OVERLOAD_BLOCK;
+        return 0;
+    }
+    if (op == CTL_OP_TRACE && (strcmp(text, "on") == 0 || strcmp(text, "off") == 0)) {
+        *value = (strcmp(text, "on") == 0);
+        return 0;
+    }
+    if (op == CTL_OP_OVERLOAD) {
+        return -1;
+    }
+
+    errno = 0;
+    number = strtoll(text, &end, 10);
+    if (errno != 0 || *end != '\0' || end == text || number < 0) {
+        return -1;
+    }
+    *value = number;
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           hc_post                                                            |
+//Params:         CircularBuffer* cb      The shared segment.                        |
+//                int sem_id              The pipeline's semaphore.                  |
+//                uint32_t target         CTL_* mask.                                |
+//                uint32_t op             The setting.                               |
+//                int64_t value           The new value.                             |
+//Returns:        int                     0 on success, -1 on failure                |
+//Outputs:        NONE                                                              |
+//Description:    Posts the command under the semaphore, which serialises posters. |
+//==================================================================================|
+int hc_post(CircularBuffer *cb, int sem_id, uint32_t target, uint32_t op, int64_t value) {
+    int result;
+
+    if (lock_buffer(cb, sem_id) == -1) {
+        return -1;
+    }
+    result = ctl_post(&cb->control, target, op, value);
+    unlock_buffer(cb, sem_id);
+
+    return result;
+}
+
+//==================================================FUNCTION========================|
+//Name:           hc_print_status                                                    |
+//Params:         const CircularBuffer* cb  The shared segment.                      |
+//                FILE* out               Stream to print to.                        |
+//Returns:        NONE                                                              |
+//Outputs:        Prints the ring fill and the commands still in the queue          |
+//Description:    Shows what has been posted, newest last.                          |
+//==================================================================================|
+void hc_print_status(const CircularBuffer *cb, FILE *out) {
+    const ControlCommand *command;
+    uint32_t seq = ctl_cursor(&cb->control);
+    uint32_t i = (seq > CTL_QUEUE_SIZE) ? seq - CTL_QUEUE_SIZE : 0;
+    size_t t;
+
+    fprintf(out, "ring_used=%d\n", cb_get_available(cb));
+    fprintf(out, "commands=%u\n", seq);
+    for (; i < seq; i++) {
+        command = &cb->control.commands[i % CTL_QUEUE_SIZE];
+        fprintf(out, "#%u ", i);
+        for (t = 0; t < sizeof(targets) / sizeof(targets[0]); t++) {
+            if (targets[t].target == (int)command->target) {
+                fprintf(out, "%s ", targets[t].name);
+                break;
+            }
+        }
+        fprintf(out, "%s %lld\n", ctl_op_name(command->op), (long long)command->value);
+    }
+}
+
+//==================================================FUNCTION========================|
+//Name:           hc_usage                                                           |
+//Params:         const char* prog        argv[0]                                    |
+//Returns:        NONE                                                              |
+//Outputs:        Prints the usage text to stderr                                   |
+//Description:    Lists the targets and settings.                                   |
+//==================================================================================|
+void hc_usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s <dp1|dp2|dc|producers|all> <setting> <value>\n"
+            "       %s status\n"
+            "Settings:\n"
+            "  sleep-us <us>          producers: base pause between writes\n"
+            "  batch <n>              producers: letters per write\n"
+            "  overload <drop|block>  producers: what to do when the ring is full\n"
+            "  trace <on|off>         all: event tracing (HISTO_TRACE_DIR)\n"
+            "  display-interval <n>   dc: drains between displays\n"
+            "  read-bytes <n>         dc: most bytes per drain\n"
+            "  read-interval <s>      dc: seconds between drains\n",
+            prog, prog);
+}
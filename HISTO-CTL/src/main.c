@@ -0,0 +1,53 @@
+/*
+*	FILE:			main.c
+*	ASSIGNMENT:	The "Histogram System"
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This is the entry point for histo-ctl.
+*/
+
+#include "../../common/inc/ipc_utils.h"
+#include "../inc/histo_ctl.h"
+
+int main(int argc, char *argv[]) {
+    CircularBuffer *cb;
+    int64_t value;
+    int sem_id;
+    int target;
+    int op;
+    int result;
+
+    if (argc == 2 && strcmp(argv[1], "status") == 0) {
+        cb = hc_attach(&sem_id);
+        if (cb == NULL) {
+            return EXIT_FAILURE;
+        }
+        hc_print_status(cb, stdout);
+        detach_shared_memory(cb);
+        return EXIT_SUCCESS;
+    }
+
+    if (argc != 4) {
+        hc_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    target = hc_parse_target(argv[1]);
+    op = ctl_op_from_name(argv[2]);
+    if (target == -1 || op == -1 || hc_parse_value(op, argv[3], &value) == -1) {
+        hc_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if ((ctl_op_targets((uint32_t)op) & (uint32_t)target) == 0) {
+        fprintf(stderr, "%s: %s is not a setting of %s\n", argv[0], argv[2], argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    cb = hc_attach(&sem_id);
+    if (cb == NULL) {
+        return EXIT_FAILURE;
+    }
+    result = hc_post(cb, sem_id, (uint32_t)target, (uint32_t)op, value);
+    detach_shared_memory(cb);
+
+    return (result == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,26 @@
+/*
+*	FILE:			histo_list.h
+*	ASSIGNMENT:	The "Histogram System"
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This header file defines the interface for histo-list, which lists
+*                 the pipeline instances on this host from their shared segments.
+*/
+
+#ifndef HISTO_LIST_H
+#define HISTO_LIST_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "circular_buffer.h"
+
+#define HLI_SHM_TABLE "/proc/sysvipc/shm"
+
+int hli_scan(FILE *out);
+void hli_print_header(FILE *out);
+void hli_print(FILE *out, key_t key, int shm_id, pid_t creator, unsigned long attached,
+               const CircularBuffer *cb);
+void hli_usage(const char *prog);
+
+#endif /* HISTO_LIST_H */
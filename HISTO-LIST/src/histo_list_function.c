@@ -0,0 +1,141 @@
+/*
+*	FILE:			histo_list_function.c
+*	ASSIGNMENT:	The "Histogram System"
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This file implements histo-list. It walks the System V shared
+*					memory table, attaches read-only every segment the size of a
+*					CircularBuffer, and prints the ones DP-1 set up, with the instance
+*					name DP-1 wrote into them and DC's latest live counts.
+*/
+
+#include <time.h>
+#include "../../common/inc/constants.h"
+#include "../../common/inc/live.h"
+#include "../inc/histo_list.h"
+
+//==================================================FUNCTION========================|
+//Name:           hli_scan                                                           |
+//Params:         FILE* out               Where to print the list.                   |
+//Returns:        int                     Number of instances found, or -1 if the    |
+//                                        shared memory table cannot be read.        |
+//Outputs:        Prints the header and one line per instance                       |
+//Description:    Reads HLI_SHM_TABLE. Segments this user may not attach are        |
+//                skipped.                                                          |
+//==================================================================================|
+int hli_scan(FILE *out) {
+    FILE *table;
+    char line[512];
+    CircularBuffer *cb;
+    long key;
+    int shm_id;
+    unsigned int perms;
+    unsigned long size;
+    int creator;
+    int last;
+    unsigned long attached;
+    int found = 0;
+
+    table = fopen(HLI_SHM_TABLE, "r");
+    if (table == NULL) {
+        perror(HLI_SHM_TABLE);
+        return -1;
+    }
+
+    hli_print_header(out);
+    if (fgets(line, sizeof(line), table) == NULL) {
+        fclose(table);
+        return 0;
+    }
+    while (fgets(line, sizeof(line), table) != NULL) {
+        if (sscanf(line, "%ld %d %o %lu %d %d %lu", &key, &shm_id, &perms, &size, &creator,
+                   &last, &attached) != 7) {
+            continue;
+        }
+        if (key == IPC_PRIVATE || size != sizeof(CircularBuffer)) {
+            continue;
+        }
+
+        cb = (CircularBuffer *)shmat(shm_id, NULL, SHM_RDONLY);
+        if (cb == (void *)-1) {
+            continue;
+        }
+        if (cb->magic == CB_MAGIC) {
+            hli_print(out, (key_t)key, shm_id, (pid_t)creator, attached, cb);
+            found++;
+        }
+        shmdt(cb);
+    }
+
+    fclose(table);
+    return found;
+}
+
+//==================================================FUNCTION========================|
+//Name:           hli_print_header                                                   |
+//Params:         FILE* out               Where to print it.                         |
+//Returns:        NONE                                                              |
+//Outputs:        Prints the column names                                           |
+//Description:    Prints the header for the lines hli_print prints.                 |
+//==================================================================================|
+void hli_print_header(FILE *out) {
+    fprintf(out, "%-31s %-10s %8s %8s %8s %8s %10s %12s %8s %9s %s\n", "instance", "key",
+            "shmid", "creator", "attached", "buffered", "drains", "total", "age_ms", "recovered",
+            "state");
+}
+
+//==================================================FUNCTION========================|
+//Name:           hli_print                                                          |
+//Params:         FILE* out               Where to print it.                         |
+//                key_t key               The segment's key.                         |
+//                int shm_id              The segment's id.                          |
+//                pid_t creator           The process that created it, usually DP-1. |
+//                unsigned long attached  Processes attached before histo-list.      |
+//                const CircularBuffer* cb  The segment, attached read-only.         |
+//Returns:        NONE                                                              |
+//Outputs:        Prints one line                                                   |
+//Description:    Prints one instance. A segment nobody is attached to is "stale":  |
+//                its pipeline died without removing it, and the next DP-1 of that  |
+//                instance takes it over. buffered is read without the semaphore    |
+//                and may be a moment old. recovered counts the times a process     |
+//                died holding the buffer lock and the next one repaired the ring.  |
+//==================================================================================|
+void hli_print(FILE *out, key_t key, int shm_id, pid_t creator, unsigned long attached,
+               const CircularBuffer *cb) {
+    LiveHistogram snapshot;
+    struct timespec now;
+    uint64_t now_us;
+    char age[24] = "-";
+    char drains[24] = "-";
+    char total[24] = "-";
+
+    if (live_read(&cb->live, &snapshot) == 0 && snapshot.updated_us != 0) {
+        clock_gettime(CLOCK_REALTIME, &now);
+        now_us = (uint64_t)now.tv_sec * 1000000 + (uint64_t)now.tv_nsec / 1000;
+        snprintf(age, sizeof(age), "%llu",
+                 (unsigned long long)((now_us > snapshot.updated_us) ?
+                                      (now_us - snapshot.updated_us) / 1000 : 0));
+        snprintf(drains, sizeof(drains), "%llu", (unsigned long long)snapshot.drains);
+        snprintf(total, sizeof(total), "%llu", (unsigned long long)snapshot.total);
+    }
+
+    fprintf(out, "%-31.*s 0x%08x %8d %8d %8lu %8d %10s %12s %8s %9llu %s\n",
+            (int)sizeof(cb->instance), (cb->instance[0] != '\0') ? cb->instance : "(default)",
+            (unsigned int)key, shm_id, (int)creator, attached, cb_get_available(cb), drains,
+            total, age, (unsigned long long)cb->lock_recoveries,
+            (attached > 0) ? "running" : "stale");
+}
+
+//==================================================FUNCTION========================|
+//Name:           hli_usage                                                          |
+//Params:         const char* prog        The program name.                          |
+//Returns:        NONE                                                              |
+//Outputs:        Prints the usage to stderr                                        |
+//Description:    Prints how to run histo-list.                                     |
+//==================================================================================|
+void hli_usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s\n"
+            "  lists the pipeline instances on this host; start one with\n"
+            "  HISTO_INSTANCE=<name> DP-1/bin/dp1\n",
+            prog);
+}
@@ -0,0 +1,17 @@
+/*
+*	FILE:			main.c
+*	ASSIGNMENT:	The "Histogram System"
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This is the entry point for histo-list.
+*/
+
+#include "../inc/histo_list.h"
+
+int main(int argc, char *argv[]) {
+    if (argc != 1) {
+        hli_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    return (hli_scan(stdout) == -1) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,22 @@
+/*
+*	FILE:			histo_live.h
+*	ASSIGNMENT:	The "Histogram System"
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This header file defines the interface for histo-live, which prints
+*                 snapshots of the live histogram DC publishes in the shared segment.
+*/
+
+#ifndef HISTO_LIVE_H
+#define HISTO_LIVE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "live.h"
+
+int hl_snapshot(const LiveHistogram *live, FILE *out);
+void hl_print(const LiveHistogram *snapshot, FILE *out);
+void hl_usage(const char *prog);
+
+#endif /* HISTO_LIVE_H */
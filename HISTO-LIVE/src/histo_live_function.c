@@ -0,0 +1,77 @@
+/*
+*	FILE:			histo_live_function.c
+*	ASSIGNMENT:	The "Histogram System"
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This file implements histo-live. It only reads the shared segment,
+*					so it can poll as often as it likes without slowing the pipeline.
+*/
+
+#include <time.h>
+#include "../inc/histo_live.h"
+
+//==================================================FUNCTION========================|
+//Name:           hl_snapshot                                                        |
+//Params:         const LiveHistogram* live  The shared live histogram.              |
+//                FILE* out               Where to print the snapshot.               |
+//Returns:        int                     0 on success, -1 if no consistent copy     |
+//                                        could be taken.                            |
+//Outputs:        Prints one snapshot                                               |
+//Description:    This function takes a snapshot and prints it.                      |
+//==================================================================================|
+int hl_snapshot(const LiveHistogram *live, FILE *out) {
+    LiveHistogram snapshot;
+
+    if (live_read(live, &snapshot) == -1) {
+        fprintf(stderr, "histo-live: DC kept the histogram busy, no snapshot taken\n");
+        return -1;
+    }
+
+    hl_print(&snapshot, out);
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           hl_print                                                           |
+//Params:         const LiveHistogram* snapshot  A copy from live_read.              |
+//                FILE* out               Where to print it.                         |
+//Returns:        NONE                                                              |
+//Outputs:        Prints a header line, then one "key count" line per bin           |
+//Description:    This function prints a snapshot. age_ms is the time since DC last  |
+//                published, which tells a stalled DC from a quiet pipeline.         |
+//==================================================================================|
+void hl_print(const LiveHistogram *snapshot, FILE *out) {
+    struct timespec now;
+    uint64_t now_us;
+    uint64_t age_ms = 0;
+    uint32_t i;
+
+    clock_gettime(CLOCK_REALTIME, &now);
+    now_us = (uint64_t)now.tv_sec * 1000000 + (uint64_t)now.tv_nsec / 1000;
+    if (snapshot->updated_us != 0 && now_us > snapshot->updated_us) {
+        age_ms = (now_us - snapshot->updated_us) / 1000;
+    }
+
+    fprintf(out, "seq=%u drains=%llu age_ms=%llu total=%llu\n", snapshot->seq,
+            (unsigned long long)snapshot->drains, (unsigned long long)age_ms,
+            (unsigned long long)snapshot->total);
+    for (i = 0; i < snapshot->bin_count; i++) {
+        fprintf(out, "%c %llu\n", snapshot->first_key + (int)i,
+                (unsigned long long)snapshot->counts[i]);
+    }
+    fflush(out);
+}
+
+//==================================================FUNCTION========================|
+//Name:           hl_usage                                                           |
+//Params:         const char* prog        The program name.                          |
+//Returns:        NONE                                                              |
+//Outputs:        Prints the usage to stderr                                        |
+//Description:    This function prints how to run histo-live.                        |
+//==================================================================================|
+void hl_usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [-i interval_ms] [-n count]\n"
+            "  -i  poll every interval_ms instead of printing once\n"
+            "  -n  stop after count snapshots (default 1, or forever with -i)\n",
+            prog);
+}
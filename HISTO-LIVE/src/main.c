@@ -0,0 +1,63 @@
+/*
+*	FILE:			main.c
+*	ASSIGNMENT:	The "Histogram System"
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This is the entry point for histo-live.
+*/
+
+#include <unistd.h>
+#include "../../common/inc/instance.h"
+#include "../inc/histo_live.h"
+
+int main(int argc, char *argv[]) {
+    const LiveHistogram *live;
+    key_t sem_key;
+    key_t shm_key;
+    int interval_ms = 0;
+    int count = -1;
+    int taken = 0;
+    int failed = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "i:n:")) != -1) {
+        switch (opt) {
+        case 'i':
+            interval_ms = atoi(optarg);
+            break;
+        case 'n':
+            count = atoi(optarg);
+            break;
+        default:
+            hl_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (optind != argc || interval_ms < 0) {
+        hl_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (count < 0) {
+        count = (interval_ms > 0) ? 0 : 1;
+    }
+
+    if (instance_keys(&sem_key, &shm_key) == -1) {
+        return EXIT_FAILURE;
+    }
+    live = live_attach(shm_key);
+    if (live == NULL) {
+        fprintf(stderr, "histo-live: no running pipeline\n");
+        return EXIT_FAILURE;
+    }
+
+    while (count == 0 || taken < count) {
+        if (taken > 0) {
+            putchar('\n');
+            usleep((useconds_t)interval_ms * 1000);
+        }
+        failed += (hl_snapshot(live, stdout) == -1);
+        taken++;
+    }
+    live_detach(live);
+
+    return (failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
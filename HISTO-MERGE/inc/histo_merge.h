@@ -0,0 +1,30 @@
+/*
+*	FILE:			histo_merge.h
+*	ASSIGNMENT:	The "Histogram System"
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This header file defines the interface for histo-merge, which sums
+*                 any number of binary histogram files written by DC into one.
+*/
+
+#ifndef HISTO_MERGE_H
+#define HISTO_MERGE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "../../common/inc/histo_file.h"
+
+typedef struct {
+    int count;
+    int capacity;
+    HfSection *sections;           /* owned bins, one entry per distinct section */
+} HmTotals;
+
+int hm_merge_file(HmTotals *totals, HfReadBuffer *rb, const char *path);
+void hm_add_section(void *ctx, const HfSection *section);
+int hm_write(const HmTotals *totals, const char *path);
+void hm_print(const HmTotals *totals, FILE *out);
+void hm_free(HmTotals *totals);
+
+#endif /* HISTO_MERGE_H */
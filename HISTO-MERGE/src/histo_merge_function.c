@@ -0,0 +1,147 @@
+/*
+*	FILE:			histo_merge_function.c
+*	ASSIGNMENT:	The "Histogram System"
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This file implements histo-merge. Input files are streamed one at a
+*                 time through a reused buffer and summed into one running total per
+*                 distinct section, so memory does not grow with the number of inputs.
+*/
+
+#include "../inc/histo_merge.h"
+
+//==================================================FUNCTION========================|
+//Name:           hm_add_section                                                     |
+//Params:         void* ctx               The HmTotals being accumulated.            |
+//                const HfSection* section  A section decoded from an input file.    |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function adds a section's bins to the matching running total, |
+//                creating the total the first time a section layout is seen. The    |
+//                origin section of a hand-off file holds no counts and is dropped.  |
+//==================================================================================|
+void hm_add_section(void *ctx, const HfSection *section) {
+    HmTotals *totals = ctx;
+    HfSection *target = NULL;
+    HfSection *grown;
+    int i;
+
+    if (section->type == HF_SECTION_ORIGIN) {
+        return;
+    }
+
+    for (i = 0; i < totals->count; i++) {
+        if (totals->sections[i].type == section->type &&
+            totals->sections[i].channel == section->channel &&
+            totals->sections[i].first_key == section->first_key &&
+            totals->sections[i].bin_count == section->bin_count) {
+            target = &totals->sections[i];
+            break;
+        }
+    }
+
+    if (target == NULL) {
+        if (totals->count == totals->capacity) {
+            totals->capacity = totals->capacity ? totals->capacity * 2 : 8;
+            grown = realloc(totals->sections, (size_t)totals->capacity * sizeof(HfSection));
+            if (grown == NULL) {
+                perror("realloc");
+                exit(EXIT_FAILURE);
+            }
+            totals->sections = grown;
+        }
+        target = &totals->sections[totals->count++];
+        *target = *section;
+        target->bins = calloc((size_t)section->bin_count, sizeof(uint64_t));
+        if (target->bins == NULL) {
+            perror("calloc");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    for (i = 0; i < section->bin_count; i++) {
+        target->bins[i] += section->bins[i];
+    }
+}
+
+//==================================================FUNCTION========================|
+//Name:           hm_merge_file                                                      |
+//Params:         HmTotals* totals        Running totals.                            |
+//                HfReadBuffer* rb        Read buffers reused across files.          |
+//                const char* path        Input file.                                |
+//Returns:        int                     Returns 0 on success, -1 on failure.       |
+//Outputs:        Prints a warning for unreadable or corrupt files                  |
+//Description:    This function folds one input file into the totals.                |
+//==================================================================================|
+int hm_merge_file(HmTotals *totals, HfReadBuffer *rb, const char *path) {
+    if (hf_read_file(path, rb, hm_add_section, totals) == -1) {
+        fprintf(stderr, "histo-merge: skipping unreadable or corrupt file %s\n", path);
+        return -1;
+    }
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           hm_write                                                           |
+//Params:         const HmTotals* totals  The merged histogram.                      |
+//                const char* path        Output file.                               |
+//Returns:        int                     Returns 0 on success, -1 on failure.       |
+//Outputs:        Writes 'path'                                                     |
+//Description:    This function writes the totals in the same binary format, so      |
+//                merged files can themselves be merged again.                       |
+//==================================================================================|
+int hm_write(const HmTotals *totals, const char *path) {
+    return hf_write_file(path, totals->sections, totals->count);
+}
+
+//==================================================FUNCTION========================|
+//Name:           hm_print                                                           |
+//Params:         const HmTotals* totals  The merged histogram.                      |
+//                FILE* out               Stream to print to.                        |
+//Returns:        NONE                                                              |
+//Outputs:        Prints "channel key count" lines; per-channel sections are         |
+//                printed as "c<channel> key count"                                  |
+//Description:    This function prints every non-empty bin as text.                  |
+//==================================================================================|
+void hm_print(const HmTotals *totals, FILE *out) {
+    const HfSection *s;
+    int i, j;
+
+    for (i = 0; i < totals->count; i++) {
+        s = &totals->sections[i];
+        for (j = 0; j < s->bin_count; j++) {
+            if (s->bins[j] == 0) {
+                continue;
+            }
+            if (s->type == HF_SECTION_SYMBOLS && s->first_key + j >= 0x20 &&
+                s->first_key + j < 0x7f) {
+                fprintf(out, "%d %c %llu\n", s->channel, s->first_key + j,
+                        (unsigned long long)s->bins[j]);
+            } else if (s->type == HF_SECTION_CHANNEL && s->first_key + j >= 0x20 &&
+                       s->first_key + j < 0x7f) {
+                fprintf(out, "c%d %c %llu\n", s->channel, s->first_key + j,
+                        (unsigned long long)s->bins[j]);
+            } else {
+                fprintf(out, "%d %d %llu\n", s->channel, s->first_key + j,
+                        (unsigned long long)s->bins[j]);
+            }
+        }
+    }
+}
+
+//==================================================FUNCTION========================|
+//Name:           hm_free                                                            |
+//Params:         HmTotals* totals        Totals to release.                         |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function frees the running totals.                            |
+//==================================================================================|
+void hm_free(HmTotals *totals) {
+    int i;
+
+    for (i = 0; i < totals->count; i++) {
+        free(totals->sections[i].bins);
+    }
+    free(totals->sections);
+    memset(totals, 0, sizeof(*totals));
+}
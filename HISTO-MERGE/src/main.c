@@ -0,0 +1,56 @@
+/*
+*	FILE:			main.c
+*	ASSIGNMENT:	The "Histogram System"
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This is the entry point for histo-merge. Input files are taken from
+*					the command line, or one path per line from stdin when none are
+*					given (for fleets too large for an argument list).
+*/
+
+#include "../inc/histo_merge.h"
+
+int main(int argc, char *argv[]) {
+    HmTotals totals = {0};
+    HfReadBuffer rb = {0};
+    const char *out_path = NULL;
+    char line[4096];
+    size_t len;
+    int failed = 0;
+    int first = 1;
+    int i;
+
+    if (argc >= 3 && strcmp(argv[1], "-o") == 0) {
+        out_path = argv[2];
+        first = 3;
+    } else if (argc >= 2 && (strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "-o") == 0)) {
+        fprintf(stderr, "Usage: %s [-o merged.hst] [file.hst ...]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (first < argc) {
+        for (i = first; i < argc; i++) {
+            failed += (hm_merge_file(&totals, &rb, argv[i]) == -1);
+        }
+    } else {
+        while (fgets(line, sizeof(line), stdin) != NULL) {
+            len = strcspn(line, "\r\n");
+            line[len] = '\0';
+            if (len > 0) {
+                failed += (hm_merge_file(&totals, &rb, line) == -1);
+            }
+        }
+    }
+    hf_read_buffer_free(&rb);
+
+    if (out_path != NULL) {
+        if (hm_write(&totals, out_path) == -1) {
+            hm_free(&totals);
+            return EXIT_FAILURE;
+        }
+    } else {
+        hm_print(&totals, stdout);
+    }
+    hm_free(&totals);
+
+    return (failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
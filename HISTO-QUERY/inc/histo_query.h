@@ -0,0 +1,23 @@
+/*
+*	FILE:			histo_query.h
+*	ASSIGNMENT:	The "Histogram System"
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This header file defines the interface for histo-query, which sums
+*                 the interval history DC keeps (see tseries.h) over a time range.
+*/
+
+#ifndef HISTO_QUERY_H
+#define HISTO_QUERY_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include "tseries.h"
+
+int hq_parse_time(const char *text, time_t now, uint64_t *out);
+int hq_run(const char *prefix, uint64_t from_s, uint64_t to_s, FILE *out);
+void hq_usage(const char *prog);
+
+#endif /* HISTO_QUERY_H */
@@ -0,0 +1,142 @@
+/*
+*	FILE:			histo_query_function.c
+*	ASSIGNMENT:	The "Histogram System"
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This file implements histo-query: it parses the range, sums it
+*					with ts_sum and prints the counts with how much was read.
+*/
+
+#define _XOPEN_SOURCE 700
+#include "../inc/histo_query.h"
+
+//==================================================FUNCTION========================|
+//Name:           hq_parse_time                                                      |
+//Params:         const char* text        "now", "now-<n>[smhd]",                    |
+//                                        "@<seconds since the epoch>",              |
+//                                        "YYYY-MM-DD" or "YYYY-MM-DDTHH:MM[:SS]"    |
+//                                        in local time.                             |
+//                time_t now              The time "now" stands for.                 |
+//                uint64_t* out           Receives seconds since the epoch.          |
+//Returns:        int                     0 on success, -1 if 'text' is not a time.  |
+//Outputs:        NONE                                                              |
+//Description:    Parses one end of the range.                                      |
+//==================================================================================|
+int hq_parse_time(const char *text, time_t now, uint64_t *out) {
+    static const char *formats[] = { "%Y-%m-%dT%H:%M:%S", "%Y-%m-%dT%H:%M", "%Y-%m-%d" };
+    struct tm tm;
+    const char *end;
+    char *stop;
+    long long value;
+    long long unit = 1;
+    size_t i;
+    time_t t;
+
+    if (strcmp(text, "now") == 0) {
+        *out = (uint64_t)now;
+        return 0;
+    }
+    if (strncmp(text, "now-", 4) == 0) {
+        text += 3;
+    }
+    if (text[0] == '@' || text[0] == '-') {
+        value = strtoll(text + 1, &stop, 10);
+        if (stop == text + 1 || value < 0) {
+            return -1;
+        }
+        if (text[0] == '@') {
+            if (*stop != '\0') {
+                return -1;
+            }
+            *out = (uint64_t)value;
+            return 0;
+        }
+        switch (*stop) {
+        case 'd': unit = 86400; stop++; break;
+        case 'h': unit = 3600; stop++; break;
+        case 'm': unit = 60; stop++; break;
+        case 's': stop++; break;
+        default: break;
+        }
+        if (*stop != '\0' || value * unit > (long long)now) {
+            return -1;
+        }
+        *out = (uint64_t)(now - value * unit);
+        return 0;
+    }
+
+    for (i = 0; i < sizeof(formats) / sizeof(formats[0]); i++) {
+        memset(&tm, 0, sizeof(tm));
+        end = strptime(text, formats[i], &tm);
+        if (end != NULL && *end == '\0') {
+            tm.tm_isdst = -1;
+            t = mktime(&tm);
+            if (t == (time_t)-1) {
+                return -1;
+            }
+            *out = (uint64_t)t;
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+//==================================================FUNCTION========================|
+//Name:           hq_run                                                             |
+//Params:         const char* prefix      The series prefix (HISTO_HISTORY_PATH).    |
+//                uint64_t from_s         Start of the range.                        |
+//                uint64_t to_s           End of the range, exclusive.               |
+//                FILE* out               Where to print the result.                 |
+//Returns:        int                     0 on success, -1 on failure.               |
+//Outputs:        Prints a header line, then one "key count" line per key seen      |
+//Description:    Sums the range and prints it. records and segments tell how much  |
+//                of the series the query had to read.                              |
+//==================================================================================|
+int hq_run(const char *prefix, uint64_t from_s, uint64_t to_s, FILE *out) {
+    uint64_t counts[256];
+    uint64_t total = 0;
+    TsStats stats;
+    int key;
+
+    if (ts_sum(prefix, from_s, to_s, counts, &stats) == -1) {
+        fprintf(stderr, "histo-query: cannot read the series at %s\n", prefix);
+        return -1;
+    }
+
+    for (key = 0; key < 256; key++) {
+        total += counts[key];
+    }
+    fprintf(out, "from=%llu to=%llu records=%llu segments=%llu total=%llu\n",
+            (unsigned long long)from_s, (unsigned long long)to_s,
+            (unsigned long long)stats.records, (unsigned long long)stats.segments,
+            (unsigned long long)total);
+    for (key = 0; key < 256; key++) {
+        if (counts[key] == 0) {
+            continue;
+        }
+        if (key >= 0x20 && key < 0x7f) {
+            fprintf(out, "%c %llu\n", key, (unsigned long long)counts[key]);
+        } else {
+            fprintf(out, "0x%02x %llu\n", key, (unsigned long long)counts[key]);
+        }
+    }
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           hq_usage                                                           |
+//Params:         const char* prog        The program name.                          |
+//Returns:        NONE                                                              |
+//Outputs:        Prints the usage to stderr                                        |
+//Description:    Prints how to run histo-query.                                    |
+//==================================================================================|
+void hq_usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [-p prefix] from [to]\n"
+            "  sums DC's interval history over [from, to); to defaults to now\n"
+            "  -p  series prefix (default HISTO_HISTORY_PATH)\n"
+            "  times: now, now-<n>[smhd], @<epoch seconds>, YYYY-MM-DD or\n"
+            "         YYYY-MM-DDTHH:MM[:SS] in local time\n",
+            prog);
+}
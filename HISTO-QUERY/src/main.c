@@ -0,0 +1,41 @@
+/*
+*	FILE:			main.c
+*	ASSIGNMENT:	The "Histogram System"
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This is the entry point for histo-query.
+*/
+
+#include <unistd.h>
+#include "../../common/inc/config.h"
+#include "../inc/histo_query.h"
+
+int main(int argc, char *argv[]) {
+    const char *prefix;
+    uint64_t from_s;
+    uint64_t to_s;
+    time_t now;
+    int opt;
+
+    prefix = config_get_str("HISTO_HISTORY_PATH", NULL);
+    while ((opt = getopt(argc, argv, "p:")) != -1) {
+        switch (opt) {
+        case 'p':
+            prefix = optarg;
+            break;
+        default:
+            hq_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    now = time(NULL);
+    if (prefix == NULL || argc - optind < 1 || argc - optind > 2 ||
+        hq_parse_time(argv[optind], now, &from_s) == -1 ||
+        hq_parse_time((argc - optind == 2) ? argv[optind + 1] : "now", now, &to_s) == -1 ||
+        from_s >= to_s) {
+        hq_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    return (hq_run(prefix, from_s, to_s, stdout) == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,26 @@
+/*
+*	FILE:			histo_tap.h
+*	ASSIGNMENT:	The "Histogram System"
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This header file defines the interface for histo-tap, an extra
+*                 consumer that copies the full stream DC sees to stdout without
+*                 taking it away from DC.
+*/
+
+#ifndef HISTO_TAP_H
+#define HISTO_TAP_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "circular_buffer.h"
+
+CircularBuffer *ht_attach(int *sem_id);
+int ht_register(CircularBuffer *cb, int sem_id, int policy);
+int ht_run(CircularBuffer *cb, int sem_id, int slot, int interval_ms, FILE *out);
+void ht_release(CircularBuffer *cb, int sem_id, int slot);
+void ht_signal_handler(int sig);
+void ht_usage(const char *prog);
+
+#endif /* HISTO_TAP_H */
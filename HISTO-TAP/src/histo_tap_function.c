@@ -0,0 +1,163 @@
+/*
+*	FILE:			histo_tap_function.c
+*	ASSIGNMENT:	The "Histogram System"
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This file implements histo-tap. It registers a consumer slot in the
+*					circular buffer and drains it on its own cursor, so DC and any
+*					other consumer keep receiving every byte.
+*/
+
+#include "../../common/inc/constants.h"
+#include "../../common/inc/ipc_utils.h"
+#include "../../common/inc/instance.h"
+#include "../inc/histo_tap.h"
+
+static volatile sig_atomic_t run = 1;
+
+//==================================================FUNCTION========================|
+//Name:           ht_attach                                                          |
+//Params:         int* sem_id             Receives the pipeline's semaphore.         |
+//Returns:        CircularBuffer*         The attached buffer, or NULL if no         |
+//                                        pipeline is running.                       |
+//Outputs:        NONE                                                              |
+//Description:    Attaches to an existing pipeline without creating anything.       |
+//==================================================================================|
+CircularBuffer *ht_attach(int *sem_id) {
+    CircularBuffer *cb;
+    key_t sem_key;
+    key_t shm_key;
+    int shm_id;
+
+    if (instance_keys(&sem_key, &shm_key) == -1) {
+        return NULL;
+    }
+    shm_id = shmget(shm_key, sizeof(CircularBuffer), 0);
+    *sem_id = semget(sem_key, 1, 0);
+    if (shm_id == -1 || *sem_id == -1) {
+        fprintf(stderr, "histo-tap: no running pipeline (%s)\n", strerror(errno));
+        return NULL;
+    }
+
+    cb = (CircularBuffer *)attach_shared_memory(shm_id);
+    if (cb != NULL && instance_check(cb, "histo-tap") == -1) {
+        detach_shared_memory(cb);
+        return NULL;
+    }
+    return cb;
+}
+
+//==================================================FUNCTION========================|
+//Name:           ht_register                                                        |
+//Params:         CircularBuffer* cb      The attached buffer.                       |
+//                int sem_id              The pipeline's semaphore.                  |
+//                int policy              CB_CONSUMER_GATE or CB_CONSUMER_DROP.      |
+//Returns:        int                     The consumer slot, or -1 on failure.       |
+//Outputs:        NONE                                                              |
+//Description:    Takes a consumer slot under the semaphore.                        |
+//==================================================================================|
+int ht_register(CircularBuffer *cb, int sem_id, int policy) {
+    int slot;
+
+    if (lock_buffer(cb, sem_id) == -1) {
+        return -1;
+    }
+    slot = cb_consumer_register(cb, policy, getpid());
+    unlock_buffer(cb, sem_id);
+
+    if (slot == -1) {
+        fprintf(stderr, "histo-tap: all %d consumer slots are taken\n", CB_MAX_CONSUMERS);
+    }
+    return slot;
+}
+
+//==================================================FUNCTION========================|
+//Name:           ht_run                                                             |
+//Params:         CircularBuffer* cb      The attached buffer.                       |
+//                int sem_id              The pipeline's semaphore.                  |
+//                int slot                The consumer slot.                         |
+//                int interval_ms         Pause between drains.                      |
+//                FILE* out               Where the stream is copied.                |
+//Returns:        int                     0 when stopped by SIGINT, -1 if the slot   |
+//                                        was dropped or 'out' failed.               |
+//Outputs:        Writes the stream to 'out'                                        |
+//Description:    Drains the slot until SIGINT. The bytes are copied as they are, record |
+//                tags included, and the total is printed to stderr at the end.     |
+//==================================================================================|
+int ht_run(CircularBuffer *cb, int sem_id, int slot, int interval_ms, FILE *out) {
+    char buffer[BUFFER_SIZE];
+    uint64_t total = 0;
+    int result = 0;
+    int n;
+
+    while (run) {
+        if (lock_buffer(cb, sem_id) == -1) {
+            result = -1;
+            break;
+        }
+        n = cb_consumer_read(cb, slot, buffer, sizeof(buffer));
+        unlock_buffer(cb, sem_id);
+
+        if (n == -1) {
+            fprintf(stderr, "histo-tap: dropped for falling behind the producers\n");
+            result = -1;
+            break;
+        }
+        if (n > 0 && (fwrite(buffer, 1, (size_t)n, out) != (size_t)n || fflush(out) != 0)) {
+            result = -1;
+            break;
+        }
+        total += (uint64_t)n;
+        if (n < (int)sizeof(buffer)) {
+            usleep((useconds_t)interval_ms * 1000);
+        }
+    }
+
+    fprintf(stderr, "bytes=%llu\n", (unsigned long long)total);
+    return result;
+}
+
+//==================================================FUNCTION========================|
+//Name:           ht_release                                                         |
+//Params:         CircularBuffer* cb      The attached buffer.                       |
+//                int sem_id              The pipeline's semaphore.                  |
+//                int slot                The consumer slot.                         |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    Gives the slot back, so a gating tap stops holding producers back. |
+//==================================================================================|
+void ht_release(CircularBuffer *cb, int sem_id, int slot) {
+    if (lock_buffer(cb, sem_id) == -1) {
+        return;
+    }
+    cb_consumer_release(cb, slot);
+    unlock_buffer(cb, sem_id);
+}
+
+//==================================================FUNCTION========================|
+//Name:           ht_signal_handler                                                  |
+//Params:         int sig               Signal value (e.g., SIGINT)                  |
+//Returns:        NONE                                                              |
+//Outputs:        Sets run to 0                                                     |
+//Description:    Handles SIGINT and SIGTERM by stopping the drain loop.            |
+//==================================================================================|
+void ht_signal_handler(int sig) {
+    if (sig == SIGINT || sig == SIGTERM) {
+        run = 0;
+    }
+}
+
+//==================================================FUNCTION========================|
+//Name:           ht_usage                                                           |
+//Params:         const char* prog        The program name.                          |
+//Returns:        NONE                                                              |
+//Outputs:        Prints the usage to stderr                                        |
+//Description:    Prints how to run histo-tap.                                      |
+//==================================================================================|
+void ht_usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [-p gate|drop] [-i interval_ms]\n"
+            "  -p  gate: producers wait for this tap (default)\n"
+            "      drop: the tap is dropped if it falls a buffer behind\n"
+            "  -i  pause between drains when the buffer is empty (default %d)\n",
+            prog, HT_INTERVAL_MS_DEFAULT);
+}
@@ -0,0 +1,67 @@
+/*
+*	FILE:			main.c
+*	ASSIGNMENT:	The "Histogram System"
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This is the entry point for histo-tap.
+*/
+
+#include "../../common/inc/constants.h"
+#include "../../common/inc/ipc_utils.h"
+#include "../inc/histo_tap.h"
+
+int main(int argc, char *argv[]) {
+    CircularBuffer *cb;
+    int policy = CB_CONSUMER_GATE;
+    int interval_ms = HT_INTERVAL_MS_DEFAULT;
+    int sem_id;
+    int slot;
+    int result;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "p:i:")) != -1) {
+        switch (opt) {
+        case 'p':
+            if (strcmp(optarg, "gate") == 0) {
+                policy = CB_CONSUMER_GATE;
+            } else if (strcmp(optarg, "drop") == 0) {
+                policy = CB_CONSUMER_DROP;
+            } else {
+                ht_usage(argv[0]);
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'i':
+            interval_ms = atoi(optarg);
+            break;
+        default:
+            ht_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (optind != argc || interval_ms < 0) {
+        ht_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (setup_signal_handler(SIGINT, ht_signal_handler) == -1 ||
+        setup_signal_handler(SIGTERM, ht_signal_handler) == -1) {
+        return EXIT_FAILURE;
+    }
+    signal(SIGPIPE, SIG_IGN);
+
+    cb = ht_attach(&sem_id);
+    if (cb == NULL) {
+        return EXIT_FAILURE;
+    }
+    slot = ht_register(cb, sem_id, policy);
+    if (slot == -1) {
+        detach_shared_memory(cb);
+        return EXIT_FAILURE;
+    }
+
+    result = ht_run(cb, sem_id, slot, interval_ms, stdout);
+    ht_release(cb, sem_id, slot);
+    detach_shared_memory(cb);
+
+    return (result == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,23 @@
+/*
+*	FILE:			ingest_load.h
+*	ASSIGNMENT:	The "Histogram System"
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This header file defines the interface for ingest-load, a local
+*                 load generator that drives the ingest producer for benchmarking.
+*/
+
+#ifndef INGEST_LOAD_H
+#define INGEST_LOAD_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+int load_connect(const char *path);
+uint64_t load_run_client(const char *path, int seconds, int chunk, int channel);
+int load_run(const char *path, int clients, int seconds, int chunk);
+
+#endif /* INGEST_LOAD_H */
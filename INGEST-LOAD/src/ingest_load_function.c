@@ -0,0 +1,186 @@
+/*
+*	FILE:			ingest_load_function.c
+*	ASSIGNMENT:	The "Histogram System"
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This file implements ingest-load. Each client is a forked process
+*					that sends random letters as fast as the ingest producer accepts
+*					them and reports its byte count to the parent through a pipe.
+*/
+
+#include <errno.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include "../../common/inc/constants.h"
+#include "../../common/inc/config.h"
+#include "../../common/inc/record.h"
+#include "../inc/ingest_load.h"
+
+//==================================================FUNCTION========================|
+//Name:           load_connect                                                       |
+//Params:         const char* path        Ingest socket path.                        |
+//Returns:        int                     Connected socket, or -1 on error           |
+//Outputs:        NONE                                                              |
+//Description:    Connects to the ingest producer's Unix domain socket.              |
+//==================================================================================|
+int load_connect(const char *path) {
+    struct sockaddr_un addr;
+    int fd;
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1) {
+        perror("socket");
+        return -1;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
+        perror("connect");
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+//==================================================FUNCTION========================|
+//Name:           load_run_client                                                    |
+//Params:         const char* path        Ingest socket path.                        |
+//                int seconds             How long to send for.                      |
+//                int chunk               Bytes per send call.                       |
+//                int channel             Channel to send spans on, or -1 for plain  |
+//                                        letters.                                   |
+//Returns:        uint64_t                Bytes accepted by the ingest producer      |
+//Outputs:        NONE                                                              |
+//Description:    Sends one pre-generated chunk of letters repeatedly. A blocking   |
+//                send is where the producer's back-pressure is felt. A short send  |
+//                resumes mid-chunk so channel spans stay intact.                    |
+//==================================================================================|
+uint64_t load_run_client(const char *path, int seconds, int chunk, int channel) {
+    char letters[REC_SPAN_MAX];
+    uint64_t sent = 0;
+    size_t offset = 0;
+    time_t end;
+    ssize_t n;
+    char *data;
+    int span;
+    int fd;
+    int i, j;
+
+    fd = load_connect(path);
+    if (fd == -1) {
+        return 0;
+    }
+
+    data = malloc((size_t)chunk);
+    if (data == NULL) {
+        close(fd);
+        return 0;
+    }
+    srand((unsigned int)(time(NULL) ^ getpid()));
+    if (channel < 0) {
+        for (i = 0; i < chunk; i++) {
+            data[i] = CHAR_START + (rand() % (CHAR_END - CHAR_START + 1));
+        }
+    } else {
+        /* Whole spans only; the tail that cannot hold one is not sent */
+        i = 0;
+        while (chunk - i > REC_CHANNEL_HEADER) {
+            span = chunk - i - REC_CHANNEL_HEADER;
+            if (span > REC_SPAN_MAX) {
+                span = REC_SPAN_MAX;
+            }
+            for (j = 0; j < span; j++) {
+                letters[j] = CHAR_START + (rand() % (CHAR_END - CHAR_START + 1));
+            }
+            i += rec_encode_span(data + i, channel, letters, span);
+        }
+        chunk = i;
+    }
+
+    end = time(NULL) + seconds;
+    while (chunk > 0 && time(NULL) < end) {
+        n = send(fd, data + offset, (size_t)chunk - offset, MSG_NOSIGNAL);
+        if (n == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        sent += (uint64_t)n;
+        offset = (offset + (size_t)n) % (size_t)chunk;
+    }
+
+    free(data);
+    close(fd);
+    return sent;
+}
+
+//==================================================FUNCTION========================|
+//Name:           load_run                                                           |
+//Params:         const char* path        Ingest socket path.                        |
+//                int clients             Number of concurrent clients.              |
+//                int seconds             Test duration.                             |
+//                int chunk               Bytes per send call.                       |
+//Returns:        int                     0 on success, -1 on failure                |
+//Outputs:        Prints per-run throughput                                         |
+//Description:    Forks the clients, collects their byte counts and prints the      |
+//                aggregate rate. With HISTO_LOAD_CHANNELS set, client i sends       |
+//                channel spans on channel i modulo that count.                      |
+//==================================================================================|
+int load_run(const char *path, int clients, int seconds, int chunk) {
+    struct timespec start, stop;
+    uint64_t total = 0;
+    uint64_t sent;
+    double elapsed;
+    int channels;
+    int fds[2];
+    pid_t pid;
+    int i;
+
+    channels = config_get_int("HISTO_LOAD_CHANNELS", 0);
+    if (channels > 0 && chunk <= REC_CHANNEL_HEADER) {
+        fprintf(stderr, "ingest-load: chunk must exceed %d bytes with channels\n",
+                REC_CHANNEL_HEADER);
+        return -1;
+    }
+
+    if (pipe(fds) == -1) {
+        perror("pipe");
+        return -1;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < clients; i++) {
+        pid = fork();
+        if (pid == -1) {
+            perror("fork");
+            break;
+        } else if (pid == 0) {
+            close(fds[0]);
+            sent = load_run_client(path, seconds, chunk, (channels > 0) ? i % channels : -1);
+            if (write(fds[1], &sent, sizeof(sent)) != sizeof(sent)) {
+                _exit(EXIT_FAILURE);
+            }
+            _exit(EXIT_SUCCESS);
+        }
+    }
+    close(fds[1]);
+
+    while (read(fds[0], &sent, sizeof(sent)) == sizeof(sent)) {
+        total += sent;
+    }
+    close(fds[0]);
+    while (wait(NULL) > 0) {
+    }
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+
+    elapsed = (double)(stop.tv_sec - start.tv_sec) + (double)(stop.tv_nsec - start.tv_nsec) / 1e9;
+    printf("clients=%d chunk=%d seconds=%.2f bytes=%llu rate=%.0f B/s\n", clients, chunk,
+           elapsed, (unsigned long long)total, elapsed > 0 ? (double)total / elapsed : 0.0);
+
+    return 0;
+}
@@ -0,0 +1,42 @@
+/*
+*	FILE:			main.c
+*	ASSIGNMENT:	The "Histogram System"
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This is the entry point for ingest-load.
+*/
+
+#include "../../common/inc/constants.h"
+#include "../../common/inc/config.h"
+#include "../../common/inc/instance.h"
+#include "../inc/ingest_load.h"
+
+int main(int argc, char *argv[]) {
+    char socket_default[108];
+    int clients = 4;
+    int seconds = 5;
+    int chunk = 4096;
+
+    if (argc > 4) {
+        fprintf(stderr, "Usage: %s [clients] [seconds] [chunk_bytes]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (argc > 1) {
+        clients = atoi(argv[1]);
+    }
+    if (argc > 2) {
+        seconds = atoi(argv[2]);
+    }
+    if (argc > 3) {
+        chunk = atoi(argv[3]);
+    }
+    if (clients <= 0 || seconds <= 0 || chunk <= 0) {
+        fprintf(stderr, "Usage: %s [clients] [seconds] [chunk_bytes]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    return (load_run(config_get_str("HISTO_INGEST_SOCKET",
+                                    instance_path(INGEST_SOCKET_DEFAULT, socket_default,
+                                                  sizeof(socket_default))),
+                     clients, seconds, chunk) == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,38 @@
+/*
+*	FILE:			ingest.h
+*	ASSIGNMENT:	The "Histogram System"
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This header file defines the interface for the ingest producer. It
+*                 accepts external clients on a Unix domain socket and writes what they
+*                 send into the shared circular buffer.
+*/
+
+#ifndef INGEST_H
+#define INGEST_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/types.h>
+
+typedef struct {
+    int fd;
+    int stalled;                   /* EPOLLIN disarmed until 'pending' holds no whole record */
+    int pending_start;
+    int pending_len;
+    char *pending;                 /* received bytes not yet in the ring; a partial
+                                      record is kept for the next recv */
+} IngestClient;
+
+int ingest_init(void);
+int ingest_process(void);
+int ingest_accept(void);
+int ingest_receive(IngestClient *client);
+int ingest_flush(IngestClient *client);
+void ingest_close_client(IngestClient *client);
+void ingest_cleanup(void);
+void ingest_signal_handler(int sig);
+
+#endif /* INGEST_H */
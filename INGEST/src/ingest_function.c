@@ -0,0 +1,386 @@
+/*
+*	FILE:			ingest_function.c
+*	ASSIGNMENT:	The "Histogram System"
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This file implements the ingest producer. Clients are multiplexed
+*					with epoll and read in large batches. Each batch is copied into
+*					the circular buffer under the semaphore in as few writes as
+*					possible. When the buffer is full the client's socket is no
+*					longer read, so the kernel socket buffer fills and the client
+*					blocks: memory per client is bounded by INGEST_RECV_SIZE.
+*/
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "../../common/inc/constants.h"
+#include "../../common/inc/circular_buffer.h"
+#include "../../common/inc/ipc_utils.h"
+#include "../../common/inc/config.h"
+#include "../../common/inc/record.h"
+#include "../../common/inc/trace.h"
+#include "../../common/inc/instance.h"
+#include "../inc/ingest.h"
+
+static CircularBuffer *cb = NULL;
+static int shm_id = -1;
+static int sem_id = -1;
+static int listen_fd = -1;
+static int epoll_fd = -1;
+static const char *socket_path = NULL;
+static IngestClient *clients[INGEST_MAX_CLIENTS];
+static int stalled_count = 0;
+static volatile sig_atomic_t run = 1;
+
+//==================================================FUNCTION========================|
+//Name:           ingest_init                                                        |
+//Params:         NONE                                                              |
+//Returns:        int                     0 on success, -1 on failure                |
+//Outputs:        NONE                                                              |
+//Description:    Attaches to the circular buffer and semaphore of the running      |
+//                pipeline, then binds the listening socket (HISTO_INGEST_SOCKET)   |
+//                and the epoll set. It never creates the segment or semaphore.     |
+//==================================================================================|
+int ingest_init(void) {
+    static char socket_default[sizeof(((struct sockaddr_un *)0)->sun_path)];
+    struct sockaddr_un addr;
+    struct epoll_event ev;
+    key_t sem_key;
+    key_t shm_key;
+
+    trace_init("ingest");
+    if (instance_keys(&sem_key, &shm_key) == -1) {
+        return -1;
+    }
+    shm_id = shmget(shm_key, sizeof(CircularBuffer), 0);
+    sem_id = semget(sem_key, 1, 0);
+    if (shm_id == -1 || sem_id == -1) {
+        fprintf(stderr, "ingest: no running pipeline (%s)\n", strerror(errno));
+        return -1;
+    }
+
+    cb = (CircularBuffer *)attach_shared_memory(shm_id);
+    if (cb == NULL) {
+        return -1;
+    }
+    if (cb->magic != CB_MAGIC) {
+        fprintf(stderr, "ingest: the pipeline has not finished starting\n");
+        return -1;
+    }
+    if (instance_check(cb, "ingest") == -1) {
+        return -1;
+    }
+
+    socket_path = config_get_str("HISTO_INGEST_SOCKET",
+                                 instance_path(INGEST_SOCKET_DEFAULT, socket_default,
+                                               sizeof(socket_default)));
+    if (strlen(socket_path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "ingest: socket path too long\n");
+        return -1;
+    }
+
+    listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (listen_fd == -1) {
+        perror("socket");
+        return -1;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, socket_path);
+    unlink(socket_path);
+    if (bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) == -1 ||
+        listen(listen_fd, SOMAXCONN) == -1) {
+        perror("bind/listen");
+        return -1;
+    }
+
+    epoll_fd = epoll_create1(0);
+    if (epoll_fd == -1) {
+        perror("epoll_create1");
+        return -1;
+    }
+
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &ev) == -1) {
+        perror("epoll_ctl");
+        return -1;
+    }
+
+    if (setup_signal_handler(SIGINT, ingest_signal_handler) == -1 ||
+        setup_signal_handler(SIGTERM, ingest_signal_handler) == -1) {
+        return -1;
+    }
+    signal(SIGPIPE, SIG_IGN);
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           ingest_process                                                     |
+//Params:         NONE                                                              |
+//Returns:        int                     0 when terminated cleanly, -1 if the      |
+//                                        shared buffer went away                   |
+//Outputs:        NONE                                                              |
+//Description:    Main loop. Waits for readable clients, and while any client is    |
+//                stalled on a full buffer, wakes every INGEST_RETRY_MS to retry.    |
+//==================================================================================|
+int ingest_process(void) {
+    struct epoll_event events[INGEST_MAX_EVENTS];
+    IngestClient *client;
+    int ready;
+    int i;
+
+    while (run) {
+        ready = epoll_wait(epoll_fd, events, INGEST_MAX_EVENTS,
+                           stalled_count > 0 ? INGEST_RETRY_MS : -1);
+        if (ready == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("epoll_wait");
+            return -1;
+        }
+
+        for (i = 0; i < ready; i++) {
+            client = events[i].data.ptr;
+            if (client == NULL) {
+                ingest_accept();
+            } else if (!(events[i].events & EPOLLIN)) {
+                ingest_close_client(client);
+            } else if (ingest_receive(client) == -1) {
+                return -1;
+            }
+        }
+
+        if (stalled_count == 0) {
+            continue;
+        }
+        for (i = 0; i < INGEST_MAX_CLIENTS; i++) {
+            if (clients[i] != NULL && clients[i]->stalled && ingest_flush(clients[i]) == -1) {
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           ingest_accept                                                      |
+//Params:         NONE                                                              |
+//Returns:        int                     Number of clients accepted                 |
+//Outputs:        NONE                                                              |
+//Description:    Accepts every pending connection and registers it with epoll.      |
+//==================================================================================|
+int ingest_accept(void) {
+    struct epoll_event ev;
+    IngestClient *client;
+    int accepted = 0;
+    int fd;
+    int slot;
+
+    while ((fd = accept4(listen_fd, NULL, NULL, SOCK_NONBLOCK)) != -1) {
+        for (slot = 0; slot < INGEST_MAX_CLIENTS && clients[slot] != NULL; slot++) {
+        }
+        client = (slot < INGEST_MAX_CLIENTS) ? calloc(1, sizeof(IngestClient)) : NULL;
+        if (client != NULL) {
+            client->pending = malloc(INGEST_RECV_SIZE);
+        }
+        if (client == NULL || client->pending == NULL) {
+            fprintf(stderr, "ingest: refusing client, limit reached\n");
+            free(client);
+            close(fd);
+            continue;
+        }
+
+        client->fd = fd;
+        ev.events = EPOLLIN;
+        ev.data.ptr = client;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) == -1) {
+            perror("epoll_ctl");
+            free(client->pending);
+            free(client);
+            close(fd);
+            continue;
+        }
+        clients[slot] = client;
+        accepted++;
+    }
+
+    return accepted;
+}
+
+//==================================================FUNCTION========================|
+//Name:           ingest_receive                                                     |
+//Params:         IngestClient* client    A readable client.                         |
+//Returns:        int                     0 on success, -1 if the shared buffer     |
+//                                        went away                                 |
+//Outputs:        NONE                                                              |
+//Description:    Reads one large batch from the client, after the partial record    |
+//                left over from the last batch, and pushes it to the ring.          |
+//==================================================================================|
+int ingest_receive(IngestClient *client) {
+    ssize_t got;
+
+    if (client->pending_start > 0) {
+        memmove(client->pending, client->pending + client->pending_start,
+                (size_t)client->pending_len);
+        client->pending_start = 0;
+    }
+
+    got = recv(client->fd, client->pending + client->pending_len,
+               (size_t)(INGEST_RECV_SIZE - client->pending_len), 0);
+    if (got == 0 || (got == -1 && errno != EAGAIN && errno != EINTR)) {
+        ingest_close_client(client);
+        return 0;
+    }
+    if (got == -1) {
+        return 0;
+    }
+
+    client->pending_len += (int)got;
+
+    return ingest_flush(client);
+}
+
+//==================================================FUNCTION========================|
+//Name:           ingest_flush                                                       |
+//Params:         IngestClient* client    Client with received bytes.                |
+//Returns:        int                     0 on success, -1 if the shared buffer     |
+//                                        went away                                 |
+//Outputs:        NONE                                                              |
+//Description:    Writes as many whole records as fit into the ring. If whole        |
+//                records remain, the client stops being read (back-pressure) until  |
+//                they are written; afterwards it is re-armed for reading. A record  |
+//                cut off at the end of the batch is kept for the next recv. A client|
+//                whose next record is malformed or can never fit in the ring is     |
+//                closed.                                                            |
+//==================================================================================|
+int ingest_flush(IngestClient *client) {
+    struct epoll_event ev;
+    const char *next;
+    int size;
+    int len;
+
+    if (lock_buffer(cb, sem_id) == -1) {
+        return -1;
+    }
+    TRACE_BEGIN(TRACE_WRITE);
+    len = rec_whole_prefix(client->pending + client->pending_start, client->pending_len,
+                           cb_get_free_space(cb));
+    if (len > 0) {
+        cb_write_multi(cb, client->pending + client->pending_start, (size_t)len);
+    }
+    if (len < client->pending_len) {
+        TRACE_INSTANT(TRACE_RING_FULL, client->pending_len - len);
+    }
+    TRACE_END(TRACE_WRITE, len);
+    unlock_buffer(cb, sem_id);
+
+    client->pending_start += len;
+    client->pending_len -= len;
+
+    next = client->pending + client->pending_start;
+    size = (client->pending_len > 0) ? rec_record_size(next, client->pending_len) : 0;
+    if (size == -1 || size > BUFFER_SIZE - 1) {
+        fprintf(stderr, "ingest: malformed or oversized record from client, closing it\n");
+        ingest_close_client(client);
+        return 0;
+    }
+
+    /* a stalled client is taken out of the epoll set entirely, so a hang-up
+       cannot wake the loop while its last bytes are still waiting; only a
+       partial record left means the client has to be read again */
+    if (rec_whole_prefix(next, client->pending_len, client->pending_len) > 0) {
+        if (!client->stalled) {
+            client->stalled = 1;
+            stalled_count++;
+            epoll_ctl(epoll_fd, EPOLL_CTL_DEL, client->fd, NULL);
+        }
+    } else if (client->stalled) {
+        client->stalled = 0;
+        stalled_count--;
+        ev.events = EPOLLIN;
+        ev.data.ptr = client;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, client->fd, &ev);
+    }
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           ingest_close_client                                                |
+//Params:         IngestClient* client    Client to drop.                            |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    Closes a client connection and releases its buffer.                |
+//==================================================================================|
+void ingest_close_client(IngestClient *client) {
+    int i;
+
+    for (i = 0; i < INGEST_MAX_CLIENTS; i++) {
+        if (clients[i] == client) {
+            clients[i] = NULL;
+        }
+    }
+    if (client->stalled) {
+        stalled_count--;
+    }
+    close(client->fd);
+    free(client->pending);
+    free(client);
+}
+
+//==================================================FUNCTION========================|
+//Name:           ingest_cleanup                                                     |
+//Params:         NONE                                                              |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    Closes all clients and the socket, and detaches the buffer. The    |
+//                segment and semaphore belong to the DP-1/DP-2/DC chain.            |
+//==================================================================================|
+void ingest_cleanup(void) {
+    int i;
+
+    for (i = 0; i < INGEST_MAX_CLIENTS; i++) {
+        if (clients[i] != NULL) {
+            ingest_close_client(clients[i]);
+        }
+    }
+
+    if (listen_fd != -1) {
+        close(listen_fd);
+        unlink(socket_path);
+        listen_fd = -1;
+    }
+
+    if (epoll_fd != -1) {
+        close(epoll_fd);
+        epoll_fd = -1;
+    }
+
+    if (cb != NULL) {
+        detach_shared_memory(cb);
+        cb = NULL;
+    }
+
+    trace_close();
+}
+
+//==================================================FUNCTION========================|
+//Name:           ingest_signal_handler                                              |
+//Params:         int sig               Signal received                              |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    Handles SIGINT/SIGTERM by clearing the run flag.                   |
+//==================================================================================|
+void ingest_signal_handler(int sig) {
+    if (sig == SIGINT || sig == SIGTERM) {
+        run = 0;
+    }
+}
@@ -0,0 +1,25 @@
+/*
+*	FILE:			main.c
+*	ASSIGNMENT:	The "Histogram System"
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This is the entry point for the ingest producer. It attaches to
+*					the running pipeline and serves clients until interrupted.
+*/
+
+#include "../inc/ingest.h"
+
+int main(void) {
+    int result;
+
+    result = ingest_init();
+    if (result != 0) {
+        fprintf(stderr, "Failed to initialize ingest\n");
+        ingest_cleanup();
+        return EXIT_FAILURE;
+    }
+
+    result = ingest_process();
+    ingest_cleanup();
+
+    return (result == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,29 @@
+/*
+*	FILE:			replay.h
+*	ASSIGNMENT:	The "Histogram System"
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This header file defines the interface for the replay producer. It
+*                 streams a stream log recorded by DC back through the shared
+*                 circular buffer, at the recorded pace or as fast as DC drains it.
+*/
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+int replay_init(void);
+int replay_file(const char *path, int max_speed);
+int replay_write(const char *span, int len);
+void replay_wait_until(uint64_t at_us);
+void replay_print_stats(FILE *out);
+void replay_cleanup(void);
+void replay_signal_handler(int sig);
+
+#endif /* REPLAY_H */
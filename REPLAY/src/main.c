@@ -0,0 +1,41 @@
+/*
+*	FILE:			main.c
+*	ASSIGNMENT:	The "Histogram System"
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This is the entry point for the replay producer. Segments are
+*					replayed in the order given, so "prefix.*.hsl" replays a whole
+*					recording.
+*/
+
+#include "../inc/replay.h"
+
+int main(int argc, char *argv[]) {
+    int max_speed = 0;
+    int result = 0;
+    int first = 1;
+    int i;
+
+    if (argc > 1 && strcmp(argv[1], "-m") == 0) {
+        max_speed = 1;
+        first = 2;
+    }
+    if (first >= argc) {
+        fprintf(stderr, "Usage: %s [-m] segment.hsl ...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (replay_init() != 0) {
+        fprintf(stderr, "Failed to initialize replay\n");
+        replay_cleanup();
+        return EXIT_FAILURE;
+    }
+
+    for (i = first; i < argc && result == 0; i++) {
+        result = replay_file(argv[i], max_speed);
+    }
+
+    replay_print_stats(stdout);
+    replay_cleanup();
+
+    return (result == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,260 @@
+/*
+*	FILE:			replay_function.c
+*	ASSIGNMENT:	The "Histogram System"
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This file implements the replay producer. Spans are written in
+*					whole records, as every producer must; a record that a drain cut
+*					in two is held back until the rest of it is read from the log.
+*					While the ring is full the producer retries every
+*					REPLAY_RETRY_US, so the recorded pace is a lower bound on timing.
+*/
+
+#include <errno.h>
+#include <time.h>
+#include "../../common/inc/constants.h"
+#include "../../common/inc/circular_buffer.h"
+#include "../../common/inc/ipc_utils.h"
+#include "../../common/inc/record.h"
+#include "../../common/inc/stream_log.h"
+#include "../../common/inc/trace.h"
+#include "../../common/inc/instance.h"
+#include "../inc/replay.h"
+
+#define REPLAY_PENDING 4096
+
+static CircularBuffer *cb = NULL;
+static int shm_id = -1;
+static int sem_id = -1;
+static volatile sig_atomic_t run = 1;
+static char pending[REPLAY_PENDING];
+static int pending_len = 0;
+static int clock_started = 0;
+static struct timespec start;
+static uint64_t first_us = 0;
+static uint64_t spans = 0;
+static uint64_t bytes = 0;
+static uint64_t stalls = 0;
+
+//==================================================FUNCTION========================|
+//Name:           replay_init                                                        |
+//Params:         NONE                                                              |
+//Returns:        int                     0 on success, -1 on failure                |
+//Outputs:        NONE                                                              |
+//Description:    Attaches to the circular buffer and semaphore of the running      |
+//                pipeline. It never creates them: a segment nobody set up would    |
+//                never be drained, and would keep DP-1 from starting.              |
+//==================================================================================|
+int replay_init(void) {
+    key_t sem_key;
+    key_t shm_key;
+
+    trace_init("replay");
+    if (instance_keys(&sem_key, &shm_key) == -1) {
+        return -1;
+    }
+    shm_id = shmget(shm_key, sizeof(CircularBuffer), 0);
+    sem_id = semget(sem_key, 1, 0);
+    if (shm_id == -1 || sem_id == -1) {
+        fprintf(stderr, "replay: no running pipeline (%s)\n", strerror(errno));
+        return -1;
+    }
+
+    cb = (CircularBuffer *)attach_shared_memory(shm_id);
+    if (cb == NULL) {
+        return -1;
+    }
+    if (cb->magic != CB_MAGIC) {
+        fprintf(stderr, "replay: the pipeline has not finished starting\n");
+        return -1;
+    }
+    if (instance_check(cb, "replay") == -1) {
+        return -1;
+    }
+
+    if (setup_signal_handler(SIGINT, replay_signal_handler) == -1 ||
+        setup_signal_handler(SIGTERM, replay_signal_handler) == -1) {
+        return -1;
+    }
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           replay_file                                                        |
+//Params:         const char* path        A stream log segment.                      |
+//                int max_speed           1 to ignore the recorded timing.           |
+//Returns:        int                     0 on success, -1 on a bad segment or when  |
+//                                        interrupted                                |
+//Outputs:        Prints an error for corrupt segments                              |
+//Description:    Replays every span of one segment.                                 |
+//==================================================================================|
+int replay_file(const char *path, int max_speed) {
+    SlReader reader;
+    SlBlock block;
+    SlCursor cursor;
+    const char *span;
+    int result = 0;
+    int status;
+    int len;
+
+    if (sl_reader_open(&reader, path) == -1) {
+        return -1;
+    }
+    memset(&block, 0, sizeof(block));
+
+    while (run && (status = sl_reader_next(&reader, &block)) == 1) {
+        sl_cursor_init(&block, &cursor);
+        while (run && (status = sl_block_next_span(&block, &cursor, &span, &len)) == 1) {
+            if (!max_speed) {
+                replay_wait_until(cursor.at_us);
+            }
+            if (replay_write(span, len) == -1) {
+                break;
+            }
+            spans++;
+        }
+        if (status == -1) {
+            break;
+        }
+    }
+
+    if (status == -1) {
+        fprintf(stderr, "%s: corrupt block\n", path);
+        result = -1;
+    } else if (!run) {
+        result = -1;
+    }
+
+    sl_reader_close(&reader);
+    sl_block_free(&block);
+    return result;
+}
+
+//==================================================FUNCTION========================|
+//Name:           replay_wait_until                                                  |
+//Params:         uint64_t at_us          Recorded time of the next span.            |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    Sleeps until the same time has passed since the first replayed     |
+//                span as had passed when the span was recorded.                     |
+//==================================================================================|
+void replay_wait_until(uint64_t at_us) {
+    struct timespec target;
+    uint64_t offset_ns;
+
+    if (!clock_started) {
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        first_us = at_us;
+        clock_started = 1;
+        return;
+    }
+    if (at_us <= first_us) {
+        return;
+    }
+
+    offset_ns = (at_us - first_us) * 1000ULL + (uint64_t)start.tv_nsec;
+    target.tv_sec = start.tv_sec + (time_t)(offset_ns / 1000000000ULL);
+    target.tv_nsec = (long)(offset_ns % 1000000000ULL);
+    while (run && clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &target, NULL) == EINTR) {
+    }
+}
+
+//==================================================FUNCTION========================|
+//Name:           replay_write                                                       |
+//Params:         const char* span        Bytes as DC drained them.                  |
+//                int len                 Number of bytes.                           |
+//Returns:        int                     0 on success, -1 when interrupted or the   |
+//                                        recording holds a malformed record         |
+//Outputs:        NONE                                                              |
+//Description:    Appends the span to the pending bytes and writes every complete    |
+//                record to the ring, waiting while it is full.                      |
+//==================================================================================|
+int replay_write(const char *span, int len) {
+    int whole;
+    int take;
+    int n;
+
+    while (len > 0) {
+        take = (len < REPLAY_PENDING - pending_len) ? len : REPLAY_PENDING - pending_len;
+        memcpy(pending + pending_len, span, (size_t)take);
+        pending_len += take;
+        span += take;
+        len -= take;
+
+        whole = rec_whole_prefix(pending, pending_len, pending_len);
+        while (whole > 0) {
+            if (!run || lock_buffer(cb, sem_id) == -1) {
+                return -1;
+            }
+            TRACE_BEGIN(TRACE_WRITE);
+            n = rec_whole_prefix(pending, whole, cb_get_free_space(cb));
+            if (n > 0) {
+                cb_write_multi(cb, pending, (size_t)n);
+            }
+            if (n < whole) {
+                TRACE_INSTANT(TRACE_RING_FULL, whole - n);
+            }
+            TRACE_END(TRACE_WRITE, n);
+            unlock_buffer(cb, sem_id);
+
+            memmove(pending, pending + n, (size_t)(pending_len - n));
+            pending_len -= n;
+            whole -= n;
+            bytes += (uint64_t)n;
+            if (whole > 0) {
+                stalls++;
+                usleep(REPLAY_RETRY_US);
+            }
+        }
+        if (pending_len > 0 && rec_record_size(pending, pending_len) == -1) {
+            fprintf(stderr, "replay: malformed record in the recording, stopping\n");
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           replay_print_stats                                                 |
+//Params:         FILE* out               Stream to print to.                        |
+//Returns:        NONE                                                              |
+//Outputs:        Prints "key=value" totals                                         |
+//Description:    Reports what was replayed and how often the ring was full.         |
+//==================================================================================|
+void replay_print_stats(FILE *out) {
+    fprintf(out, "spans=%llu\n", (unsigned long long)spans);
+    fprintf(out, "bytes=%llu\n", (unsigned long long)bytes);
+    fprintf(out, "ring_full_retries=%llu\n", (unsigned long long)stalls);
+    if (pending_len > 0) {
+        fprintf(out, "incomplete_tail=%d\n", pending_len);
+    }
+}
+
+//==================================================FUNCTION========================|
+//Name:           replay_cleanup                                                     |
+//Params:         NONE                                                              |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    Detaches from the shared buffer. The pipeline keeps running.       |
+//==================================================================================|
+void replay_cleanup(void) {
+    trace_close();
+
+    if (cb != NULL) {
+        detach_shared_memory(cb);
+        cb = NULL;
+    }
+}
+
+//==================================================FUNCTION========================|
+//Name:           replay_signal_handler                                              |
+//Params:         int sig                 Signal number                              |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    Stops the replay at the next span.                                 |
+//==================================================================================|
+void replay_signal_handler(int sig) {
+    (void)sig;
+    run = 0;
+}
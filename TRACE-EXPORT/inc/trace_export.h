@@ -0,0 +1,37 @@
+/*
+*	FILE:			trace_export.h
+*	ASSIGNMENT:	The "Histogram System"
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This header file defines the interface for trace-export, which
+*                 merges the per-process trace rings into one Chrome trace-event JSON
+*                 file (viewable in chrome://tracing or Perfetto).
+*/
+
+#ifndef TRACE_EXPORT_H
+#define TRACE_EXPORT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "../../common/inc/trace.h"
+
+typedef struct {
+    uint64_t ns;                   /* wall clock time of the event */
+    uint32_t pid;
+    uint32_t arg;
+    uint16_t id;
+    uint8_t phase;
+} ExportEvent;
+
+typedef struct {
+    int count;
+    int capacity;
+    ExportEvent *events;
+} ExportList;
+
+int te_load_ring(const char *path, ExportList *list, FILE *meta_out, int *first);
+int te_load_dir(const char *dir, ExportList *list, FILE *meta_out, int *first);
+void te_write_events(const ExportList *list, FILE *out, int first);
+
+#endif /* TRACE_EXPORT_H */
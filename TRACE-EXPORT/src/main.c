@@ -0,0 +1,33 @@
+/*
+*	FILE:			main.c
+*	ASSIGNMENT:	The "Histogram System"
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This is the entry point for trace-export. With no arguments it
+*					reads every ring in HISTO_TRACE_DIR; otherwise the named ring
+*					files. The JSON is written to stdout.
+*/
+
+#include "../../common/inc/config.h"
+#include "../inc/trace_export.h"
+
+int main(int argc, char *argv[]) {
+    ExportList list = {0};
+    int first = 1;
+    int i;
+
+    printf("{\"traceEvents\":[");
+
+    if (argc > 1) {
+        for (i = 1; i < argc; i++) {
+            te_load_ring(argv[i], &list, stdout, &first);
+        }
+    } else {
+        te_load_dir(config_get_str("HISTO_TRACE_DIR", "/dev/shm"), &list, stdout, &first);
+    }
+
+    te_write_events(&list, stdout, first);
+    printf("\n],\"displayTimeUnit\":\"ns\"}\n");
+    free(list.events);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,167 @@
+/*
+*	FILE:			trace_export_function.c
+*	ASSIGNMENT:	The "Histogram System"
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This file implements trace-export. Each ring's TSC timestamps are
+*					converted to wall-clock time with the calibration stored in its
+*					header, so events from all processes share one timeline.
+*/
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "../inc/trace_export.h"
+
+//==================================================FUNCTION========================|
+//Name:           te_compare                                                         |
+//Params:         const void* a, const void* b   Events to compare.                  |
+//Returns:        int                     qsort ordering by time.                    |
+//Outputs:        NONE                                                              |
+//Description:    This function orders events by wall-clock time.                    |
+//==================================================================================|
+static int te_compare(const void *a, const void *b) {
+    const ExportEvent *ea = a;
+    const ExportEvent *eb = b;
+
+    return (ea->ns > eb->ns) - (ea->ns < eb->ns);
+}
+
+//==================================================FUNCTION========================|
+//Name:           te_load_ring                                                       |
+//Params:         const char* path        A histo-trace.<pid> file.                  |
+//                ExportList* list        Receives the ring's events.                |
+//                FILE* meta_out          Stream for the process-name record.        |
+//                int* first              1 until the first JSON record is written.  |
+//Returns:        int                     Returns 0 on success, -1 on failure.       |
+//Outputs:        Writes a process_name metadata record                             |
+//Description:    This function maps a ring read-only and copies out the events      |
+//                that have not been overwritten. A header that does not describe a  |
+//                power-of-two ring held whole in the file is rejected.              |
+//==================================================================================|
+int te_load_ring(const char *path, ExportList *list, FILE *meta_out, int *first) {
+    const TraceRing *ring;
+    const TraceEvent *ev;
+    ExportEvent *grown;
+    struct stat st;
+    uint64_t start, pos;
+    int fd;
+
+    fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        perror(path);
+        return -1;
+    }
+    if (fstat(fd, &st) == -1 || (size_t)st.st_size < sizeof(TraceRing)) {
+        close(fd);
+        return -1;
+    }
+    ring = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (ring == MAP_FAILED) {
+        perror("mmap");
+        return -1;
+    }
+
+    if (ring->magic != TRACE_MAGIC || ring->capacity == 0 ||
+        (ring->capacity & (ring->capacity - 1)) != 0 || !(ring->tsc_per_ns > 0.0) ||
+        (size_t)st.st_size < sizeof(TraceRing) + (size_t)ring->capacity * sizeof(TraceEvent)) {
+        fprintf(stderr, "trace-export: %s is not a trace ring\n", path);
+        munmap((void *)ring, (size_t)st.st_size);
+        return -1;
+    }
+
+    fprintf(meta_out, "%s\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%u,\"args\":{\"name\":\"%.*s\"}}",
+            *first ? "" : ",", ring->pid, TRACE_NAME_LEN, ring->name);
+    *first = 0;
+
+    start = (ring->position > ring->capacity) ? ring->position - ring->capacity : 0;
+    for (pos = start; pos < ring->position; pos++) {
+        if (list->count == list->capacity) {
+            list->capacity = list->capacity ? list->capacity * 2 : 4096;
+            grown = realloc(list->events, (size_t)list->capacity * sizeof(ExportEvent));
+            if (grown == NULL) {
+                munmap((void *)ring, (size_t)st.st_size);
+                return -1;
+            }
+            list->events = grown;
+        }
+        ev = &ring->events[pos & (ring->capacity - 1)];
+        list->events[list->count].ns =
+            ring->base_ns + (uint64_t)((double)(int64_t)(ev->tsc - ring->base_tsc) / ring->tsc_per_ns);
+        list->events[list->count].pid = ring->pid;
+        list->events[list->count].arg = ev->arg;
+        list->events[list->count].id = ev->id;
+        list->events[list->count].phase = ev->phase;
+        list->count++;
+    }
+
+    munmap((void *)ring, (size_t)st.st_size);
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           te_load_dir                                                        |
+//Params:         const char* dir         Directory holding the trace rings.         |
+//                ExportList* list        Receives all events.                       |
+//                FILE* meta_out          Stream for process-name records.           |
+//                int* first              1 until the first JSON record is written.  |
+//Returns:        int                     Number of rings loaded.                    |
+//Outputs:        NONE                                                              |
+//Description:    This function loads every histo-trace.* file in 'dir'.             |
+//==================================================================================|
+int te_load_dir(const char *dir, ExportList *list, FILE *meta_out, int *first) {
+    struct dirent *entry;
+    char path[4096];
+    DIR *d;
+    int loaded = 0;
+
+    d = opendir(dir);
+    if (d == NULL) {
+        perror(dir);
+        return 0;
+    }
+
+    while ((entry = readdir(d)) != NULL) {
+        if (strncmp(entry->d_name, TRACE_FILE_PREFIX, strlen(TRACE_FILE_PREFIX)) != 0) {
+            continue;
+        }
+        snprintf(path, sizeof(path), "%s/%s", dir, entry->d_name);
+        if (te_load_ring(path, list, meta_out, first) == 0) {
+            loaded++;
+        }
+    }
+
+    closedir(d);
+    return loaded;
+}
+
+//==================================================FUNCTION========================|
+//Name:           te_write_events                                                    |
+//Params:         const ExportList* list  Events from all rings (sorted in place).   |
+//                FILE* out               JSON output stream.                        |
+//                int first               1 if no JSON record was written yet.       |
+//Returns:        NONE                                                              |
+//Outputs:        Writes the trace events                                           |
+//Description:    This function sorts the merged events by time and writes them as   |
+//                Chrome trace-event records, one thread per process.                |
+//==================================================================================|
+void te_write_events(const ExportList *list, FILE *out, int first) {
+    const ExportEvent *ev;
+    int i;
+
+    qsort(list->events, (size_t)list->count, sizeof(ExportEvent), te_compare);
+
+    for (i = 0; i < list->count; i++) {
+        ev = &list->events[i];
+        fprintf(out, "%s\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%llu.%03u,\"pid\":%u,\"tid\":%u",
+                first ? "" : ",", trace_event_name(ev->id), ev->phase,
+                (unsigned long long)(ev->ns / 1000), (unsigned int)(ev->ns % 1000), ev->pid, ev->pid);
+        if (ev->phase == TRACE_PHASE_INSTANT) {
+            fprintf(out, ",\"s\":\"p\"");
+        }
+        fprintf(out, ",\"args\":{\"arg\":%u}}", ev->arg);
+        first = 0;
+    }
+}
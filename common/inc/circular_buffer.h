@@ -5,12 +5,27 @@
 *	DESCRIPTION:	This header file defines the structure and dependencies 
 *                 required for implementing a circular buffer using shared memory. 
 *                 It includes the CircularBuffer struct and necessary system headers.
+*
+*                 DC reads through read_index. Up to CB_MAX_CONSUMERS further
+*                 consumers can register for the same stream, each with a cursor on
+*                 its own cache line. A CB_CONSUMER_GATE consumer holds the producers
+*                 back like DC does. A CB_CONSUMER_DROP consumer never does; if a
+*                 write would overrun it, it is marked CB_CONSUMER_DROPPED and must
+*                 register again. Cursors count bytes since cb_init, so their ring
+*                 position is the cursor modulo BUFFER_SIZE. All of this is done
+*                 under the semaphore.
+*
+*                 The semaphore is taken with lock_buffer (ipc_utils.h), which
+*                 records the holder in lock_owner. SEM_UNDO releases it if the
+*                 holder dies, and the next process to lock finds lock_owner still
+*                 set, repairs the ring with cb_repair and counts a recovery.
 */
 
 #ifndef CIRCULAR_BUFFER_H
 #define CIRCULAR_BUFFER_H
 
 #include <stddef.h> 
+#include <stdint.h>
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -21,11 +36,53 @@
 #include <sys/sem.h>
 #include <sys/shm.h>
 #include <unistd.h>
+#include "control.h"
+#include "live.h"
+
+#define CB_MAX_CONSUMERS 4
+
+/* Set by cb_init; the instance name is written by DP-1, see instance.h */
+#define CB_MAGIC 0x48495354
+#define CB_NAME_SIZE 32
+
+/* Consumer slot states; GATE and DROP are also the policies to register with */
+#define CB_CONSUMER_FREE 0
+#define CB_CONSUMER_GATE 1
+#define CB_CONSUMER_DROP 2
+#define CB_CONSUMER_DROPPED 3
+
+typedef struct {
+    int state;
+    pid_t pid;                     /* owner, so a dead consumer can be reaped */
+    uint64_t cursor;               /* bytes read since cb_init */
+} __attribute__((aligned(64))) CbConsumer;
 
 typedef struct {
     int read_index;                
     int write_index;               
     char buffer[256];              
+    ControlQueue control;          /* live settings, see control.h */
+    LiveHistogram live;            /* DC's counts for readers, see live.h */
+    uint64_t write_seq;            /* bytes written since cb_init */
+    CbConsumer consumers[CB_MAX_CONSUMERS];
+    uint32_t magic;                /* CB_MAGIC once initialised */
+    char instance[CB_NAME_SIZE];   /* HISTO_INSTANCE of the pipeline, "" by default */
+    pid_t lock_owner;              /* process holding the semaphore, 0 when free */
+    pid_t lock_dead_owner;         /* last holder that died with it */
+    uint64_t lock_recoveries;      /* locks taken over from a dead holder */
 } CircularBuffer;
 
+int cb_init(CircularBuffer *cb);
+int cb_write_char(CircularBuffer *cb, char c);
+int cb_write_multi(CircularBuffer *cb, const char *data, size_t len);
+int cb_read_char(CircularBuffer *cb, char *c);
+int cb_read_multi(CircularBuffer *cb, char *buf, size_t max_len);
+int cb_get_available(const CircularBuffer *cb);
+int cb_get_free_space(const CircularBuffer *cb);
+int cb_consumer_register(CircularBuffer *cb, int policy, pid_t pid);
+void cb_consumer_release(CircularBuffer *cb, int slot);
+int cb_consumer_read(CircularBuffer *cb, int slot, char *buf, size_t max_len);
+int cb_consumer_reap(CircularBuffer *cb);
+int cb_repair(CircularBuffer *cb);
+
 #endif 
\ No newline at end of file
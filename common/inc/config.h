@@ -0,0 +1,20 @@
+/*
+*	FILE:			config.h
+*	ASSIGNMENT:	    Histogram System
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This header file declares helpers for reading start-up configuration.
+*                 Every option has a compiled-in default in constants.h which can be
+*                 overridden by an environment variable (inherited by the child
+*                 processes that DP-1 and DP-2 launch).
+*/
+
+#ifndef CONFIG_H
+#define CONFIG_H
+
+int config_get_int(const char *name, int default_value);
+
+double config_get_double(const char *name, double default_value);
+
+const char *config_get_str(const char *name, const char *default_value);
+
+#endif /* CONFIG_H */
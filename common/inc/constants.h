@@ -24,12 +24,112 @@
 #define DP2_SLEEP_TIME 50000  
 #define DC_READ_SLEEP_TIME 2000000
 #define DC_DISPLAY_INTERVAL 5 
+#define DC_LOOP_SLEEP_US 10000
 
-#define DP1_PROCESS "/home/qvu5836/assignment5/DP-1/bin/dp1"
-#define DP2_PROCESS "/home/qvu5836/assignment5/DP-2/bin/dp2"
-#define DC_PROCESS "/home/qvu5836/assignment5/DC/bin/dc"
+/* Programs below the install root (HISTO_HOME), see instance_program */
+#define DP1_PROCESS "DP-1/bin/dp1"
+#define DP2_PROCESS "DP-2/bin/dp2"
+#define DC_PROCESS "DC/bin/dc"
 
 #define HISTOGRAM_ONES '-'
 #define HISTOGRAM_TENS '+'
 #define HISTOGRAM_HUNDREDS '*'
+
+/* Approximate heavy-hitter mode (HISTO_SKETCH, HISTO_CMS_WIDTH, HISTO_CMS_DEPTH, HISTO_TOPK) */
+#define DC_SKETCH_DEFAULT 0
+#define CMS_DEFAULT_WIDTH 1024
+#define CMS_DEFAULT_DEPTH 4
+#define TOPK_DEFAULT 10
+
+/* Distinct-key estimation (HISTO_HLL_PRECISION, 0 disables; HISTO_HLL_CHECKPOINT) */
+#define HLL_DEFAULT_PRECISION 12
+
+/* Numeric samples (HISTO_DP1_SAMPLES, HISTO_HDR_DIGITS, 0 disables; HISTO_HDR_HIGHEST) */
+#define DP1_SAMPLES_DEFAULT 0
+#define DP1_SAMPLES_PER_WRITE 20
+#define HDR_DEFAULT_DIGITS 3
+#define HDR_DEFAULT_HIGHEST 3600000000LL
+
+/* Binary histogram dumps, on SIGUSR1 or every HISTO_DUMP_INTERVAL seconds (0 = off) */
+#define DC_DUMP_PATH_DEFAULT "histogram.hst"
+#define DC_DUMP_INTERVAL_DEFAULT 0
+
+/* Multi-channel streams (HISTO_CHANNELS in DC, HISTO_DISPLAY_CHANNEL, HISTO_DP1_CHANNELS);
+   per-channel histograms are off unless HISTO_CHANNELS is set */
+#define DC_CHANNELS_DEFAULT 0
+#define DC_DISPLAY_CHANNEL_DEFAULT -1
+#define DC_CHANNEL_SUMMARY 5
+#define DP1_CHANNELS_DEFAULT 0
+
+/* Hot restart: counts handed from a detaching DC to the next (HISTO_HANDOFF_PATH) */
+#define DC_HANDOFF_PATH_DEFAULT "dc-handoff.hst"
+#define DC_HANDOFF_EXIT 1
+#define DC_HANDOFF_EXEC 2
+
+/* histo-tap: pause between drains of its consumer slot when the buffer is empty */
+#define HT_INTERVAL_MS_DEFAULT 100
+
+/* histo-bench: timed calls per repetition and repetitions per benchmark */
+#define BENCH_ITERATIONS_DEFAULT 1000000
+#define BENCH_REPS_DEFAULT 5
+
+/* Bit-packed letters from DP-1 (HISTO_DP1_PACKED), width from the alphabet size; saves space only from batches of 21 letters (A..T) */
+#define DP1_PACKED_DEFAULT 0
+
+/* Producer-side aggregation (HISTO_DP1_DELTA, HISTO_DELTA_INTERVAL_MS) */
+#define DP1_DELTA_DEFAULT 0
+#define DP1_DELTA_INTERVAL_MS_DEFAULT 1000
+
+/* Transition counts within channel spans and packed records (HISTO_NGRAM: 0 off, 2 or 3) */
+#define DC_NGRAM_DEFAULT 0
+
+/* Stream recording (HISTO_RECORD_PATH prefix, HISTO_RECORD_BLOCK_KB, HISTO_RECORD_SEGMENT_MB) */
+#define DC_RECORD_BLOCKS 8
+#define DC_RECORD_BLOCK_KB_DEFAULT 64
+#define DC_RECORD_SEGMENT_MB_DEFAULT 64
+#define DC_RECORD_FLUSH_MS 1000
+#define REPLAY_RETRY_US 1000
+
+/* Interval history (HISTO_HISTORY_PATH, HISTO_HISTORY_INTERVAL in seconds, HISTO_HISTORY_SEGMENT_KB) */
+#define DC_HISTORY_INTERVAL_DEFAULT 60
+#define DC_HISTORY_SEGMENT_KB_DEFAULT 1024
+
+/* Low-jitter mode (HISTO_RT=1, HISTO_RT_PRIORITY for SCHED_FIFO, 0 keeps the normal scheduler; HISTO_RT_WATCHDOG_MS) */
+#define DC_RT_STACK_KB 256
+#define DC_RT_WATCHDOG_MS_DEFAULT 500
+#define DC_RT_HIGHEST_US 10000000
+
+/* Live settings changed with histo-ctl (see control.h) */
+#define DP1_BATCH_DEFAULT 20
+#define DP1_MAX_BATCH 200
+#define DP1_BLOCK_RETRY_US 1000
+#define DP2_BATCH_DEFAULT 1
+#define DP2_MAX_BATCH 64
+#define DC_READ_BYTES_DEFAULT 40
+#define DC_READ_INTERVAL_DEFAULT 2
+
+/* Background exporter (HISTO_EXPORT_INTERVAL seconds, 0 = off; HISTO_EXPORT_FORMAT; HISTO_EXPORT_PATH) */
+#define DC_EXPORT_INTERVAL_DEFAULT 0
+#define DC_EXPORT_FORMAT_DEFAULT "csv"
+
+/* Unix domain socket ingest producer (HISTO_INGEST_SOCKET) */
+#define INGEST_SOCKET_DEFAULT "/tmp/histo-ingest.sock"
+#define INGEST_MAX_CLIENTS 1024
+#define INGEST_MAX_EVENTS 64
+#define INGEST_RECV_SIZE 65536
+#define INGEST_RETRY_MS 1
+
+/* Synthetic load model for DP-1/DP-2, see generator.h */
+#define GEN_DIST_DEFAULT "uniform"
+#define GEN_ZIPF_S_DEFAULT 1.0
+#define GEN_HOTSPOT_RATIO_DEFAULT 0.9
+#define GEN_HOTSPOT_KEYS_DEFAULT 1
+#define GEN_ARRIVAL_DEFAULT "steady"
+#define GEN_BURST_ON_MS_DEFAULT 1000
+#define GEN_BURST_OFF_MS_DEFAULT 4000
+#define GEN_BURST_FACTOR_DEFAULT 10
+#define GEN_RAMP_MS_DEFAULT 10000
+
+/* Distribution statistics in DC (HISTO_EXPECTED, default HISTO_DIST; HISTO_SKEW_ALERT chi-square, 0 = off) */
+#define DC_SKEW_ALERT_DEFAULT 0.0
 #endif /* CONSTANTS_H */
@@ -0,0 +1,65 @@
+/*
+*	FILE:			control.h
+*	ASSIGNMENT:	    Histogram System
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This header file defines the control queue kept in the shared
+*                 segment. histo-ctl posts commands under the semaphore; every
+*                 process keeps its own cursor and applies the commands addressed to
+*                 it at a safe point in its loop. The queue is a broadcast log, not a
+*                 work queue: nothing is removed, and a process that falls more than
+*                 CTL_QUEUE_SIZE commands behind skips the ones overwritten.
+*/
+
+#ifndef CONTROL_H
+#define CONTROL_H
+
+#include <stdint.h>
+
+#define CTL_QUEUE_SIZE 16
+
+/* Targets, a bit mask */
+#define CTL_DP1 0x1
+#define CTL_DP2 0x2
+#define CTL_DC 0x4
+#define CTL_PRODUCERS (CTL_DP1 | CTL_DP2)
+#define CTL_ALL (CTL_DP1 | CTL_DP2 | CTL_DC)
+
+/* Settings */
+enum {
+    CTL_OP_SLEEP_US = 1,           /* producers: base pause between writes */
+    CTL_OP_BATCH,                  /* producers: letters per write */
+    CTL_OP_OVERLOAD,               /* producers: CTL_OVERLOAD_DROP or _BLOCK */
+    CTL_OP_TRACE,                  /* all: 0 or 1 */
+    CTL_OP_DISPLAY_INTERVAL,       /* DC: drains between displays */
+    CTL_OP_READ_BYTES,             /* DC: most bytes per drain */
+    CTL_OP_READ_INTERVAL,          /* DC: seconds between drains */
+    CTL_OP_COUNT
+};
+
+/* What a producer does with letters that do not fit in the ring */
+#define CTL_OVERLOAD_DROP 0
+#define CTL_OVERLOAD_BLOCK 1
+
+typedef struct {
+    uint32_t target;
+    uint32_t op;
+    int64_t value;
+} ControlCommand;
+
+typedef struct {
+    uint32_t seq;                  /* commands ever posted */
+    ControlCommand commands[CTL_QUEUE_SIZE];
+} ControlQueue;
+
+typedef void (*ControlHandler)(void *ctx, const ControlCommand *command);
+
+void ctl_init(ControlQueue *queue);
+uint32_t ctl_cursor(const ControlQueue *queue);
+int ctl_post(ControlQueue *queue, uint32_t target, uint32_t op, int64_t value);
+int ctl_poll(const ControlQueue *queue, uint32_t *cursor, uint32_t self,
+             ControlHandler handler, void *ctx);
+uint32_t ctl_op_targets(uint32_t op);
+const char *ctl_op_name(uint32_t op);
+int ctl_op_from_name(const char *name);
+
+#endif /* CONTROL_H */
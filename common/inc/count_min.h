@@ -0,0 +1,47 @@
+/*
+*	FILE:			count_min.h
+*	ASSIGNMENT:	    Histogram System
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This header file defines a Count-Min sketch used by DC to estimate
+*                 per-key frequencies in fixed memory.
+*
+*                 The sketch is a depth x width table of 32-bit counters stored row
+*                 after row in one cache-line aligned block, so an update touches
+*                 exactly 'depth' counters. With N the total count added:
+*                   estimate(key) >= true(key)                       (always)
+*                   estimate(key) <= true(key) + (e / width) * N     (with probability
+*                                                                     1 - e^-depth)
+*                 e.g. width 1024, depth 4 gives an over-count of at most 0.27% of N
+*                 for 98% of queries, using 16 KiB.
+*/
+
+#ifndef COUNT_MIN_H
+#define COUNT_MIN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Largest table cms_init accepts: 2^24 counters per row, 32 rows */
+#define CMS_MAX_WIDTH (1 << 24)
+#define CMS_MAX_DEPTH 32
+
+typedef struct {
+    int width;                     /* counters per row, power of two */
+    int depth;                     /* number of rows / hash functions */
+    uint64_t total;                /* N, the sum of all updates */
+    uint32_t *table;               /* depth * width counters, row major */
+} CountMinSketch;
+
+int cms_init(CountMinSketch *cms, int width, int depth);
+
+void cms_update(CountMinSketch *cms, uint64_t key, uint32_t count);
+
+uint32_t cms_estimate(const CountMinSketch *cms, uint64_t key);
+
+uint64_t cms_error_bound(const CountMinSketch *cms);
+
+size_t cms_memory_size(const CountMinSketch *cms);
+
+void cms_free(CountMinSketch *cms);
+
+#endif /* COUNT_MIN_H */
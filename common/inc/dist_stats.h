@@ -0,0 +1,49 @@
+/*
+*	FILE:			dist_stats.h
+*	ASSIGNMENT:	    Histogram System
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This header file defines running statistics of a histogram whose
+*                 bins only grow: total, smallest and largest bin, Shannon entropy,
+*                 and Pearson's chi-square against an expected distribution.
+*
+*                 With N the total, n_i the bins and p_i the expected shares:
+*                   entropy    H  = log2 N - (sum n_i ln n_i) / (N ln 2)
+*                   chi-square X2 = (sum n_i^2 / p_i) / N - N,   bins - 1 d.o.f.
+*                 Both sums are kept up to date as bins grow, at O(1) per bin that
+*                 changed, so reading the statistics never walks the histogram.
+*                 The sums are long double: after 10^9 symbols in batches the
+*                 rounding in X2 stays far below 1. A count in a bin expected to be
+*                 empty makes X2 infinite.
+*/
+
+#ifndef DIST_STATS_H
+#define DIST_STATS_H
+
+#include <stdint.h>
+
+#define DIST_MAX_BINS 64
+
+typedef struct {
+    int bins;
+    double expected[DIST_MAX_BINS];  /* p_i, summing to 1 */
+    uint64_t counts[DIST_MAX_BINS];  /* as of the last update */
+    uint64_t total;
+    long double sum_n_ln_n;
+    long double sum_sq_over_p;
+    uint64_t unexpected;             /* counts in bins with p_i = 0 */
+    int min_bin;
+    int max_bin;
+    int min_ties;                    /* bins holding the minimum */
+} DistStats;
+
+int dist_init(DistStats *d, const double *weights, int bins);
+
+void dist_add(DistStats *d, int bin, uint64_t count);
+
+int dist_sync(DistStats *d, const uint64_t *counts);
+
+double dist_entropy(const DistStats *d);
+
+double dist_chi_square(const DistStats *d);
+
+#endif /* DIST_STATS_H */
@@ -0,0 +1,64 @@
+/*
+*	FILE:			generator.h
+*	ASSIGNMENT:	    Histogram System
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This header file defines the synthetic load model shared by the
+*                 producers: which symbol comes next, and when the next write happens.
+*
+*                 Symbol distributions (HISTO_DIST):
+*                   uniform   every symbol of CHAR_START..CHAR_END equally likely
+*                   zipf      rank k (CHAR_START = rank 1) has weight 1 / k^HISTO_ZIPF_S
+*                   hotspot   HISTO_HOTSPOT_RATIO of the traffic goes to the first
+*                             HISTO_HOTSPOT_KEYS symbols, the rest is uniform
+*                 Any distribution is turned into an alias table once, so drawing a
+*                 symbol costs one random number and one table lookup.
+*
+*                 Arrival patterns (HISTO_ARRIVAL), relative to the producer's sleep:
+*                   steady    the producer's normal cadence
+*                   onoff     HISTO_BURST_ON_MS at HISTO_BURST_FACTOR times the rate,
+*                             then HISTO_BURST_OFF_MS of silence
+*                   ramp      rate climbs linearly from 1x to HISTO_BURST_FACTOR x over
+*                             HISTO_RAMP_MS, then starts again
+*/
+
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+#include <stdint.h>
+
+#define GEN_MAX_SYMBOLS 256
+
+enum { ARRIVAL_STEADY = 0, ARRIVAL_ONOFF, ARRIVAL_RAMP };
+
+typedef struct {
+    int n;
+    char first;
+    uint64_t rng;
+    uint32_t threshold[GEN_MAX_SYMBOLS];   /* keep column i if the coin is below */
+    uint8_t alias[GEN_MAX_SYMBOLS];
+} SymbolGenerator;
+
+typedef struct {
+    int pattern;
+    int on_us;
+    int off_us;
+    int ramp_us;
+    int factor;
+    uint64_t start_us;
+} ArrivalPattern;
+
+int gen_init(SymbolGenerator *g, const double *weights, int n, char first, uint64_t seed);
+
+int gen_weights(const char *dist, double *weights, int n);
+
+int gen_init_from_config(SymbolGenerator *g, uint64_t seed);
+
+char gen_next(SymbolGenerator *g);
+
+void gen_fill(SymbolGenerator *g, char *buffer, int count);
+
+void arrival_init_from_config(ArrivalPattern *a);
+
+int arrival_next_sleep(ArrivalPattern *a, int base_us, int *send);
+
+#endif /* GENERATOR_H */
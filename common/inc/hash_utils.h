@@ -0,0 +1,22 @@
+/*
+*	FILE:			hash_utils.h
+*	ASSIGNMENT:	    Histogram System
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This header file provides the 64-bit mixing function shared by the
+*                 probabilistic sketches. It is the splitmix64 finalizer, which is cheap
+*                 and spreads small keys (single bytes, channel ids) over all 64 bits.
+*/
+
+#ifndef HASH_UTILS_H
+#define HASH_UTILS_H
+
+#include <stdint.h>
+
+static inline uint64_t hash_u64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+#endif /* HASH_UTILS_H */
@@ -0,0 +1,55 @@
+/*
+*	FILE:			hdr_histogram.h
+*	ASSIGNMENT:	    Histogram System
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This header file defines a log-linear (HDR style) histogram for
+*                 numeric samples.
+*
+*                 Values from 1 to 'highest' are split into power-of-two buckets, each
+*                 divided into linear sub-buckets, so every recorded value is kept to
+*                 'significant_digits' decimal digits of precision (relative error
+*                 below 10^-digits). Memory depends only on 'highest' and the digits,
+*                 and quantile queries walk the counts array once.
+*/
+
+#ifndef HDR_HISTOGRAM_H
+#define HDR_HISTOGRAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    uint64_t highest;              /* largest trackable value, larger ones are clamped */
+    int significant_digits;
+    int sub_bucket_half_count_magnitude;
+    int sub_bucket_half_count;
+    uint64_t sub_bucket_mask;
+    int bucket_count;
+    int counts_len;
+    uint64_t total;
+    uint64_t min;
+    uint64_t max;
+    uint64_t clamped;              /* samples above 'highest' */
+    double sum;
+    uint64_t *counts;
+} HdrHistogram;
+
+int hdr_init(HdrHistogram *h, uint64_t highest, int significant_digits);
+
+void hdr_record(HdrHistogram *h, uint64_t value);
+
+void hdr_record_count(HdrHistogram *h, uint64_t value, uint64_t count);
+
+uint64_t hdr_value_at_quantile(const HdrHistogram *h, double quantile);
+
+uint64_t hdr_value_at_index(const HdrHistogram *h, int index);
+
+double hdr_mean(const HdrHistogram *h);
+
+size_t hdr_memory_size(const HdrHistogram *h);
+
+void hdr_reset(HdrHistogram *h);
+
+void hdr_free(HdrHistogram *h);
+
+#endif /* HDR_HISTOGRAM_H */
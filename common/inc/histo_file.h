@@ -0,0 +1,69 @@
+/*
+*	FILE:			histo_file.h
+*	ASSIGNMENT:	    Histogram System
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This header file defines the binary histogram file format written by
+*                 DC and combined by histo-merge.
+*
+*                 Layout (all integers are LEB128 varints unless noted):
+*                   "HSTO"                      magic, 4 bytes
+*                   version                     1 byte, HF_VERSION
+*                   section count
+*                   per section: type, channel, first key, bin count, then one
+*                                zigzag varint per bin holding bin[i] - bin[i-1]
+*                   CRC-32 of all preceding bytes, 4 bytes little-endian
+*
+*                 Neighbouring bins of a histogram are usually close, so the deltas
+*                 mostly fit in one or two bytes.
+*/
+
+#ifndef HISTO_FILE_H
+#define HISTO_FILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define HF_MAGIC "HSTO"
+#define HF_VERSION 1
+#define HF_MAX_VARINT 10
+
+#define HF_SECTION_SYMBOLS 1        /* all symbols DC has counted */
+#define HF_SECTION_CHANNEL 2        /* symbols of one channel, see record.h */
+#define HF_SECTION_ORIGIN 3         /* hand-off only: the pipeline it came from, not counts */
+
+typedef struct {
+    int type;
+    int channel;
+    int first_key;                 /* key of bins[0], e.g. CHAR_START */
+    int bin_count;
+    uint64_t *bins;
+} HfSection;
+
+typedef void (*HfSectionHandler)(void *ctx, const HfSection *section);
+
+typedef struct {
+    unsigned char *data;           /* reused file buffer */
+    size_t data_cap;
+    uint64_t *bins;                /* reused decode buffer */
+    int bins_cap;
+} HfReadBuffer;
+
+int hf_encode(const HfSection *sections, int count, unsigned char **out, size_t *out_cap);
+
+int hf_decode(const unsigned char *data, size_t len, HfReadBuffer *rb,
+              HfSectionHandler handler, void *ctx);
+
+int hf_write_file(const char *path, const HfSection *sections, int count);
+
+int hf_read_file(const char *path, HfReadBuffer *rb, HfSectionHandler handler, void *ctx);
+
+void hf_read_buffer_free(HfReadBuffer *rb);
+
+/* Shared with the stream log (stream_log.h) */
+uint32_t hf_crc32(const unsigned char *p, size_t len);
+
+int hf_put_varint(unsigned char *p, uint64_t value);
+
+int hf_get_varint(const unsigned char **p, const unsigned char *end, uint64_t *value);
+
+#endif /* HISTO_FILE_H */
@@ -0,0 +1,45 @@
+/*
+*	FILE:			hyperloglog.h
+*	ASSIGNMENT:	    Histogram System
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This header file defines a HyperLogLog sketch used by DC to estimate
+*                 the number of distinct keys in fixed memory.
+*
+*                 A sketch of precision p keeps 2^p one-byte registers and has a
+*                 relative standard error of about 1.04 / sqrt(2^p) (1.6% at p = 12,
+*                 4 KiB). Two sketches of the same precision merge by taking the
+*                 per-register maximum, so shards and checkpoints can be combined.
+*/
+
+#ifndef HYPERLOGLOG_H
+#define HYPERLOGLOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define HLL_MIN_PRECISION 4
+#define HLL_MAX_PRECISION 16
+
+typedef struct {
+    int precision;
+    int num_registers;             /* 2^precision */
+    uint8_t *registers;
+} HyperLogLog;
+
+int hll_init(HyperLogLog *hll, int precision);
+
+void hll_add(HyperLogLog *hll, uint64_t key);
+
+int hll_merge(HyperLogLog *dst, const HyperLogLog *src);
+
+double hll_estimate(const HyperLogLog *hll);
+
+double hll_relative_error(const HyperLogLog *hll);
+
+int hll_save(const HyperLogLog *hll, const char *path);
+
+int hll_load_merge(HyperLogLog *hll, const char *path);
+
+void hll_free(HyperLogLog *hll);
+
+#endif /* HYPERLOGLOG_H */
@@ -0,0 +1,39 @@
+/*
+*	FILE:			instance.h
+*	ASSIGNMENT:	    Histogram System
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This header file declares the pipeline instance helpers. Every
+*                 process of a pipeline reads the same HISTO_INSTANCE (DP-1 and DP-2
+*                 pass their environment on), and the name decides the semaphore and
+*                 shared memory keys and the default paths of the files it writes.
+*                 Without a name the original SEM_KEY and SHM_KEY are used. DP-1
+*                 writes the name into the segment, so a process whose name hashes
+*                 to another instance's keys finds out before it touches anything.
+*
+*                 Programs are started from the install root: HISTO_HOME, or else
+*                 the directory three levels above the running binary, as in
+*                 <root>/DP-1/bin/dp1.
+*/
+
+#ifndef INSTANCE_H
+#define INSTANCE_H
+
+#include <stddef.h>
+#include <sys/types.h>
+#include "circular_buffer.h"
+
+const char *instance_name(void);
+
+int instance_keys(key_t *sem_key, key_t *shm_key);
+
+int instance_in_use(key_t shm_key);
+
+void instance_stamp(CircularBuffer *cb);
+
+int instance_check(const CircularBuffer *cb, const char *who);
+
+const char *instance_path(const char *path, char *out, size_t size);
+
+int instance_program(const char *program, char *out, size_t size);
+
+#endif /* INSTANCE_H */
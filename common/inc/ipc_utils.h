@@ -20,6 +20,10 @@ int lock_semaphore(int sem_id);
 
 int unlock_semaphore(int sem_id);
 
+int lock_buffer(CircularBuffer *cb, int sem_id);
+
+int unlock_buffer(CircularBuffer *cb, int sem_id);
+
 int remove_semaphore(int sem_id);
 
 int create_shared_memory(key_t shm_key, size_t size);
@@ -0,0 +1,44 @@
+/*
+*	FILE:			live.h
+*	ASSIGNMENT:	    Histogram System
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This header file defines the live histogram DC publishes in the
+*                 shared segment after every drain. It is guarded by a sequence
+*                 counter instead of the semaphore: DC makes the counter odd, writes,
+*                 and makes it even again, and a reader keeps a copy only if the
+*                 counter was even and unchanged around it. DC never waits for a
+*                 reader, and readers never block each other or the producers.
+*/
+
+#ifndef LIVE_H
+#define LIVE_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#define LIVE_MAX_BINS 32
+#define LIVE_READ_TRIES 1000
+
+typedef struct {
+    uint32_t seq;                  /* odd while DC is writing */
+    int32_t first_key;             /* key of counts[0] */
+    uint32_t bin_count;
+    uint32_t reserved;
+    uint64_t updated_us;           /* wall clock of the last publish */
+    uint64_t drains;               /* drains DC has made so far */
+    uint64_t total;
+    uint64_t counts[LIVE_MAX_BINS];
+} __attribute__((aligned(64))) LiveHistogram;
+
+void live_init(LiveHistogram *live);
+
+void live_publish(LiveHistogram *live, int first_key, const uint64_t *counts, int count,
+                  uint64_t drains);
+
+int live_read(const LiveHistogram *live, LiveHistogram *out);
+
+const LiveHistogram *live_attach(key_t shm_key);
+
+void live_detach(const LiveHistogram *live);
+
+#endif /* LIVE_H */
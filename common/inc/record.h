@@ -0,0 +1,99 @@
+/*
+*	FILE:			record.h
+*	ASSIGNMENT:	    Histogram System
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This header file defines the record framing used in the circular
+*                 buffer. Plain symbols are still written as single bytes. Bytes below
+*                 REC_TAG_LIMIT are tags that start a fixed-size record:
+*
+*                   REC_TAG_SAMPLE  tag, 8-byte little-endian unsigned value
+*                   REC_TAG_CHANNEL tag, 2-byte little-endian channel id, 1-byte
+*                                   count, then 'count' symbols for that channel
+*                   REC_TAG_DELTA   tag, 1-byte payload length, then the payload:
+*                                   2-byte little-endian channel id, first key,
+*                                   bin count, and one varint count per bin
+*                   REC_TAG_PACKED  tag, symbol count, bits per symbol, first key,
+*                                   then little-endian 64-bit words, each holding
+*                                   64 / bits symbols as (symbol - first key),
+*                                   lowest bits first
+*
+*                 A packed record carries channel-0 symbols in fewer bytes: with a
+*                 20-symbol alphabet, 5 bits each, 12 to a word, 240 symbols take
+*                 164 bytes instead of 240.
+*                 A delta record carries counts a producer aggregated itself, so DC
+*                 folds it in with one addition per bin however many symbols it
+*                 stands for.
+*                 Plain symbols outside a channel span belong to channel 0.
+*                 A producer always writes a whole record while holding the semaphore,
+*                 but DC may drain only part of it, so decoding is incremental.
+*/
+
+#ifndef RECORD_H
+#define RECORD_H
+
+#include <stdint.h>
+
+#define REC_TAG_LIMIT 0x20
+
+#define REC_TAG_SAMPLE 0x01
+#define REC_TAG_CHANNEL 0x02
+#define REC_TAG_DELTA 0x03
+#define REC_TAG_PACKED 0x04
+
+#define REC_SAMPLE_SIZE 9
+#define REC_CHANNEL_HEADER 4
+#define REC_DELTA_HEADER 6
+#define REC_DELTA_MAX_BINS 32
+#define REC_DELTA_MAX_PAYLOAD 200
+#define REC_DELTA_MAX_SIZE (2 + REC_DELTA_MAX_PAYLOAD)
+#define REC_MAX_PAYLOAD (1 + REC_DELTA_MAX_PAYLOAD)
+
+#define REC_PACKED_HEADER 4
+#define REC_PACKED_MAX_BITS 6
+#define REC_PACKED_MAX_SYMBOLS 240
+
+/* Longest channel span; a span must fit in the ring in one write */
+#define REC_SPAN_MAX 64
+
+typedef struct {
+    void (*on_sample)(void *ctx, uint64_t value);
+    void (*on_span)(void *ctx, int channel, const char *symbols, int count);
+    void (*on_delta)(void *ctx, int channel, int first_key, const uint32_t *bins, int count);
+    void (*on_packed)(void *ctx, int first_key, int bits, const unsigned char *words, int count);
+    void *ctx;
+} RecordSink;
+
+typedef struct {
+    int pending_tag;               /* tag of a partially received record, 0 if none */
+    int have;                      /* payload bytes received so far */
+    unsigned char payload[REC_MAX_PAYLOAD];
+    int span_channel;              /* channel of the span being received */
+    int span_left;                 /* span symbols still to come */
+    int skip_left;                 /* bytes of an oversized delta still to drop */
+} RecordDecoder;
+
+void rec_decoder_init(RecordDecoder *dec);
+
+int rec_decoder_pending(const RecordDecoder *dec);
+
+int rec_decode(RecordDecoder *dec, const char *in, int len, char *symbols, const RecordSink *sink);
+
+int rec_record_size(const char *in, int len);
+
+int rec_whole_prefix(const char *in, int len, int limit);
+
+int rec_encode_sample(char *out, uint64_t value);
+
+int rec_encode_span(char *out, int channel, const char *symbols, int count);
+
+int rec_encode_delta(char *out, int channel, int first_key, const uint32_t *bins, int count);
+
+int rec_packed_bits(int alphabet);
+
+int rec_packed_size(int count, int bits);
+
+int rec_encode_packed(char *out, const char *symbols, int count, int first_key, int bits);
+
+int rec_unpack(const unsigned char *words, int count, int bits, unsigned char *ranks);
+
+#endif /* RECORD_H */
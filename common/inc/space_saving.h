@@ -0,0 +1,49 @@
+/*
+*	FILE:			space_saving.h
+*	ASSIGNMENT:	    Histogram System
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This header file defines a Space-Saving top-K summary used by DC to
+*                 report the heaviest keys in fixed memory.
+*
+*                 The summary monitors 'capacity' keys. With N the total count added:
+*                   - every key whose true count exceeds N / capacity is monitored;
+*                   - a monitored key's count over-estimates its true count by at
+*                     most its 'error' field, and error <= N / capacity.
+*                 Entries live in a min-heap ordered by count, with an open addressing
+*                 index for lookups, so an update is O(log capacity).
+*/
+
+#ifndef SPACE_SAVING_H
+#define SPACE_SAVING_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    uint64_t key;
+    uint64_t count;                /* estimated count (upper bound) */
+    uint64_t error;                /* maximum over-count of 'count' */
+    int heap_pos;
+} SsEntry;
+
+typedef struct {
+    int capacity;
+    int size;
+    uint64_t total;
+    SsEntry *entries;
+    int *heap;                     /* entry indices, min-heap by count */
+    int *slots;                    /* entry index + 1, 0 marks an empty slot */
+    int slot_mask;
+} SpaceSaving;
+
+int ss_init(SpaceSaving *ss, int capacity);
+
+void ss_update(SpaceSaving *ss, uint64_t key, uint64_t count);
+
+int ss_top(const SpaceSaving *ss, SsEntry *out, int max_out);
+
+size_t ss_memory_size(const SpaceSaving *ss);
+
+void ss_free(SpaceSaving *ss);
+
+#endif /* SPACE_SAVING_H */
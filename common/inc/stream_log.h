@@ -0,0 +1,97 @@
+/*
+*	FILE:			stream_log.h
+*	ASSIGNMENT:	    Histogram System
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This header file defines the stream log: the raw bytes DC drained
+*                 from the circular buffer, with the time of every drain, stored in
+*                 segment files "<prefix>.<sequence>.hsl" for later replay.
+*
+*                 Segment layout (integers little-endian unless noted):
+*                   "HSL1"                      magic, 4 bytes
+*                   blocks, each:
+*                     index length, data length, stored length, span count  4 bytes each
+*                     base time in microseconds                             8 bytes
+*                     codec                                                 1 byte
+*                     reserved                                              3 bytes
+*                     CRC-32 of the index XOR CRC-32 of the stored data    4 bytes
+*                     index: per span, varint microseconds since the previous span
+*                            and varint span length
+*                     stored data: the spans' bytes back to back, coded with 'codec'
+*
+*                 SL_CODEC_PACKED stores the block's alphabet (count byte, then the
+*                 bytes in order) followed by each byte's position in it, packed in
+*                 the fewest bits. A block of plain letters from a 20-symbol
+*                 alphabet is stored in 5 bits per byte.
+*/
+
+#ifndef STREAM_LOG_H
+#define STREAM_LOG_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define SL_MAGIC "HSL1"
+#define SL_MAGIC_SIZE 4
+#define SL_BLOCK_HEADER 32
+
+#define SL_CODEC_RAW 0
+#define SL_CODEC_PACKED 1
+
+/* Largest alphabet worth packing (6 bits per byte) */
+#define SL_PACK_MAX_SYMBOLS 64
+
+typedef struct {
+    uint64_t base_us;              /* time of the first span */
+    uint64_t last_us;              /* time of the latest span */
+    uint32_t span_count;
+    unsigned char *index;
+    size_t index_len;
+    size_t index_cap;
+    unsigned char *data;
+    size_t data_len;
+    size_t data_cap;
+} SlBlock;
+
+typedef struct {
+    size_t index_pos;
+    size_t data_pos;
+    uint64_t at_us;
+} SlCursor;
+
+typedef struct {
+    FILE *fp;
+    char prefix[4096];
+    int sequence;
+    uint64_t segment_bytes;
+    uint64_t segment_limit;
+    unsigned char *stored;         /* reused coded-data buffer */
+    size_t stored_cap;
+} SlWriter;
+
+typedef struct {
+    FILE *fp;
+    unsigned char *stored;         /* reused coded-data buffer */
+    size_t stored_cap;
+} SlReader;
+
+int sl_block_init(SlBlock *block, size_t data_cap);
+int sl_block_add(SlBlock *block, uint64_t now_us, const char *span, int len);
+void sl_block_reset(SlBlock *block);
+void sl_block_free(SlBlock *block);
+
+void sl_cursor_init(const SlBlock *block, SlCursor *cursor);
+int sl_block_next_span(const SlBlock *block, SlCursor *cursor, const char **span, int *len);
+
+size_t sl_pack(const unsigned char *in, size_t len, unsigned char *out);
+int sl_unpack(const unsigned char *in, size_t in_len, unsigned char *out, size_t out_len);
+
+int sl_writer_open(SlWriter *writer, const char *prefix, uint64_t segment_limit);
+int sl_writer_write_block(SlWriter *writer, const SlBlock *block);
+void sl_writer_close(SlWriter *writer);
+
+int sl_reader_open(SlReader *reader, const char *path);
+int sl_reader_next(SlReader *reader, SlBlock *block);
+void sl_reader_close(SlReader *reader);
+
+#endif /* STREAM_LOG_H */
@@ -0,0 +1,21 @@
+/*
+*	FILE:			tally.h
+*	ASSIGNMENT:	    Histogram System
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This header file defines DC's counting loops: plain symbols and
+*                 packed records into the CHAR_START..CHAR_END histogram. DC and
+*                 histo-bench both link them, so the benchmark always times the
+*                 loops DC runs.
+*/
+
+#ifndef TALLY_H
+#define TALLY_H
+
+#include <stdint.h>
+
+void tally_symbols(const char *symbols, int n, uint64_t *counts, uint32_t *bins);
+
+int tally_packed(const unsigned char *words, int count, int bits, int first_key,
+                 unsigned char *ranks, uint64_t *counts, uint32_t *bins);
+
+#endif /* TALLY_H */
@@ -0,0 +1,87 @@
+/*
+*	FILE:			trace.h
+*	ASSIGNMENT:	    Histogram System
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This header file defines the binary event tracer. Each process that
+*                 enables tracing maps its own ring of fixed-size events in
+*                 HISTO_TRACE_DIR (default /dev/shm), named histo-trace.<pid>. Events
+*                 carry a TSC timestamp and are written without locking or allocation;
+*                 the oldest events are overwritten when the ring wraps. trace-export
+*                 merges the rings of all processes into Chrome trace-event JSON.
+*
+*                 Trace points compile to nothing when HISTO_NO_TRACE is defined, and
+*                 otherwise cost one predictable branch while tracing is switched off
+*                 (HISTO_TRACE=1 switches it on at start-up).
+*/
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+
+#define TRACE_MAGIC 0x31435254u          /* "TRC1" */
+#define TRACE_NAME_LEN 16
+#define TRACE_DEFAULT_CAPACITY 65536     /* events, power of two */
+#define TRACE_FILE_PREFIX "histo-trace."
+
+#define TRACE_PHASE_BEGIN 'B'
+#define TRACE_PHASE_END 'E'
+#define TRACE_PHASE_INSTANT 'i'
+
+enum {
+    TRACE_LOCK_WAIT = 0,           /* blocked in lock_semaphore */
+    TRACE_LOCK_HELD,               /* between lock_semaphore and unlock_semaphore */
+    TRACE_WRITE,                   /* producer writing to the ring, arg = bytes */
+    TRACE_RING_FULL,               /* producer found no space, arg = bytes not written */
+    TRACE_READ,                    /* DC draining the ring, arg = bytes */
+    TRACE_RENDER,                  /* DC drawing the histogram */
+    TRACE_EVENT_COUNT
+};
+
+typedef struct {
+    uint64_t tsc;
+    uint32_t arg;
+    uint16_t id;
+    uint8_t phase;
+    uint8_t reserved;
+} TraceEvent;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t pid;
+    char name[TRACE_NAME_LEN];
+    uint32_t capacity;
+    uint32_t reserved;
+    uint64_t base_tsc;             /* TSC and wall clock sampled together at start-up */
+    uint64_t base_ns;
+    double tsc_per_ns;
+    uint64_t position;             /* total events ever written */
+    TraceEvent events[];
+} TraceRing;
+
+extern int trace_enabled;
+
+int trace_init(const char *name);
+
+int trace_set_enabled(int enabled);
+
+void trace_emit(int id, int phase, uint32_t arg);
+
+const char *trace_event_name(int id);
+
+void trace_close(void);
+
+#ifndef HISTO_NO_TRACE
+#define TRACE_BEGIN(id) \
+    do { if (trace_enabled) trace_emit((id), TRACE_PHASE_BEGIN, 0); } while (0)
+#define TRACE_END(id, arg) \
+    do { if (trace_enabled) trace_emit((id), TRACE_PHASE_END, (uint32_t)(arg)); } while (0)
+#define TRACE_INSTANT(id, arg) \
+    do { if (trace_enabled) trace_emit((id), TRACE_PHASE_INSTANT, (uint32_t)(arg)); } while (0)
+#else
+#define TRACE_BEGIN(id) ((void)0)
+#define TRACE_END(id, arg) ((void)0)
+#define TRACE_INSTANT(id, arg) ((void)0)
+#endif
+
+#endif /* TRACE_H */
@@ -0,0 +1,108 @@
+/*
+*	FILE:			tseries.h
+*	ASSIGNMENT:	    Histogram System
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This header file defines the histogram time series: one record per
+*                 interval, appended to memory-mapped segment files
+*                 "<prefix>.L<level>.<sequence>.hts". Level 0 holds the intervals as
+*                 DC closes them. Level 1 holds one record per hour and level 2 one
+*                 per day (UTC), each the sum of the level below. A range query
+*                 takes whole days from level 2 and whole hours from level 1, and
+*                 only reads level 0 at the ragged ends. Periods without counts have
+*                 no record.
+*
+*                 Segment layout (host byte order, fixed size):
+*                   TsHeader, TS_HEADER_SIZE bytes, ending in the sparse index: the
+*                     start time and offset of every TS_INDEX_STRIDE-th record
+*                   data area, records back to back, each:
+*                     start time in seconds since the epoch   8 bytes
+*                     payload length                          2 bytes
+*                     first key, bin count                    1 byte each
+*                     reserved                                4 bytes
+*                     payload: one varint count per bin
+*
+*                 Records are in start order. data_used is published after the
+*                 record and its index entry, so readers may map a segment that DC
+*                 is still appending to. covered_until on the newest segment of a
+*                 rollup level is the end of the last period rolled up, empty or
+*                 not; queries do not use the level past it.
+*/
+
+#ifndef TSERIES_H
+#define TSERIES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define TS_MAGIC "HTS1"
+#define TS_MAGIC_SIZE 4
+#define TS_LEVELS 3
+#define TS_HEADER_SIZE 16384
+#define TS_HEADER_FIXED 64
+#define TS_INDEX_MAX ((TS_HEADER_SIZE - TS_HEADER_FIXED) / 16)
+#define TS_INDEX_STRIDE 64
+#define TS_MAX_BINS 32
+#define TS_RECORD_HEADER 16
+#define TS_RECORD_MAX (TS_RECORD_HEADER + TS_MAX_BINS * 10)
+
+typedef struct {
+    uint64_t start_s;
+    uint32_t offset;               /* into the data area */
+    uint32_t reserved;
+} TsIndexEntry;
+
+typedef struct {
+    char magic[TS_MAGIC_SIZE];
+    uint32_t level;
+    uint32_t span_s;               /* seconds per record; the interval at level 0 */
+    uint32_t index_count;
+    uint64_t record_count;
+    uint64_t data_size;            /* capacity of the data area */
+    uint64_t data_used;            /* bytes of whole records */
+    uint64_t first_s;              /* start of the oldest record */
+    uint64_t last_s;               /* start of the newest record */
+    uint64_t covered_until;
+    TsIndexEntry index[TS_INDEX_MAX];
+} TsHeader;
+
+typedef struct {
+    uint64_t start_s;
+    int first_key;
+    int bin_count;
+    uint64_t counts[TS_MAX_BINS];
+} TsRecord;
+
+typedef struct {
+    uint64_t segments;             /* segment files mapped */
+    uint64_t records;              /* records read */
+} TsStats;
+
+typedef struct {
+    char prefix[4096];
+    int level;
+    int sequence;                  /* of the mapped segment */
+    uint32_t span_s;
+    uint64_t data_size;
+    TsHeader *header;
+    unsigned char *data;
+    size_t map_size;
+} TsWriter;
+
+/* Called for each record of a scan; returning -1 stops it */
+typedef int (*TsVisit)(void *ctx, const TsRecord *record);
+
+uint32_t ts_level_span(int level);
+
+int ts_writer_open(TsWriter *writer, const char *prefix, int level, uint32_t span_s,
+                   uint64_t data_size);
+int ts_writer_append(TsWriter *writer, const TsRecord *record);
+void ts_writer_close(TsWriter *writer);
+
+int ts_scan(const char *prefix, int level, uint64_t from_s, uint64_t to_s, TsVisit visit,
+            void *ctx, TsStats *stats);
+uint64_t ts_covered_until(const char *prefix, int level);
+int ts_rollup(TsWriter *upper, const char *prefix, uint64_t until_s);
+int ts_sum(const char *prefix, uint64_t from_s, uint64_t to_s, uint64_t counts[256],
+           TsStats *stats);
+
+#endif /* TSERIES_H */
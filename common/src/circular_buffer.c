@@ -14,7 +14,8 @@
 //Returns:        int                     Returns 0 on success, -1 on failure.     |
 //Outputs:        NONE                                                              |
 //Description:    This function initializes the circular buffer by setting the read and write |
-//                indices to 0 and clearing the buffer.                               |
+//                indices to 0 and clearing the buffer, the control queue and the    |
+//                live histogram, the lock owner, and releasing every consumer slot. |
 //==================================================================================|
 int cb_init(CircularBuffer *cb) {
     if (!cb) {
@@ -24,6 +25,15 @@ int cb_init(CircularBuffer *cb) {
     cb->read_index = 0;
     cb->write_index = 0;
     memset(cb->buffer, 0, BUFFER_SIZE);
+    ctl_init(&cb->control);
+    live_init(&cb->live);
+    cb->write_seq = 0;
+    memset(cb->consumers, 0, sizeof(cb->consumers));
+    memset(cb->instance, 0, sizeof(cb->instance));
+    cb->lock_owner = 0;
+    cb->lock_dead_owner = 0;
+    cb->lock_recoveries = 0;
+    cb->magic = CB_MAGIC;
     
     return 0;
 }
@@ -42,40 +52,50 @@ int cb_write_char(CircularBuffer *cb, char c) {
         return -1;
     }
     
-    if ((cb->write_index + 1) % BUFFER_SIZE == cb->read_index) {
-        return -1; 
-    }
-    
-    cb->buffer[cb->write_index] = c;
-    cb->write_index = (cb->write_index + 1) % BUFFER_SIZE;
-    
-    return 0;
+    return (cb_write_multi(cb, &c, 1) == 1) ? 0 : -1;
 }
 
 //==================================================FUNCTION========================|
-//Name:           cb_read_char                                                       |
-//Params:         CircularBuffer* cb      A pointer to the circular buffer to read from. |
-//                char* c                 A pointer to store the read character.      |
-//Returns:        int                     Returns 0 on success, -1 if buffer is empty. |
+//Name:           cb_write_multi                                                     |
+//Params:         CircularBuffer* cb      A pointer to the circular buffer to write to. |
+//                const char* data        The characters to write.                    |
+//                size_t len              The number of characters in 'data'.         |
+//Returns:        int                     The number of characters written.           |
 //Outputs:        NONE                                                              |
-//Description:    This function reads a single character from the circular buffer. If the buffer is empty, |
-//                it returns -1. Otherwise, it reads the character and updates the read index. |
+//Description:    This function writes as many characters as fit into the circular buffer. |
+//                They are copied in at most two blocks, split where the buffer wraps. |
 //==================================================================================|
 int cb_write_multi(CircularBuffer *cb, const char *data, size_t len) {
+    size_t free_space;
+    size_t first;
+    int i;
+
     if (!cb || !data) {
         return -1;
     }
     
-    int written = 0;
-    for (size_t i = 0; i < len; i++) {
-        if (cb_write_char(cb, data[i]) == 0) {
-            written++;
-        } else {
-            break;  /* Buffer full */
+    free_space = (size_t)cb_get_free_space(cb);
+    if (len > free_space) {
+        len = free_space;  /* Buffer full */
+    }
+
+    for (i = 0; i < CB_MAX_CONSUMERS; i++) {
+        if (cb->consumers[i].state == CB_CONSUMER_DROP &&
+            cb->write_seq + len - cb->consumers[i].cursor > BUFFER_SIZE - 1) {
+            cb->consumers[i].state = CB_CONSUMER_DROPPED;
         }
     }
+
+    first = BUFFER_SIZE - (size_t)cb->write_index;
+    if (first > len) {
+        first = len;
+    }
+    memcpy(cb->buffer + cb->write_index, data, first);
+    memcpy(cb->buffer, data + first, len - first);
+    cb->write_index = (int)((cb->write_index + len) % BUFFER_SIZE);
+    cb->write_seq += len;
     
-    return written;
+    return (int)len;
 }
 
 
@@ -111,22 +131,30 @@ int cb_read_char(CircularBuffer *cb, char *c) {
 //Outputs:        NONE                                                              |
 //Description:    This function reads multiple characters from the circular buffer. It returns the 
 //                number of successfully read characters, stopping if the buffer is empty. |
+//                The characters are copied in at most two blocks.                   |
 //==================================================================================|
 int cb_read_multi(CircularBuffer *cb, char *buf, size_t max_len) {
+    size_t available;
+    size_t first;
+
     if (!cb || !buf) {
         return -1;
     }
     
-    int read = 0;
-    for (size_t i = 0; i < max_len; i++) {
-        if (cb_read_char(cb, &buf[i]) == 0) {
-            read++;
-        } else {
-            break;  
-        }
+    available = (size_t)cb_get_available(cb);
+    if (max_len > available) {
+        max_len = available;
+    }
+
+    first = BUFFER_SIZE - (size_t)cb->read_index;
+    if (first > max_len) {
+        first = max_len;
     }
+    memcpy(buf, cb->buffer + cb->read_index, first);
+    memcpy(buf + first, cb->buffer, max_len - first);
+    cb->read_index = (int)((cb->read_index + max_len) % BUFFER_SIZE);
     
-    return read;
+    return (int)max_len;
 }
 
 //==================================================FUNCTION========================|
@@ -158,9 +186,199 @@ int cb_get_available(const CircularBuffer *cb) {
 //                i.e., the number of characters that can still be written. |
 //==================================================================================|
 int cb_get_free_space(const CircularBuffer *cb) {
+    uint64_t lag;
+    int used;
+    int i;
+
     if (!cb) {
         return -1;
     }
     
-    return BUFFER_SIZE - cb_get_available(cb) - 1;
+    used = cb_get_available(cb);
+    for (i = 0; i < CB_MAX_CONSUMERS; i++) {
+        if (cb->consumers[i].state == CB_CONSUMER_GATE) {
+            lag = cb->write_seq - cb->consumers[i].cursor;
+            if (lag > (uint64_t)used) {
+                used = (int)lag;
+            }
+        }
+    }
+
+    return BUFFER_SIZE - used - 1;
+}
+
+//==================================================FUNCTION========================|
+//Name:           cb_consumer_register                                               |
+//Params:         CircularBuffer* cb      The circular buffer.                       |
+//                int policy              CB_CONSUMER_GATE or CB_CONSUMER_DROP.      |
+//                pid_t pid               The consumer's process id.                 |
+//Returns:        int                     The consumer's slot, or -1 if none is free.|
+//Outputs:        NONE                                                              |
+//Description:    This function registers a consumer. It starts at the current      |
+//                write position, which is always a record boundary because         |
+//                producers write whole records under the semaphore.                 |
+//==================================================================================|
+int cb_consumer_register(CircularBuffer *cb, int policy, pid_t pid) {
+    int i;
+
+    if (!cb || (policy != CB_CONSUMER_GATE && policy != CB_CONSUMER_DROP)) {
+        return -1;
+    }
+
+    for (i = 0; i < CB_MAX_CONSUMERS; i++) {
+        if (cb->consumers[i].state == CB_CONSUMER_FREE) {
+            cb->consumers[i].state = policy;
+            cb->consumers[i].pid = pid;
+            cb->consumers[i].cursor = cb->write_seq;
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+//==================================================FUNCTION========================|
+//Name:           cb_consumer_release                                                |
+//Params:         CircularBuffer* cb      The circular buffer.                       |
+//                int slot                A slot from cb_consumer_register.          |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function frees a consumer slot, releasing the producers if   |
+//                the consumer was gating them.                                      |
+//==================================================================================|
+void cb_consumer_release(CircularBuffer *cb, int slot) {
+    if (cb && slot >= 0 && slot < CB_MAX_CONSUMERS) {
+        cb->consumers[slot].state = CB_CONSUMER_FREE;
+        cb->consumers[slot].pid = 0;
+    }
+}
+
+//==================================================FUNCTION========================|
+//Name:           cb_consumer_read                                                   |
+//Params:         CircularBuffer* cb      The circular buffer.                       |
+//                int slot                The consumer's slot.                       |
+//                char* buf               Receives the bytes.                        |
+//                size_t max_len          The most bytes to read.                    |
+//Returns:        int                     Bytes read, or -1 if the consumer was      |
+//                                        dropped for falling behind.                |
+//Outputs:        NONE                                                              |
+//Description:    This function reads the consumer's next bytes and moves only its  |
+//                own cursor, so the other consumers still see them.                 |
+//==================================================================================|
+int cb_consumer_read(CircularBuffer *cb, int slot, char *buf, size_t max_len) {
+    CbConsumer *consumer;
+    size_t available;
+    size_t position;
+    size_t first;
+
+    if (!cb || !buf || slot < 0 || slot >= CB_MAX_CONSUMERS) {
+        return -1;
+    }
+    consumer = &cb->consumers[slot];
+    if (consumer->state != CB_CONSUMER_GATE && consumer->state != CB_CONSUMER_DROP) {
+        return -1;
+    }
+
+    available = (size_t)(cb->write_seq - consumer->cursor);
+    if (max_len > available) {
+        max_len = available;
+    }
+
+    position = (size_t)(consumer->cursor % BUFFER_SIZE);
+    first = BUFFER_SIZE - position;
+    if (first > max_len) {
+        first = max_len;
+    }
+    memcpy(buf, cb->buffer + position, first);
+    memcpy(buf + first, cb->buffer, max_len - first);
+    consumer->cursor += max_len;
+
+    return (int)max_len;
+}
+
+//==================================================FUNCTION========================|
+//Name:           cb_consumer_reap                                                   |
+//Params:         CircularBuffer* cb      The circular buffer.                       |
+//Returns:        int                     Number of slots freed.                     |
+//Outputs:        NONE                                                              |
+//Description:    This function frees the slots of consumers that exited without     |
+//                releasing them, so a crashed gating consumer does not stall the    |
+//                producers for good.                                                |
+//==================================================================================|
+int cb_consumer_reap(CircularBuffer *cb) {
+    int freed = 0;
+    int i;
+
+    if (!cb) {
+        return 0;
+    }
+
+    for (i = 0; i < CB_MAX_CONSUMERS; i++) {
+        if (cb->consumers[i].state != CB_CONSUMER_FREE &&
+            kill(cb->consumers[i].pid, 0) == -1 && errno == ESRCH) {
+            cb_consumer_release(cb, i);
+            freed++;
+        }
+    }
+
+    return freed;
+}
+
+//==================================================FUNCTION========================|
+//Name:           cb_repair                                                          |
+//Params:         CircularBuffer* cb      The circular buffer.                       |
+//Returns:        int                     Number of fields that had to be fixed.     |
+//Outputs:        NONE                                                              |
+//Description:    This function brings the ring back to a consistent state after a   |
+//                holder of the semaphore died part way through an operation. Data  |
+//                is copied in before write_index moves, so a writer that died      |
+//                before that store wrote nothing. One that died between it and     |
+//                write_seq has published its bytes, and write_seq catches up to    |
+//                it. Indices out of range are reset (unread bytes are dropped), and |
+//                cursors are kept within one buffer behind write_seq. The caller   |
+//                holds the semaphore.                                              |
+//==================================================================================|
+int cb_repair(CircularBuffer *cb) {
+    CbConsumer *consumer;
+    uint64_t lag;
+    int fixed = 0;
+    int i;
+
+    if (!cb) {
+        return 0;
+    }
+
+    if (cb->write_index < 0 || cb->write_index >= BUFFER_SIZE) {
+        cb->write_index = (int)(cb->write_seq % BUFFER_SIZE);
+        fixed++;
+    }
+    if ((int)(cb->write_seq % BUFFER_SIZE) != cb->write_index) {
+        cb->write_seq += (uint64_t)((cb->write_index - (int)(cb->write_seq % BUFFER_SIZE) +
+                                     BUFFER_SIZE) % BUFFER_SIZE);
+        fixed++;
+    }
+    if (cb->read_index < 0 || cb->read_index >= BUFFER_SIZE) {
+        cb->read_index = cb->write_index;
+        fixed++;
+    }
+
+    for (i = 0; i < CB_MAX_CONSUMERS; i++) {
+        consumer = &cb->consumers[i];
+        if (consumer->state == CB_CONSUMER_FREE) {
+            continue;
+        }
+        if (consumer->state != CB_CONSUMER_GATE && consumer->state != CB_CONSUMER_DROP &&
+            consumer->state != CB_CONSUMER_DROPPED) {
+            cb_consumer_release(cb, i);
+            fixed++;
+            continue;
+        }
+        lag = cb->write_seq - consumer->cursor;
+        if (consumer->cursor > cb->write_seq || lag > BUFFER_SIZE - 1) {
+            consumer->cursor = cb->write_seq - (uint64_t)cb_get_available(cb);
+            fixed++;
+        }
+    }
+
+    return fixed;
 }
@@ -0,0 +1,91 @@
+/*
+*	FILE:			config.c
+*	ASSIGNMENT:	    Histogram System
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This file implements the start-up configuration helpers. Values are
+*                 read from the environment and fall back to the given default when the
+*                 variable is unset or cannot be parsed.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <limits.h>
+#include "../inc/config.h"
+
+//==================================================FUNCTION========================|
+//Name:           config_get_int                                                     |
+//Params:         const char* name        Name of the environment variable.          |
+//                int default_value       Value used if the variable is missing.     |
+//Returns:        int                     The configured value.                      |
+//Outputs:        NONE                                                              |
+//Description:    This function reads an integer option from the environment. Values |
+//                that are empty or contain trailing garbage are ignored; values     |
+//                outside the range of an int are ignored with a message.            |
+//==================================================================================|
+int config_get_int(const char *name, int default_value) {
+    const char *value;
+    char *end;
+    long parsed;
+
+    value = getenv(name);
+    if (value == NULL || *value == '\0') {
+        return default_value;
+    }
+
+    errno = 0;
+    parsed = strtol(value, &end, 0);
+    if (*end != '\0') {
+        return default_value;
+    }
+    if (errno == ERANGE || parsed < INT_MIN || parsed > INT_MAX) {
+        fprintf(stderr, "%s=%s is out of range, using %d\n", name, value, default_value);
+        return default_value;
+    }
+
+    return (int)parsed;
+}
+
+//==================================================FUNCTION========================|
+//Name:           config_get_double                                                  |
+//Params:         const char* name        Name of the environment variable.          |
+//                double default_value    Value used if the variable is missing.     |
+//Returns:        double                  The configured value.                      |
+//Outputs:        NONE                                                              |
+//Description:    This function reads a floating point option from the environment. |
+//==================================================================================|
+double config_get_double(const char *name, double default_value) {
+    const char *value;
+    char *end;
+    double parsed;
+
+    value = getenv(name);
+    if (value == NULL || *value == '\0') {
+        return default_value;
+    }
+
+    parsed = strtod(value, &end);
+    if (*end != '\0') {
+        return default_value;
+    }
+
+    return parsed;
+}
+
+//==================================================FUNCTION========================|
+//Name:           config_get_str                                                     |
+//Params:         const char* name        Name of the environment variable.          |
+//                const char* default_value  Value used if the variable is missing.  |
+//Returns:        const char*             The configured value.                      |
+//Outputs:        NONE                                                              |
+//Description:    This function reads a string option from the environment.         |
+//==================================================================================|
+const char *config_get_str(const char *name, const char *default_value) {
+    const char *value;
+
+    value = getenv(name);
+    if (value == NULL || *value == '\0') {
+        return default_value;
+    }
+
+    return value;
+}
@@ -0,0 +1,174 @@
+/*
+*	FILE:			control.c
+*	ASSIGNMENT:	    Histogram System
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This file implements the shared control queue described in
+*                 control.h.
+*/
+#include <string.h>
+#include "../inc/control.h"
+
+static const char *op_names[CTL_OP_COUNT] = {
+    NULL, "sleep-us", "batch", "overload", "trace", "display-interval", "read-bytes",
+    "read-interval"
+};
+
+//==================================================FUNCTION========================|
+//Name:           ctl_init                                                           |
+//Params:         ControlQueue* queue     The queue to clear.                        |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function empties the queue when the segment is created.       |
+//==================================================================================|
+void ctl_init(ControlQueue *queue) {
+    memset(queue->commands, 0, sizeof(queue->commands));
+    __atomic_store_n(&queue->seq, 0, __ATOMIC_RELEASE);
+}
+
+//==================================================FUNCTION========================|
+//Name:           ctl_cursor                                                         |
+//Params:         const ControlQueue* queue  The queue.                              |
+//Returns:        uint32_t                A cursor past every command posted so far. |
+//Outputs:        NONE                                                              |
+//Description:    This function gives a starting process its cursor, so it does not  |
+//                re-apply commands meant for the processes it replaces.             |
+//==================================================================================|
+uint32_t ctl_cursor(const ControlQueue *queue) {
+    return __atomic_load_n(&queue->seq, __ATOMIC_ACQUIRE);
+}
+
+//==================================================FUNCTION========================|
+//Name:           ctl_post                                                           |
+//Params:         ControlQueue* queue     The queue.                                 |
+//                uint32_t target         CTL_DP1, CTL_DP2, CTL_DC or a combination. |
+//                uint32_t op             A CTL_OP_* setting.                        |
+//                int64_t value           The new value.                             |
+//Returns:        int                     Returns 0 on success, -1 for a bad op.     |
+//Outputs:        NONE                                                              |
+//Description:    This function appends a command. The caller holds the semaphore,   |
+//                so posters never race; the sequence number is published last, so  |
+//                readers never see a half-written command. The fence keeps the      |
+//                slot from being rewritten before a reader can tell, from the       |
+//                sequence number, that it is being reused.                          |
+//==================================================================================|
+int ctl_post(ControlQueue *queue, uint32_t target, uint32_t op, int64_t value) {
+    uint32_t seq;
+    ControlCommand *slot;
+
+    if (op == 0 || op >= CTL_OP_COUNT) {
+        return -1;
+    }
+
+    seq = __atomic_load_n(&queue->seq, __ATOMIC_RELAXED);
+    slot = &queue->commands[seq % CTL_QUEUE_SIZE];
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&slot->target, target, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->op, op, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->value, value, __ATOMIC_RELAXED);
+    __atomic_store_n(&queue->seq, seq + 1, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           ctl_poll                                                           |
+//Params:         const ControlQueue* queue  The queue.                              |
+//                uint32_t* cursor        This process's position, advanced.         |
+//                uint32_t self           This process's CTL_* target bit.           |
+//                ControlHandler handler  Called for each command addressed to it.   |
+//                void* ctx               Passed to the handler.                     |
+//Returns:        int                     Number of commands applied.                |
+//Outputs:        NONE                                                              |
+//Description:    This function applies the commands posted since the last poll. It  |
+//                costs one atomic load when there are none, so loops can call it    |
+//                every iteration. Slots are copied without the semaphore, so the    |
+//                sequence number is read again after each copy; a command whose     |
+//                slot was reused meanwhile is skipped, like one overwritten before  |
+//                the poll.                                                          |
+//==================================================================================|
+int ctl_poll(const ControlQueue *queue, uint32_t *cursor, uint32_t self,
+             ControlHandler handler, void *ctx) {
+    uint32_t seq = __atomic_load_n(&queue->seq, __ATOMIC_ACQUIRE);
+    const ControlCommand *slot;
+    ControlCommand command;
+    int applied = 0;
+
+    if (seq - *cursor > CTL_QUEUE_SIZE) {
+        *cursor = seq - CTL_QUEUE_SIZE;
+    }
+
+    while (*cursor != seq) {
+        slot = &queue->commands[*cursor % CTL_QUEUE_SIZE];
+        command.target = __atomic_load_n(&slot->target, __ATOMIC_RELAXED);
+        command.op = __atomic_load_n(&slot->op, __ATOMIC_RELAXED);
+        command.value = __atomic_load_n(&slot->value, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&queue->seq, __ATOMIC_RELAXED) - *cursor >= CTL_QUEUE_SIZE) {
+            (*cursor)++;
+            continue;
+        }
+        (*cursor)++;
+        if (command.target & self) {
+            handler(ctx, &command);
+            applied++;
+        }
+    }
+
+    return applied;
+}
+
+//==================================================FUNCTION========================|
+//Name:           ctl_op_targets                                                     |
+//Params:         uint32_t op             A CTL_OP_* setting.                        |
+//Returns:        uint32_t                CTL_* mask of the processes that apply it, |
+//                                        0 for an unknown op.                       |
+//Outputs:        NONE                                                              |
+//Description:    This function lets histo-ctl refuse a command nobody it addresses  |
+//                would apply, such as a batch size sent to DC.                      |
+//==================================================================================|
+uint32_t ctl_op_targets(uint32_t op) {
+    switch (op) {
+    case CTL_OP_SLEEP_US:
+    case CTL_OP_BATCH:
+    case CTL_OP_OVERLOAD:
+        return CTL_PRODUCERS;
+    case CTL_OP_TRACE:
+        return CTL_ALL;
+    case CTL_OP_DISPLAY_INTERVAL:
+    case CTL_OP_READ_BYTES:
+    case CTL_OP_READ_INTERVAL:
+        return CTL_DC;
+    default:
+        return 0;
+    }
+}
+
+//==================================================FUNCTION========================|
+//Name:           ctl_op_name                                                        |
+//Params:         uint32_t op             A CTL_OP_* setting.                        |
+//Returns:        const char*             Its command-line name, or "?".             |
+//Outputs:        NONE                                                              |
+//Description:    This function names a setting for histo-ctl.                       |
+//==================================================================================|
+const char *ctl_op_name(uint32_t op) {
+    return (op > 0 && op < CTL_OP_COUNT) ? op_names[op] : "?";
+}
+
+//==================================================FUNCTION========================|
+//Name:           ctl_op_from_name                                                   |
+//Params:         const char* name        A command-line setting name.               |
+//Returns:        int                     The CTL_OP_* value, or -1 if unknown.      |
+//Outputs:        NONE                                                              |
+//Description:    This function parses a setting name for histo-ctl.                 |
+//==================================================================================|
+int ctl_op_from_name(const char *name) {
+    int op;
+
+    for (op = 1; op < CTL_OP_COUNT; op++) {
+        if (strcmp(op_names[op], name) == 0) {
+            return op;
+        }
+    }
+
+    return -1;
+}
@@ -0,0 +1,143 @@
+/*
+*	FILE:			count_min.c
+*	ASSIGNMENT:	    Histogram System
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This file implements the Count-Min sketch. The row positions of a
+*                 key are derived from a single 64-bit hash (h1 + i * h2), so an update
+*                 costs one hash plus 'depth' counter increments.
+*/
+#include <stdlib.h>
+#include <string.h>
+#include "../inc/count_min.h"
+#include "../inc/hash_utils.h"
+
+#define CMS_ALIGNMENT 64
+
+//==================================================FUNCTION========================|
+//Name:           cms_init                                                           |
+//Params:         CountMinSketch* cms     The sketch to initialize.                  |
+//                int width               Counters per row, at most CMS_MAX_WIDTH    |
+//                                        (rounded up to a power of 2).              |
+//                int depth               Number of rows, at most CMS_MAX_DEPTH.     |
+//Returns:        int                     Returns 0 on success, -1 on failure.       |
+//Outputs:        NONE                                                              |
+//Description:    This function allocates the counter table once; the sketch never   |
+//                grows afterwards.                                                  |
+//==================================================================================|
+int cms_init(CountMinSketch *cms, int width, int depth) {
+    size_t bytes;
+    int w = 1;
+
+    if (!cms || width <= 0 || width > CMS_MAX_WIDTH || depth <= 0 || depth > CMS_MAX_DEPTH) {
+        return -1;
+    }
+
+    while (w < width) {
+        w <<= 1;
+    }
+
+    cms->width = w;
+    cms->depth = depth;
+    cms->total = 0;
+
+    bytes = (size_t)w * (size_t)depth * sizeof(uint32_t);
+    bytes = (bytes + CMS_ALIGNMENT - 1) & ~(size_t)(CMS_ALIGNMENT - 1);
+    cms->table = aligned_alloc(CMS_ALIGNMENT, bytes);
+    if (cms->table == NULL) {
+        return -1;
+    }
+    memset(cms->table, 0, bytes);
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           cms_update                                                         |
+//Params:         CountMinSketch* cms     The sketch to update.                      |
+//                uint64_t key            The key being counted.                     |
+//                uint32_t count          How many occurrences to add.               |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function adds 'count' to one counter in every row.            |
+//==================================================================================|
+void cms_update(CountMinSketch *cms, uint64_t key, uint32_t count) {
+    uint64_t h = hash_u64(key);
+    uint32_t h1 = (uint32_t)h;
+    uint32_t h2 = (uint32_t)(h >> 32) | 1;
+    uint32_t mask = (uint32_t)cms->width - 1;
+    uint32_t *row = cms->table;
+    int i;
+
+    for (i = 0; i < cms->depth; i++) {
+        row[(h1 + (uint32_t)i * h2) & mask] += count;
+        row += cms->width;
+    }
+    cms->total += count;
+}
+
+//==================================================FUNCTION========================|
+//Name:           cms_estimate                                                       |
+//Params:         const CountMinSketch* cms  The sketch to query.                    |
+//                uint64_t key            The key to look up.                        |
+//Returns:        uint32_t                The estimated count (never an under-count). |
+//Outputs:        NONE                                                              |
+//Description:    This function returns the minimum of the key's counters.           |
+//==================================================================================|
+uint32_t cms_estimate(const CountMinSketch *cms, uint64_t key) {
+    uint64_t h = hash_u64(key);
+    uint32_t h1 = (uint32_t)h;
+    uint32_t h2 = (uint32_t)(h >> 32) | 1;
+    uint32_t mask = (uint32_t)cms->width - 1;
+    const uint32_t *row = cms->table;
+    uint32_t best = UINT32_MAX;
+    uint32_t value;
+    int i;
+
+    for (i = 0; i < cms->depth; i++) {
+        value = row[(h1 + (uint32_t)i * h2) & mask];
+        if (value < best) {
+            best = value;
+        }
+        row += cms->width;
+    }
+
+    return best;
+}
+
+//==================================================FUNCTION========================|
+//Name:           cms_error_bound                                                    |
+//Params:         const CountMinSketch* cms  The sketch to query.                    |
+//Returns:        uint64_t                The additive error bound e/width * N.      |
+//Outputs:        NONE                                                              |
+//Description:    This function returns the over-count that estimates stay within   |
+//                with probability 1 - e^-depth.                                     |
+//==================================================================================|
+uint64_t cms_error_bound(const CountMinSketch *cms) {
+    /* e ~= 2.71828, kept in integer math as 271828 / 100000 */
+    return (cms->total * 271828ULL) / (100000ULL * (uint64_t)cms->width);
+}
+
+//==================================================FUNCTION========================|
+//Name:           cms_memory_size                                                    |
+//Params:         const CountMinSketch* cms  The sketch to query.                    |
+//Returns:        size_t                  Bytes used by the counter table.           |
+//Outputs:        NONE                                                              |
+//Description:    This function reports the fixed memory footprint of the sketch.    |
+//==================================================================================|
+size_t cms_memory_size(const CountMinSketch *cms) {
+    return (size_t)cms->width * (size_t)cms->depth * sizeof(uint32_t);
+}
+
+//==================================================FUNCTION========================|
+//Name:           cms_free                                                           |
+//Params:         CountMinSketch* cms     The sketch to release.                     |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function frees the counter table.                             |
+//==================================================================================|
+void cms_free(CountMinSketch *cms) {
+    if (cms && cms->table) {
+        free(cms->table);
+        cms->table = NULL;
+    }
+}
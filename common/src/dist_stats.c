@@ -0,0 +1,187 @@
+/*
+*	FILE:			dist_stats.c
+*	ASSIGNMENT:	    Histogram System
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This file implements the running histogram statistics: the
+*                 entropy and chi-square sums move by one term when a bin grows, and
+*                 the smallest bin is only searched for again when the last bin
+*                 holding the minimum grows.
+*/
+#include <string.h>
+#include <math.h>
+#include "../inc/dist_stats.h"
+
+//==================================================FUNCTION========================|
+//Name:           dist_n_ln_n                                                        |
+//Params:         uint64_t n              A bin count.                               |
+//Returns:        long double             n ln n, 0 for n = 0.                       |
+//Outputs:        NONE                                                              |
+//Description:    This function computes one term of the entropy sum.                |
+//==================================================================================|
+static long double dist_n_ln_n(uint64_t n) {
+    return (n > 1) ? (long double)n * logl((long double)n) : 0.0L;
+}
+
+//==================================================FUNCTION========================|
+//Name:           dist_init                                                          |
+//Params:         DistStats* d            Statistics to set up.                      |
+//                const double* weights   Expected relative weight of each bin       |
+//                                        (>= 0), or NULL for uniform.               |
+//                int bins                Number of bins (1..DIST_MAX_BINS).         |
+//Returns:        int                     Returns 0 on success, -1 on failure.       |
+//Outputs:        NONE                                                              |
+//Description:    This function starts the statistics with every bin at 0.          |
+//==================================================================================|
+int dist_init(DistStats *d, const double *weights, int bins) {
+    double sum = 0.0;
+    int i;
+
+    if (!d || bins < 1 || bins > DIST_MAX_BINS) {
+        return -1;
+    }
+
+    memset(d, 0, sizeof(*d));
+    for (i = 0; i < bins; i++) {
+        if (weights != NULL && weights[i] < 0.0) {
+            return -1;
+        }
+        sum += (weights != NULL) ? weights[i] : 1.0;
+    }
+    if (sum <= 0.0) {
+        return -1;
+    }
+    for (i = 0; i < bins; i++) {
+        d->expected[i] = ((weights != NULL) ? weights[i] : 1.0) / sum;
+    }
+    d->bins = bins;
+    d->min_ties = bins;
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           dist_add                                                           |
+//Params:         DistStats* d            The statistics.                            |
+//                int bin                 The bin that grew.                         |
+//                uint64_t count          By how much.                               |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function adds 'count' to one bin. The sums take the          |
+//                difference of the bin's old and new terms. If this bin was the    |
+//                last one at the minimum, the bins are scanned once for the new    |
+//                minimum; otherwise the update is O(1).                            |
+//==================================================================================|
+void dist_add(DistStats *d, int bin, uint64_t count) {
+    uint64_t old;
+    uint64_t now;
+    uint64_t min;
+    int i;
+
+    if (count == 0 || bin < 0 || bin >= d->bins) {
+        return;
+    }
+
+    old = d->counts[bin];
+    now = old + count;
+    d->counts[bin] = now;
+    d->total += count;
+    d->sum_n_ln_n += dist_n_ln_n(now) - dist_n_ln_n(old);
+    if (d->expected[bin] > 0.0) {
+        d->sum_sq_over_p += ((long double)count * (long double)(old + now)) /
+                            (long double)d->expected[bin];
+    } else {
+        d->unexpected += count;
+    }
+
+    if (now > d->counts[d->max_bin]) {
+        d->max_bin = bin;
+    }
+    if (old == d->counts[d->min_bin] || bin == d->min_bin) {
+        if (--d->min_ties == 0) {
+            min = UINT64_MAX;
+            for (i = 0; i < d->bins; i++) {
+                if (d->counts[i] < min) {
+                    min = d->counts[i];
+                    d->min_bin = i;
+                    d->min_ties = 0;
+                }
+                if (d->counts[i] == min) {
+                    d->min_ties++;
+                }
+            }
+        } else if (bin == d->min_bin) {
+            for (i = 0; i < d->bins; i++) {
+                if (i != bin && d->counts[i] == old) {
+                    d->min_bin = i;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+//==================================================FUNCTION========================|
+//Name:           dist_sync                                                          |
+//Params:         DistStats* d            The statistics.                            |
+//                const uint64_t* counts  The histogram, 'bins' counts that have     |
+//                                        only grown since the last sync.            |
+//Returns:        int                     Number of bins that changed.               |
+//Outputs:        NONE                                                              |
+//Description:    This function catches up with a histogram kept elsewhere, once per|
+//                batch: one comparison per bin and a dist_add for each bin that    |
+//                grew, whatever path the counts came in by.                        |
+//==================================================================================|
+int dist_sync(DistStats *d, const uint64_t *counts) {
+    int changed = 0;
+    int i;
+
+    for (i = 0; i < d->bins; i++) {
+        if (counts[i] > d->counts[i]) {
+            dist_add(d, i, counts[i] - d->counts[i]);
+            changed++;
+        }
+    }
+
+    return changed;
+}
+
+//==================================================FUNCTION========================|
+//Name:           dist_entropy                                                       |
+//Params:         const DistStats* d      The statistics.                            |
+//Returns:        double                  Shannon entropy in bits, 0 when empty.     |
+//Outputs:        NONE                                                              |
+//Description:    This function returns H; log2(bins) is the most it can be.       |
+//==================================================================================|
+double dist_entropy(const DistStats *d) {
+    long double h;
+
+    if (d->total == 0) {
+        return 0.0;
+    }
+    h = (dist_n_ln_n(d->total) - d->sum_n_ln_n) / ((long double)d->total * logl(2.0L));
+
+    return (h > 0.0L) ? (double)h : 0.0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           dist_chi_square                                                    |
+//Params:         const DistStats* d      The statistics.                            |
+//Returns:        double                  Pearson's X2 against the expected shares,  |
+//                                        0 when empty.                              |
+//Outputs:        NONE                                                              |
+//Description:    This function returns X2. Compare it with bins - 1, its expected  |
+//                value when the stream follows the distribution.                   |
+//==================================================================================|
+double dist_chi_square(const DistStats *d) {
+    long double x2;
+
+    if (d->unexpected > 0) {
+        return INFINITY;
+    }
+    if (d->total == 0) {
+        return 0.0;
+    }
+    x2 = d->sum_sq_over_p / (long double)d->total - (long double)d->total;
+
+    return (x2 > 0.0L) ? (double)x2 : 0.0;
+}
@@ -0,0 +1,285 @@
+/*
+*	FILE:			generator.c
+*	ASSIGNMENT:	    Histogram System
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This file implements the producers' load model: alias tables
+*                 (Vose's method) for the symbol distributions, and the arrival
+*                 patterns that scale each producer's sleep between writes.
+*/
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <math.h>
+#include <time.h>
+#include "../inc/generator.h"
+#include "../inc/constants.h"
+#include "../inc/config.h"
+
+//==================================================FUNCTION========================|
+//Name:           gen_random                                                         |
+//Params:         SymbolGenerator* g      Generator owning the random state.         |
+//Returns:        uint64_t                64 random bits.                            |
+//Outputs:        NONE                                                              |
+//Description:    This function steps a xorshift64* generator, which is much cheaper |
+//                than rand() and has no shared hidden state.                        |
+//==================================================================================|
+static uint64_t gen_random(SymbolGenerator *g) {
+    uint64_t x = g->rng;
+
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    g->rng = x;
+
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+//==================================================FUNCTION========================|
+//Name:           gen_init                                                           |
+//Params:         SymbolGenerator* g      Generator to build.                        |
+//                const double* weights   Relative weight of each symbol (>= 0).     |
+//                int n                   Number of symbols (1..GEN_MAX_SYMBOLS).    |
+//                char first              Symbol for weights[0].                     |
+//                uint64_t seed           Random seed.                               |
+//Returns:        int                     Returns 0 on success, -1 on failure.       |
+//Outputs:        NONE                                                              |
+//Description:    This function builds the alias table. Every column holds at most   |
+//                two symbols, its own and an alias, so a draw is O(1).              |
+//==================================================================================|
+int gen_init(SymbolGenerator *g, const double *weights, int n, char first, uint64_t seed) {
+    double scaled[GEN_MAX_SYMBOLS];
+    int small[GEN_MAX_SYMBOLS];
+    int large[GEN_MAX_SYMBOLS];
+    int num_small = 0;
+    int num_large = 0;
+    double sum = 0.0;
+    int s, l, i;
+
+    if (!g || n <= 0 || n > GEN_MAX_SYMBOLS) {
+        return -1;
+    }
+
+    for (i = 0; i < n; i++) {
+        if (weights[i] < 0.0) {
+            return -1;
+        }
+        sum += weights[i];
+    }
+    if (sum <= 0.0) {
+        return -1;
+    }
+
+    g->n = n;
+    g->first = first;
+    g->rng = seed ? seed : 0x9E3779B97F4A7C15ULL;
+
+    for (i = 0; i < n; i++) {
+        scaled[i] = weights[i] * n / sum;
+        if (scaled[i] < 1.0) {
+            small[num_small++] = i;
+        } else {
+            large[num_large++] = i;
+        }
+    }
+
+    while (num_small > 0 && num_large > 0) {
+        s = small[--num_small];
+        l = large[--num_large];
+        g->threshold[s] = (uint32_t)(scaled[s] * 4294967296.0);
+        g->alias[s] = (uint8_t)l;
+        scaled[l] = (scaled[l] + scaled[s]) - 1.0;
+        if (scaled[l] < 1.0) {
+            small[num_small++] = l;
+        } else {
+            large[num_large++] = l;
+        }
+    }
+
+    /* whatever is left is (up to rounding) a full column */
+    while (num_large > 0) {
+        l = large[--num_large];
+        g->threshold[l] = UINT32_MAX;
+        g->alias[l] = (uint8_t)l;
+    }
+    while (num_small > 0) {
+        s = small[--num_small];
+        g->threshold[s] = UINT32_MAX;
+        g->alias[s] = (uint8_t)s;
+    }
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           gen_weights                                                        |
+//Params:         const char* dist        A distribution name, see generator.h.      |
+//                double* weights         Receives one weight per symbol.            |
+//                int n                   Number of symbols.                         |
+//Returns:        int                     Returns 0 on success, -1 on failure.       |
+//Outputs:        NONE                                                              |
+//Description:    This function builds the relative weights of a distribution from  |
+//                its name and the HISTO_* parameters. DC uses it too, to know what |
+//                the producers are meant to send.                                  |
+//==================================================================================|
+int gen_weights(const char *dist, double *weights, int n) {
+    double exponent;
+    double ratio;
+    int hot;
+    int i;
+
+    if (strcasecmp(dist, "zipf") == 0) {
+        exponent = config_get_double("HISTO_ZIPF_S", GEN_ZIPF_S_DEFAULT);
+        for (i = 0; i < n; i++) {
+            weights[i] = 1.0 / pow((double)(i + 1), exponent);
+        }
+    } else if (strcasecmp(dist, "hotspot") == 0) {
+        ratio = config_get_double("HISTO_HOTSPOT_RATIO", GEN_HOTSPOT_RATIO_DEFAULT);
+        hot = config_get_int("HISTO_HOTSPOT_KEYS", GEN_HOTSPOT_KEYS_DEFAULT);
+        if (hot < 1 || hot >= n || ratio < 0.0 || ratio > 1.0) {
+            fprintf(stderr, "generator: invalid hotspot settings\n");
+            return -1;
+        }
+        for (i = 0; i < n; i++) {
+            weights[i] = (i < hot) ? ratio / hot : (1.0 - ratio) / (n - hot);
+        }
+    } else {
+        if (strcasecmp(dist, "uniform") != 0) {
+            fprintf(stderr, "generator: unknown distribution '%s', using uniform\n", dist);
+        }
+        for (i = 0; i < n; i++) {
+            weights[i] = 1.0;
+        }
+    }
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           gen_init_from_config                                               |
+//Params:         SymbolGenerator* g      Generator to build.                        |
+//                uint64_t seed           Random seed.                               |
+//Returns:        int                     Returns 0 on success, -1 on failure.       |
+//Outputs:        NONE                                                              |
+//Description:    This function builds the weights for CHAR_START..CHAR_END from     |
+//                HISTO_DIST and its parameters.                                     |
+//==================================================================================|
+int gen_init_from_config(SymbolGenerator *g, uint64_t seed) {
+    double weights[GEN_MAX_SYMBOLS];
+    int n = CHAR_END - CHAR_START + 1;
+
+    if (gen_weights(config_get_str("HISTO_DIST", GEN_DIST_DEFAULT), weights, n) == -1) {
+        return -1;
+    }
+
+    return gen_init(g, weights, n, CHAR_START, seed);
+}
+
+//==================================================FUNCTION========================|
+//Name:           gen_next                                                           |
+//Params:         SymbolGenerator* g      The generator.                             |
+//Returns:        char                    The next symbol.                           |
+//Outputs:        NONE                                                              |
+//Description:    This function picks a column with the high 32 random bits and     |
+//                chooses between the column and its alias with the low 32 bits.     |
+//==================================================================================|
+char gen_next(SymbolGenerator *g) {
+    uint64_t r = gen_random(g);
+    uint32_t column = (uint32_t)(((r >> 32) * (uint64_t)g->n) >> 32);
+    uint32_t coin = (uint32_t)r;
+
+    return (char)(g->first + ((coin < g->threshold[column]) ? column : g->alias[column]));
+}
+
+//==================================================FUNCTION========================|
+//Name:           gen_fill                                                           |
+//Params:         SymbolGenerator* g      The generator.                             |
+//                char* buffer            Receives the symbols.                      |
+//                int count               Number of symbols to generate.             |
+//Returns:        NONE                                                              |
+//Outputs:        Fills buffer                                                       |
+//Description:    This function draws 'count' symbols.                               |
+//==================================================================================|
+void gen_fill(SymbolGenerator *g, char *buffer, int count) {
+    int i;
+
+    for (i = 0; i < count; i++) {
+        buffer[i] = gen_next(g);
+    }
+}
+
+//==================================================FUNCTION========================|
+//Name:           arrival_now_us                                                     |
+//Params:         NONE                                                              |
+//Returns:        uint64_t                Monotonic time in microseconds.            |
+//Outputs:        NONE                                                              |
+//Description:    This function reads the clock used by the arrival patterns.        |
+//==================================================================================|
+static uint64_t arrival_now_us(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000;
+}
+
+//==================================================FUNCTION========================|
+//Name:           arrival_init_from_config                                           |
+//Params:         ArrivalPattern* a       Pattern to set up.                         |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function reads HISTO_ARRIVAL and its parameters.              |
+//==================================================================================|
+void arrival_init_from_config(ArrivalPattern *a) {
+    const char *pattern = config_get_str("HISTO_ARRIVAL", GEN_ARRIVAL_DEFAULT);
+
+    if (strcasecmp(pattern, "onoff") == 0) {
+        a->pattern = ARRIVAL_ONOFF;
+    } else if (strcasecmp(pattern, "ramp") == 0) {
+        a->pattern = ARRIVAL_RAMP;
+    } else {
+        a->pattern = ARRIVAL_STEADY;
+    }
+
+    a->on_us = config_get_int("HISTO_BURST_ON_MS", GEN_BURST_ON_MS_DEFAULT) * 1000;
+    a->off_us = config_get_int("HISTO_BURST_OFF_MS", GEN_BURST_OFF_MS_DEFAULT) * 1000;
+    a->ramp_us = config_get_int("HISTO_RAMP_MS", GEN_RAMP_MS_DEFAULT) * 1000;
+    a->factor = config_get_int("HISTO_BURST_FACTOR", GEN_BURST_FACTOR_DEFAULT);
+    if (a->on_us <= 0 || a->off_us < 0 || a->ramp_us <= 0 || a->factor < 1) {
+        fprintf(stderr, "generator: invalid arrival settings, using steady\n");
+        a->pattern = ARRIVAL_STEADY;
+    }
+    a->start_us = arrival_now_us();
+}
+
+//==================================================FUNCTION========================|
+//Name:           arrival_next_sleep                                                 |
+//Params:         ArrivalPattern* a       The arrival pattern.                       |
+//                int base_us             The producer's steady sleep.               |
+//                int* send               Set to 0 during an off period.             |
+//Returns:        int                     Microseconds to sleep after this write.    |
+//Outputs:        NONE                                                              |
+//Description:    This function decides whether the producer writes now and how long |
+//                it sleeps afterwards, from the time since start-up.                |
+//==================================================================================|
+int arrival_next_sleep(ArrivalPattern *a, int base_us, int *send) {
+    uint64_t phase;
+    uint64_t period;
+
+    *send = 1;
+
+    switch (a->pattern) {
+    case ARRIVAL_ONOFF:
+        period = (uint64_t)a->on_us + (uint64_t)a->off_us;
+        phase = (arrival_now_us() - a->start_us) % period;
+        if (phase < (uint64_t)a->on_us) {
+            return base_us / a->factor;
+        }
+        *send = 0;
+        return (int)(period - phase);
+    case ARRIVAL_RAMP:
+        phase = (arrival_now_us() - a->start_us) % (uint64_t)a->ramp_us;
+        return (int)((double)base_us /
+                     (1.0 + (double)(a->factor - 1) * (double)phase / (double)a->ramp_us));
+    default:
+        return base_us;
+    }
+}
@@ -0,0 +1,245 @@
+/*
+*	FILE:			hdr_histogram.c
+*	ASSIGNMENT:	    Histogram System
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This file implements the log-linear histogram. Bucket b covers
+*                 [2^b * half, 2^(b+1) * half) with 'half' sub-buckets of width 2^b;
+*                 bucket 0 also covers [0, half) with width 1.
+*/
+#include <stdlib.h>
+#include <string.h>
+#include "../inc/hdr_histogram.h"
+
+#define HDR_MIN_DIGITS 1
+#define HDR_MAX_DIGITS 5
+
+//==================================================FUNCTION========================|
+//Name:           hdr_counts_index                                                   |
+//Params:         const HdrHistogram* h   The histogram.                             |
+//                uint64_t value          A value no larger than h->highest.         |
+//Returns:        int                     Index into h->counts.                      |
+//Outputs:        NONE                                                              |
+//Description:    This function maps a value to its sub-bucket with a count-leading- |
+//                zeros and two shifts.                                              |
+//==================================================================================|
+static int hdr_counts_index(const HdrHistogram *h, uint64_t value) {
+    int pow2ceiling = 64 - __builtin_clzll(value | h->sub_bucket_mask);
+    int bucket = pow2ceiling - (h->sub_bucket_half_count_magnitude + 1);
+    int sub_bucket = (int)(value >> bucket);
+
+    return ((bucket + 1) << h->sub_bucket_half_count_magnitude) +
+           (sub_bucket - h->sub_bucket_half_count);
+}
+
+//==================================================FUNCTION========================|
+//Name:           hdr_init                                                           |
+//Params:         HdrHistogram* h         The histogram to initialize.               |
+//                uint64_t highest        Largest value that must be tracked (>= 2). |
+//                int significant_digits  Precision, 1..5 decimal digits.            |
+//Returns:        int                     Returns 0 on success, -1 on failure.       |
+//Outputs:        NONE                                                              |
+//Description:    This function sizes and allocates the counts array once.           |
+//==================================================================================|
+int hdr_init(HdrHistogram *h, uint64_t highest, int significant_digits) {
+    uint64_t largest_single_unit;
+    uint64_t smallest_untrackable;
+    int sub_bucket_count_magnitude = 0;
+    int i;
+
+    if (!h || highest < 2 || significant_digits < HDR_MIN_DIGITS ||
+        significant_digits > HDR_MAX_DIGITS) {
+        return -1;
+    }
+
+    memset(h, 0, sizeof(*h));
+    h->highest = highest;
+    h->significant_digits = significant_digits;
+
+    largest_single_unit = 2;
+    for (i = 0; i < significant_digits; i++) {
+        largest_single_unit *= 10;
+    }
+    while ((1ULL << sub_bucket_count_magnitude) < largest_single_unit) {
+        sub_bucket_count_magnitude++;
+    }
+    h->sub_bucket_half_count_magnitude = sub_bucket_count_magnitude - 1;
+    h->sub_bucket_half_count = 1 << h->sub_bucket_half_count_magnitude;
+    h->sub_bucket_mask = (1ULL << sub_bucket_count_magnitude) - 1;
+
+    smallest_untrackable = 1ULL << sub_bucket_count_magnitude;
+    h->bucket_count = 1;
+    while (smallest_untrackable <= highest) {
+        if (smallest_untrackable > UINT64_MAX / 2) {
+            h->bucket_count++;
+            break;
+        }
+        smallest_untrackable <<= 1;
+        h->bucket_count++;
+    }
+
+    h->counts_len = (h->bucket_count + 1) * h->sub_bucket_half_count;
+    h->counts = calloc((size_t)h->counts_len, sizeof(uint64_t));
+    if (h->counts == NULL) {
+        return -1;
+    }
+    h->min = UINT64_MAX;
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           hdr_record_count                                                   |
+//Params:         HdrHistogram* h         The histogram to update.                   |
+//                uint64_t value          The sample value.                          |
+//                uint64_t count          How many times it occurred.                |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function adds samples. Values above 'highest' are counted in  |
+//                the top sub-bucket and in 'clamped'.                               |
+//==================================================================================|
+void hdr_record_count(HdrHistogram *h, uint64_t value, uint64_t count) {
+    if (count == 0) {
+        return;
+    }
+
+    if (value > h->highest) {
+        h->clamped += count;
+        value = h->highest;
+    }
+
+    h->counts[hdr_counts_index(h, value)] += count;
+    h->total += count;
+    h->sum += (double)value * (double)count;
+    if (value < h->min) {
+        h->min = value;
+    }
+    if (value > h->max) {
+        h->max = value;
+    }
+}
+
+//==================================================FUNCTION========================|
+//Name:           hdr_record                                                         |
+//Params:         HdrHistogram* h         The histogram to update.                   |
+//                uint64_t value          The sample value.                          |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function adds a single sample.                                |
+//==================================================================================|
+void hdr_record(HdrHistogram *h, uint64_t value) {
+    hdr_record_count(h, value, 1);
+}
+
+//==================================================FUNCTION========================|
+//Name:           hdr_value_at_index                                                 |
+//Params:         const HdrHistogram* h   The histogram.                             |
+//                int index               Index into h->counts.                      |
+//Returns:        uint64_t                Highest value that maps to that index.     |
+//Outputs:        NONE                                                              |
+//Description:    This function inverts hdr_counts_index, reporting the top of the   |
+//                sub-bucket's range.                                                |
+//==================================================================================|
+uint64_t hdr_value_at_index(const HdrHistogram *h, int index) {
+    int bucket = (index >> h->sub_bucket_half_count_magnitude) - 1;
+    int sub_bucket = (index & (h->sub_bucket_half_count - 1)) + h->sub_bucket_half_count;
+
+    if (bucket < 0) {
+        sub_bucket -= h->sub_bucket_half_count;
+        bucket = 0;
+    }
+
+    return ((uint64_t)sub_bucket << bucket) + ((1ULL << bucket) - 1);
+}
+
+//==================================================FUNCTION========================|
+//Name:           hdr_value_at_quantile                                              |
+//Params:         const HdrHistogram* h   The histogram to query.                    |
+//                double quantile         Quantile in [0, 1], e.g. 0.9999.           |
+//Returns:        uint64_t                Value at that quantile, 0 if empty.        |
+//Outputs:        NONE                                                              |
+//Description:    This function walks the counts until the running total reaches     |
+//                the requested rank, so its cost depends only on the bucket count.  |
+//==================================================================================|
+uint64_t hdr_value_at_quantile(const HdrHistogram *h, double quantile) {
+    uint64_t rank;
+    uint64_t seen = 0;
+    uint64_t value;
+    int i;
+
+    if (h->total == 0) {
+        return 0;
+    }
+
+    if (quantile < 0.0) {
+        quantile = 0.0;
+    } else if (quantile > 1.0) {
+        quantile = 1.0;
+    }
+
+    rank = (uint64_t)(quantile * (double)h->total + 0.5);
+    if (rank == 0) {
+        rank = 1;
+    }
+
+    for (i = 0; i < h->counts_len; i++) {
+        seen += h->counts[i];
+        if (seen >= rank) {
+            value = hdr_value_at_index(h, i);
+            return (value > h->max) ? h->max : value;
+        }
+    }
+
+    return h->max;
+}
+
+//==================================================FUNCTION========================|
+//Name:           hdr_mean                                                           |
+//Params:         const HdrHistogram* h   The histogram to query.                    |
+//Returns:        double                  Exact mean of the recorded values.         |
+//Outputs:        NONE                                                              |
+//Description:    This function returns sum / total, or 0 if nothing was recorded.   |
+//==================================================================================|
+double hdr_mean(const HdrHistogram *h) {
+    return (h->total == 0) ? 0.0 : h->sum / (double)h->total;
+}
+
+//==================================================FUNCTION========================|
+//Name:           hdr_memory_size                                                    |
+//Params:         const HdrHistogram* h   The histogram to query.                    |
+//Returns:        size_t                  Bytes used by the counts array.            |
+//Outputs:        NONE                                                              |
+//Description:    This function reports the fixed memory footprint.                  |
+//==================================================================================|
+size_t hdr_memory_size(const HdrHistogram *h) {
+    return (size_t)h->counts_len * sizeof(uint64_t);
+}
+
+//==================================================FUNCTION========================|
+//Name:           hdr_reset                                                          |
+//Params:         HdrHistogram* h         The histogram to clear.                    |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function zeroes all counts without reallocating.              |
+//==================================================================================|
+void hdr_reset(HdrHistogram *h) {
+    memset(h->counts, 0, hdr_memory_size(h));
+    h->total = 0;
+    h->min = UINT64_MAX;
+    h->max = 0;
+    h->clamped = 0;
+    h->sum = 0.0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           hdr_free                                                           |
+//Params:         HdrHistogram* h         The histogram to release.                  |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function frees the counts array.                              |
+//==================================================================================|
+void hdr_free(HdrHistogram *h) {
+    if (h && h->counts) {
+        free(h->counts);
+        h->counts = NULL;
+    }
+}
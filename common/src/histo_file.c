@@ -0,0 +1,336 @@
+/*
+*	FILE:			histo_file.c
+*	ASSIGNMENT:	    Histogram System
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This file implements encoding, decoding and atomic writing of the
+*                 binary histogram file format described in histo_file.h.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../inc/histo_file.h"
+
+#define HF_HEADER_SIZE 5
+#define HF_CRC_SIZE 4
+
+static uint32_t crc_table[256];
+static int crc_ready = 0;
+
+//==================================================FUNCTION========================|
+//Name:           hf_crc32                                                           |
+//Params:         const unsigned char* p  Bytes to checksum.                         |
+//                size_t len              Number of bytes.                           |
+//Returns:        uint32_t                The CRC-32 (IEEE 802.3) of the bytes.       |
+//Outputs:        NONE                                                              |
+//Description:    This function computes a table-driven CRC-32, building the table   |
+//                on first use.                                                      |
+//==================================================================================|
+uint32_t hf_crc32(const unsigned char *p, size_t len) {
+    uint32_t crc = 0xFFFFFFFFu;
+    uint32_t c;
+    size_t i;
+    int k;
+
+    if (!crc_ready) {
+        for (i = 0; i < 256; i++) {
+            c = (uint32_t)i;
+            for (k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            crc_table[i] = c;
+        }
+        crc_ready = 1;
+    }
+
+    for (i = 0; i < len; i++) {
+        crc = crc_table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    }
+
+    return crc ^ 0xFFFFFFFFu;
+}
+
+//==================================================FUNCTION========================|
+//Name:           hf_put_varint                                                      |
+//Params:         unsigned char* p        Output position.                           |
+//                uint64_t value          Value to encode.                           |
+//Returns:        int                     Number of bytes written (1..10).           |
+//Outputs:        NONE                                                              |
+//Description:    This function writes an unsigned LEB128 varint.                    |
+//==================================================================================|
+int hf_put_varint(unsigned char *p, uint64_t value) {
+    int n = 0;
+
+    while (value >= 0x80) {
+        p[n++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    p[n++] = (unsigned char)value;
+
+    return n;
+}
+
+//==================================================FUNCTION========================|
+//Name:           hf_get_varint                                                      |
+//Params:         const unsigned char** p Input position, advanced past the varint.  |
+//                const unsigned char* end  End of the input.                        |
+//                uint64_t* value         Receives the decoded value.                |
+//Returns:        int                     Returns 0 on success, -1 if truncated.     |
+//Outputs:        NONE                                                              |
+//Description:    This function reads an unsigned LEB128 varint.                     |
+//==================================================================================|
+int hf_get_varint(const unsigned char **p, const unsigned char *end, uint64_t *value) {
+    uint64_t result = 0;
+    int shift = 0;
+
+    while (*p < end && shift < 64) {
+        result |= (uint64_t)(**p & 0x7F) << shift;
+        if ((*(*p)++ & 0x80) == 0) {
+            *value = result;
+            return 0;
+        }
+        shift += 7;
+    }
+
+    return -1;
+}
+
+//==================================================FUNCTION========================|
+//Name:           hf_encode                                                          |
+//Params:         const HfSection* sections  Sections to encode.                     |
+//                int count               Number of sections.                        |
+//                unsigned char** out     Buffer, grown with realloc as needed.      |
+//                size_t* out_cap         Capacity of *out.                          |
+//Returns:        int                     Encoded length, or -1 on failure.          |
+//Outputs:        NONE                                                              |
+//Description:    This function encodes the sections into the file format. Callers   |
+//                keep the buffer between calls so periodic dumps do not allocate.   |
+//==================================================================================|
+int hf_encode(const HfSection *sections, int count, unsigned char **out, size_t *out_cap) {
+    size_t need = HF_HEADER_SIZE + HF_MAX_VARINT + HF_CRC_SIZE;
+    unsigned char *grown;
+    unsigned char *p;
+    uint64_t prev;
+    int64_t delta;
+    uint32_t crc;
+    int s, i;
+
+    for (s = 0; s < count; s++) {
+        need += 4 * HF_MAX_VARINT + (size_t)sections[s].bin_count * HF_MAX_VARINT;
+    }
+    if (*out_cap < need) {
+        grown = realloc(*out, need);
+        if (grown == NULL) {
+            return -1;
+        }
+        *out = grown;
+        *out_cap = need;
+    }
+
+    p = *out;
+    memcpy(p, HF_MAGIC, 4);
+    p[4] = HF_VERSION;
+    p += HF_HEADER_SIZE;
+    p += hf_put_varint(p, (uint64_t)count);
+
+    for (s = 0; s < count; s++) {
+        p += hf_put_varint(p, (uint64_t)sections[s].type);
+        p += hf_put_varint(p, (uint64_t)sections[s].channel);
+        p += hf_put_varint(p, (uint64_t)sections[s].first_key);
+        p += hf_put_varint(p, (uint64_t)sections[s].bin_count);
+        prev = 0;
+        for (i = 0; i < sections[s].bin_count; i++) {
+            delta = (int64_t)(sections[s].bins[i] - prev);
+            p += hf_put_varint(p, ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63));
+            prev = sections[s].bins[i];
+        }
+    }
+
+    crc = hf_crc32(*out, (size_t)(p - *out));
+    for (i = 0; i < 4; i++) {
+        *p++ = (unsigned char)(crc >> (8 * i));
+    }
+
+    return (int)(p - *out);
+}
+
+//==================================================FUNCTION========================|
+//Name:           hf_decode                                                          |
+//Params:         const unsigned char* data  Encoded file contents.                  |
+//                size_t len              Length of 'data'.                          |
+//                HfReadBuffer* rb        Reusable buffers for decoded bins.         |
+//                HfSectionHandler handler  Called once per decoded section.         |
+//                void* ctx               Passed through to 'handler'.               |
+//Returns:        int                     Returns 0 on success, -1 if the data is    |
+//                                        corrupt or of an unknown version.          |
+//Outputs:        NONE                                                              |
+//Description:    This function verifies the checksum and hands each section to the  |
+//                handler. The bins pointer is only valid during the callback.       |
+//==================================================================================|
+int hf_decode(const unsigned char *data, size_t len, HfReadBuffer *rb,
+              HfSectionHandler handler, void *ctx) {
+    const unsigned char *p;
+    const unsigned char *end;
+    uint64_t count, type, channel, first_key, bin_count, zz;
+    uint64_t prev;
+    uint64_t *grown;
+    uint32_t crc = 0;
+    HfSection section;
+    uint64_t s, i;
+
+    if (len < HF_HEADER_SIZE + HF_CRC_SIZE || memcmp(data, HF_MAGIC, 4) != 0 ||
+        data[4] != HF_VERSION) {
+        return -1;
+    }
+
+    end = data + len - HF_CRC_SIZE;
+    for (i = 0; i < 4; i++) {
+        crc |= (uint32_t)end[i] << (8 * i);
+    }
+    if (crc != hf_crc32(data, len - HF_CRC_SIZE)) {
+        return -1;
+    }
+
+    p = data + HF_HEADER_SIZE;
+    if (hf_get_varint(&p, end, &count) == -1) {
+        return -1;
+    }
+
+    for (s = 0; s < count; s++) {
+        if (hf_get_varint(&p, end, &type) == -1 || hf_get_varint(&p, end, &channel) == -1 ||
+            hf_get_varint(&p, end, &first_key) == -1 ||
+            hf_get_varint(&p, end, &bin_count) == -1 || bin_count > (uint64_t)(end - p)) {
+            return -1;
+        }
+
+        if ((uint64_t)rb->bins_cap < bin_count) {
+            grown = realloc(rb->bins, (size_t)bin_count * sizeof(uint64_t));
+            if (grown == NULL) {
+                return -1;
+            }
+            rb->bins = grown;
+            rb->bins_cap = (int)bin_count;
+        }
+
+        prev = 0;
+        for (i = 0; i < bin_count; i++) {
+            if (hf_get_varint(&p, end, &zz) == -1) {
+                return -1;
+            }
+            prev += (zz >> 1) ^ (uint64_t)(-(int64_t)(zz & 1));
+            rb->bins[i] = prev;
+        }
+
+        section.type = (int)type;
+        section.channel = (int)channel;
+        section.first_key = (int)first_key;
+        section.bin_count = (int)bin_count;
+        section.bins = rb->bins;
+        handler(ctx, &section);
+    }
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           hf_write_file                                                      |
+//Params:         const char* path        Destination file.                          |
+//                const HfSection* sections  Sections to write.                      |
+//                int count               Number of sections.                        |
+//Returns:        int                     Returns 0 on success, -1 on failure.       |
+//Outputs:        Writes 'path'                                                     |
+//Description:    This function writes to "<path>.tmp" and renames it over 'path',   |
+//                so readers never see a partially written file.                     |
+//==================================================================================|
+int hf_write_file(const char *path, const HfSection *sections, int count) {
+    static unsigned char *buf = NULL;
+    static size_t buf_cap = 0;
+    char tmp_path[4096];
+    FILE *fp;
+    int len;
+    int ok;
+
+    len = hf_encode(sections, count, &buf, &buf_cap);
+    if (len == -1) {
+        return -1;
+    }
+
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+    fp = fopen(tmp_path, "wb");
+    if (fp == NULL) {
+        perror("hf_write_file fopen");
+        return -1;
+    }
+    ok = fwrite(buf, 1, (size_t)len, fp) == (size_t)len;
+    if (fclose(fp) != 0 || !ok) {
+        perror("hf_write_file write");
+        remove(tmp_path);
+        return -1;
+    }
+
+    if (rename(tmp_path, path) == -1) {
+        perror("hf_write_file rename");
+        remove(tmp_path);
+        return -1;
+    }
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           hf_read_file                                                       |
+//Params:         const char* path        File to read.                              |
+//                HfReadBuffer* rb        Buffers reused from file to file.          |
+//                HfSectionHandler handler  Called once per section.                 |
+//                void* ctx               Passed through to 'handler'.               |
+//Returns:        int                     Returns 0 on success, -1 on failure.       |
+//Outputs:        NONE                                                              |
+//Description:    This function reads one file into the reusable buffer and decodes  |
+//                it, so merging many files needs memory for only one at a time.     |
+//==================================================================================|
+int hf_read_file(const char *path, HfReadBuffer *rb, HfSectionHandler handler, void *ctx) {
+    unsigned char *grown;
+    FILE *fp;
+    long size;
+    int ok;
+
+    fp = fopen(path, "rb");
+    if (fp == NULL) {
+        return -1;
+    }
+
+    if (fseek(fp, 0, SEEK_END) != 0 || (size = ftell(fp)) < 0 || fseek(fp, 0, SEEK_SET) != 0) {
+        fclose(fp);
+        return -1;
+    }
+
+    if (rb->data_cap < (size_t)size) {
+        grown = realloc(rb->data, (size_t)size);
+        if (grown == NULL) {
+            fclose(fp);
+            return -1;
+        }
+        rb->data = grown;
+        rb->data_cap = (size_t)size;
+    }
+
+    ok = fread(rb->data, 1, (size_t)size, fp) == (size_t)size;
+    fclose(fp);
+    if (!ok) {
+        return -1;
+    }
+
+    return hf_decode(rb->data, (size_t)size, rb, handler, ctx);
+}
+
+//==================================================FUNCTION========================|
+//Name:           hf_read_buffer_free                                                |
+//Params:         HfReadBuffer* rb        Buffers to release.                        |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function frees the reusable read buffers.                     |
+//==================================================================================|
+void hf_read_buffer_free(HfReadBuffer *rb) {
+    free(rb->data);
+    free(rb->bins);
+    memset(rb, 0, sizeof(*rb));
+}
@@ -0,0 +1,249 @@
+/*
+*	FILE:			hyperloglog.c
+*	ASSIGNMENT:	    Histogram System
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This file implements the HyperLogLog distinct-count sketch, its
+*                 register merge and a small checkpoint file format ("HLL1", one
+*                 precision byte, then the raw registers).
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include "../inc/hyperloglog.h"
+#include "../inc/hash_utils.h"
+
+#define HLL_ALIGNMENT 64
+#define HLL_MAGIC "HLL1"
+
+//==================================================FUNCTION========================|
+//Name:           hll_init                                                           |
+//Params:         HyperLogLog* hll        The sketch to initialize.                  |
+//                int precision           Number of index bits (4..16).              |
+//Returns:        int                     Returns 0 on success, -1 on failure.       |
+//Outputs:        NONE                                                              |
+//Description:    This function allocates 2^precision zeroed registers.              |
+//==================================================================================|
+int hll_init(HyperLogLog *hll, int precision) {
+    size_t bytes;
+
+    if (!hll || precision < HLL_MIN_PRECISION || precision > HLL_MAX_PRECISION) {
+        return -1;
+    }
+
+    hll->precision = precision;
+    hll->num_registers = 1 << precision;
+    bytes = (size_t)hll->num_registers;
+    if (bytes < HLL_ALIGNMENT) {
+        bytes = HLL_ALIGNMENT;
+    }
+    hll->registers = aligned_alloc(HLL_ALIGNMENT, bytes);
+    if (hll->registers == NULL) {
+        return -1;
+    }
+    memset(hll->registers, 0, bytes);
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           hll_add                                                            |
+//Params:         HyperLogLog* hll        The sketch to update.                      |
+//                uint64_t key            The key that was seen.                     |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function routes the key to a register with the top hash bits  |
+//                and records the position of the first set bit in the rest.         |
+//==================================================================================|
+void hll_add(HyperLogLog *hll, uint64_t key) {
+    uint64_t h = hash_u64(key);
+    uint32_t index = (uint32_t)(h >> (64 - hll->precision));
+    /* the sentinel bit caps the rank at 64 - precision + 1 */
+    uint64_t rest = (h << hll->precision) | (1ULL << (hll->precision - 1));
+    uint8_t rank = (uint8_t)(__builtin_clzll(rest) + 1);
+
+    if (rank > hll->registers[index]) {
+        hll->registers[index] = rank;
+    }
+}
+
+//==================================================FUNCTION========================|
+//Name:           hll_merge                                                          |
+//Params:         HyperLogLog* dst        Sketch receiving the union.                |
+//                const HyperLogLog* src  Sketch to fold in.                         |
+//Returns:        int                     Returns 0 on success, -1 on a precision mismatch. |
+//Outputs:        NONE                                                              |
+//Description:    This function takes the per-register maximum. The loop is a plain  |
+//                byte-wise max over aligned arrays, which the compiler vectorises.  |
+//==================================================================================|
+int hll_merge(HyperLogLog *dst, const HyperLogLog *src) {
+    uint8_t *restrict d;
+    const uint8_t *restrict s;
+    int i;
+
+    if (!dst || !src || dst->precision != src->precision) {
+        return -1;
+    }
+
+    d = dst->registers;
+    s = src->registers;
+    for (i = 0; i < dst->num_registers; i++) {
+        d[i] = (s[i] > d[i]) ? s[i] : d[i];
+    }
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           hll_estimate                                                       |
+//Params:         const HyperLogLog* hll  The sketch to query.                       |
+//Returns:        double                  Estimated number of distinct keys.         |
+//Outputs:        NONE                                                              |
+//Description:    This function computes the harmonic-mean estimate, switching to    |
+//                linear counting while many registers are still empty.              |
+//==================================================================================|
+double hll_estimate(const HyperLogLog *hll) {
+    double m = (double)hll->num_registers;
+    double alpha;
+    double sum = 0.0;
+    double estimate;
+    int zeros = 0;
+    int i;
+
+    switch (hll->num_registers) {
+    case 16:
+        alpha = 0.673;
+        break;
+    case 32:
+        alpha = 0.697;
+        break;
+    case 64:
+        alpha = 0.709;
+        break;
+    default:
+        alpha = 0.7213 / (1.0 + 1.079 / m);
+        break;
+    }
+
+    for (i = 0; i < hll->num_registers; i++) {
+        sum += ldexp(1.0, -hll->registers[i]);
+        if (hll->registers[i] == 0) {
+            zeros++;
+        }
+    }
+
+    estimate = alpha * m * m / sum;
+    if (estimate <= 2.5 * m && zeros != 0) {
+        estimate = m * log(m / (double)zeros);
+    }
+
+    return estimate;
+}
+
+//==================================================FUNCTION========================|
+//Name:           hll_relative_error                                                 |
+//Params:         const HyperLogLog* hll  The sketch to query.                       |
+//Returns:        double                  Relative standard error of the estimate.   |
+//Outputs:        NONE                                                              |
+//Description:    This function returns 1.04 / sqrt(m).                              |
+//==================================================================================|
+double hll_relative_error(const HyperLogLog *hll) {
+    return 1.04 / sqrt((double)hll->num_registers);
+}
+
+//==================================================FUNCTION========================|
+//Name:           hll_save                                                           |
+//Params:         const HyperLogLog* hll  The sketch to write.                       |
+//                const char* path        Checkpoint file to create.                 |
+//Returns:        int                     Returns 0 on success, -1 on failure.       |
+//Outputs:        Writes the checkpoint file                                        |
+//Description:    This function writes the sketch so that it can later be merged     |
+//                into another DC or shard. It writes "<path>.tmp", syncs it and     |
+//                renames it over 'path', so a crash or a full disk leaves the       |
+//                previous checkpoint whole.                                         |
+//==================================================================================|
+int hll_save(const HyperLogLog *hll, const char *path) {
+    char tmp_path[4096];
+    FILE *fp;
+    unsigned char precision = (unsigned char)hll->precision;
+    int ok;
+
+    if (snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path) >= (int)sizeof(tmp_path)) {
+        fprintf(stderr, "hll_save: path too long\n");
+        return -1;
+    }
+    fp = fopen(tmp_path, "wb");
+    if (fp == NULL) {
+        perror("hll_save fopen");
+        return -1;
+    }
+
+    ok = fwrite(HLL_MAGIC, 1, 4, fp) == 4 &&
+         fwrite(&precision, 1, 1, fp) == 1 &&
+         fwrite(hll->registers, 1, (size_t)hll->num_registers, fp) == (size_t)hll->num_registers &&
+         fflush(fp) == 0 && fsync(fileno(fp)) == 0;
+
+    if (fclose(fp) != 0 || !ok) {
+        perror("hll_save write");
+        remove(tmp_path);
+        return -1;
+    }
+
+    if (rename(tmp_path, path) == -1) {
+        perror("hll_save rename");
+        remove(tmp_path);
+        return -1;
+    }
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           hll_load_merge                                                     |
+//Params:         HyperLogLog* hll        Sketch receiving the union.                |
+//                const char* path        Checkpoint file to read.                   |
+//Returns:        int                     Returns 0 on success, -1 on failure.       |
+//Outputs:        NONE                                                              |
+//Description:    This function reads a checkpoint and merges it into 'hll'. The     |
+//                file must have the same precision as the sketch.                   |
+//==================================================================================|
+int hll_load_merge(HyperLogLog *hll, const char *path) {
+    FILE *fp;
+    char magic[4];
+    unsigned char precision;
+    HyperLogLog loaded;
+    int result = -1;
+
+    fp = fopen(path, "rb");
+    if (fp == NULL) {
+        return -1;
+    }
+
+    if (fread(magic, 1, 4, fp) == 4 && memcmp(magic, HLL_MAGIC, 4) == 0 &&
+        fread(&precision, 1, 1, fp) == 1 && precision == hll->precision &&
+        hll_init(&loaded, precision) == 0) {
+        if (fread(loaded.registers, 1, (size_t)loaded.num_registers, fp) ==
+            (size_t)loaded.num_registers) {
+            result = hll_merge(hll, &loaded);
+        }
+        hll_free(&loaded);
+    }
+
+    fclose(fp);
+    return result;
+}
+
+//==================================================FUNCTION========================|
+//Name:           hll_free                                                           |
+//Params:         HyperLogLog* hll        The sketch to release.                     |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function frees the registers.                                 |
+//==================================================================================|
+void hll_free(HyperLogLog *hll) {
+    if (hll && hll->registers) {
+        free(hll->registers);
+        hll->registers = NULL;
+    }
+}
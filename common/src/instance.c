@@ -0,0 +1,243 @@
+/*
+*	FILE:			instance.c
+*	ASSIGNMENT:	    Histogram System
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This file implements the pipeline instance helpers: the keys and
+*                 default paths derived from HISTO_INSTANCE, the name check on a
+*                 shared segment, and the location of the programs DP-1, DP-2 and DC
+*                 start.
+*/
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <ctype.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include "../inc/instance.h"
+#include "../inc/config.h"
+#include "../inc/constants.h"
+
+//==================================================FUNCTION========================|
+//Name:           instance_name                                                      |
+//Params:         NONE                                                              |
+//Returns:        const char*             HISTO_INSTANCE, "" for the default         |
+//                                        instance, or NULL if the name is invalid.  |
+//Outputs:        Prints an error for an invalid name                               |
+//Description:    This function reads the instance name. A name is up to            |
+//                CB_NAME_SIZE - 1 letters, digits, '-' and '_', so it can be used   |
+//                in file names as it is.                                           |
+//==================================================================================|
+const char *instance_name(void) {
+    const char *name;
+    size_t i;
+
+    name = config_get_str("HISTO_INSTANCE", "");
+    if (strlen(name) >= CB_NAME_SIZE) {
+        fprintf(stderr, "HISTO_INSTANCE '%s' is longer than %d characters\n", name,
+                CB_NAME_SIZE - 1);
+        return NULL;
+    }
+    for (i = 0; name[i] != '\0'; i++) {
+        if (!isalnum((unsigned char)name[i]) && name[i] != '-' && name[i] != '_') {
+            fprintf(stderr, "HISTO_INSTANCE '%s' may only hold letters, digits, '-' and '_'\n",
+                    name);
+            return NULL;
+        }
+    }
+
+    return name;
+}
+
+//==================================================FUNCTION========================|
+//Name:           instance_keys                                                      |
+//Params:         key_t* sem_key          Receives the semaphore key.                |
+//                key_t* shm_key          Receives the shared memory key.            |
+//Returns:        int                     0 on success, -1 if the name is invalid.   |
+//Outputs:        NONE                                                              |
+//Description:    This function derives the instance's keys from a 32-bit FNV-1a    |
+//                hash of its name. Keys that would be IPC_PRIVATE or the default   |
+//                instance's are moved off them.                                    |
+//==================================================================================|
+int instance_keys(key_t *sem_key, key_t *shm_key) {
+    const char *name;
+    uint32_t hash = 2166136261u;
+    size_t i;
+
+    name = instance_name();
+    if (name == NULL) {
+        return -1;
+    }
+    if (name[0] == '\0') {
+        *sem_key = SEM_KEY;
+        *shm_key = SHM_KEY;
+        return 0;
+    }
+
+    for (i = 0; name[i] != '\0'; i++) {
+        hash ^= (unsigned char)name[i];
+        hash *= 16777619u;
+    }
+    *shm_key = (key_t)(hash & 0x7fffffff);
+    *sem_key = (key_t)((hash ^ 0x5bd1e995u) & 0x7fffffff);
+    if (*shm_key == IPC_PRIVATE || *shm_key == SHM_KEY) {
+        *shm_key |= 0x40000000;
+    }
+    if (*sem_key == IPC_PRIVATE || *sem_key == SEM_KEY) {
+        *sem_key |= 0x40000000;
+    }
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           instance_in_use                                                    |
+//Params:         key_t shm_key           The instance's shared memory key.          |
+//Returns:        int                     1 if a segment with this key has processes |
+//                                        attached, 0 otherwise.                     |
+//Outputs:        NONE                                                              |
+//Description:    This function tells a running pipeline from a segment left over   |
+//                by one that died, which DP-1 may take over as before.             |
+//==================================================================================|
+int instance_in_use(key_t shm_key) {
+    struct shmid_ds info;
+    int shm_id;
+
+    shm_id = shmget(shm_key, 0, 0);
+    if (shm_id == -1 || shmctl(shm_id, IPC_STAT, &info) == -1) {
+        return 0;
+    }
+
+    return info.shm_nattch > 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           instance_stamp                                                     |
+//Params:         CircularBuffer* cb      A segment just set up with cb_init.        |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function writes the instance name into the segment.          |
+//==================================================================================|
+void instance_stamp(CircularBuffer *cb) {
+    const char *name = instance_name();
+
+    memset(cb->instance, 0, sizeof(cb->instance));
+    if (name != NULL) {
+        strncpy(cb->instance, name, sizeof(cb->instance) - 1);
+    }
+}
+
+//==================================================FUNCTION========================|
+//Name:           instance_check                                                     |
+//Params:         const CircularBuffer* cb  An attached segment.                     |
+//                const char* who         Program name for the error message.        |
+//Returns:        int                     0 if the segment belongs to this instance  |
+//                                        or has not been set up yet, -1 otherwise.  |
+//Outputs:        Prints an error on a mismatch                                     |
+//Description:    This function catches two names whose keys collide, and a process |
+//                started by hand with another HISTO_INSTANCE than its pipeline.    |
+//==================================================================================|
+int instance_check(const CircularBuffer *cb, const char *who) {
+    const char *name = instance_name();
+
+    if (name == NULL) {
+        return -1;
+    }
+    if (cb->magic != CB_MAGIC) {
+        return 0;
+    }
+    if (strncmp(cb->instance, name, sizeof(cb->instance)) != 0) {
+        fprintf(stderr, "%s: the segment belongs to instance '%.*s', not '%s'\n", who,
+                (int)sizeof(cb->instance), cb->instance, name);
+        return -1;
+    }
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           instance_path                                                      |
+//Params:         const char* path        A default file or socket path.             |
+//                char* out               Receives the instance's path.              |
+//                size_t size             Size of 'out'.                             |
+//Returns:        const char*             'out'.                                     |
+//Outputs:        NONE                                                              |
+//Description:    This function gives a named instance its own copy of a default    |
+//                path by adding "-<name>" before the extension, so                 |
+//                "histogram.hst" becomes "histogram-<name>.hst". The default       |
+//                instance keeps the path as it is. Paths set explicitly in the     |
+//                environment should be used unchanged.                             |
+//==================================================================================|
+const char *instance_path(const char *path, char *out, size_t size) {
+    const char *name = instance_name();
+    const char *base;
+    const char *dot;
+
+    if (name == NULL || name[0] == '\0') {
+        snprintf(out, size, "%s", path);
+        return out;
+    }
+
+    base = strrchr(path, '/');
+    base = (base == NULL) ? path : base + 1;
+    dot = strrchr(base, '.');
+    if (dot == NULL || dot == base) {
+        snprintf(out, size, "%s-%s", path, name);
+    } else {
+        snprintf(out, size, "%.*s-%s%s", (int)(dot - path), path, name, dot);
+    }
+
+    return out;
+}
+
+//==================================================FUNCTION========================|
+//Name:           instance_program                                                   |
+//Params:         const char* program     A path below the install root, such as     |
+//                                        DC_PROCESS.                                |
+//                char* out               Receives the full path.                    |
+//                size_t size             Size of 'out'.                             |
+//Returns:        int                     0 on success, -1 if the install root       |
+//                                        cannot be found.                           |
+//Outputs:        Prints an error on failure                                        |
+//Description:    This function locates a program of the system. The install root   |
+//                is HISTO_HOME if set, or else found from /proc/self/exe by        |
+//                dropping the binary name, "bin" and the program's directory.      |
+//==================================================================================|
+int instance_program(const char *program, char *out, size_t size) {
+    char root[PATH_MAX];
+    const char *home;
+    char *slash;
+    ssize_t len;
+    int i;
+
+    home = config_get_str("HISTO_HOME", NULL);
+    if (home != NULL) {
+        snprintf(root, sizeof(root), "%s", home);
+    } else {
+        len = readlink("/proc/self/exe", root, sizeof(root) - 1);
+        if (len == -1) {
+            perror("readlink /proc/self/exe");
+            return -1;
+        }
+        root[len] = '\0';
+        for (i = 0; i < 3; i++) {
+            slash = strrchr(root, '/');
+            if (slash == NULL) {
+                fprintf(stderr, "cannot find the install root from %s, set HISTO_HOME\n", root);
+                return -1;
+            }
+            *slash = '\0';
+        }
+        if (root[0] == '\0') {
+            strcpy(root, "/");
+        }
+    }
+
+    if ((size_t)snprintf(out, size, "%s/%s", root, program) >= size) {
+        fprintf(stderr, "path of %s is too long\n", program);
+        return -1;
+    }
+
+    return 0;
+}
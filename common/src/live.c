@@ -0,0 +1,158 @@
+/*
+*	FILE:			live.c
+*	ASSIGNMENT:	    Histogram System
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This file implements the writer and the reader side of the live
+*                 histogram. Every shared field is accessed with an atomic builtin so
+*                 a torn copy is only ever discarded, never undefined.
+*/
+#include <stddef.h>
+#include <string.h>
+#include <time.h>
+#include "../inc/live.h"
+#include "../inc/circular_buffer.h"
+#include "../inc/constants.h"
+
+//==================================================FUNCTION========================|
+//Name:           live_init                                                          |
+//Params:         LiveHistogram* live     The live histogram to clear.               |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function empties the live histogram when the segment is set   |
+//                up.                                                                |
+//==================================================================================|
+void live_init(LiveHistogram *live) {
+    memset(live, 0, sizeof(*live));
+}
+
+//==================================================FUNCTION========================|
+//Name:           live_publish                                                       |
+//Params:         LiveHistogram* live     The shared live histogram.                 |
+//                int first_key           Key of counts[0].                          |
+//                const uint64_t* counts  The current counts.                        |
+//                int count               Number of bins, at most LIVE_MAX_BINS.     |
+//                uint64_t drains         Drains made so far.                        |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function publishes the counts. There is a single writer, DC,  |
+//                so the counter needs no lock; a reader that overlaps the write     |
+//                sees it change and retries.                                        |
+//==================================================================================|
+void live_publish(LiveHistogram *live, int first_key, const uint64_t *counts, int count,
+                  uint64_t drains) {
+    uint32_t seq = __atomic_load_n(&live->seq, __ATOMIC_RELAXED);
+    struct timespec now;
+    uint64_t total = 0;
+    int i;
+
+    if (count > LIVE_MAX_BINS) {
+        count = LIVE_MAX_BINS;
+    }
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    __atomic_store_n(&live->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    for (i = 0; i < count; i++) {
+        __atomic_store_n(&live->counts[i], counts[i], __ATOMIC_RELAXED);
+        total += counts[i];
+    }
+    __atomic_store_n(&live->first_key, first_key, __ATOMIC_RELAXED);
+    __atomic_store_n(&live->bin_count, (uint32_t)count, __ATOMIC_RELAXED);
+    __atomic_store_n(&live->updated_us,
+                     (uint64_t)now.tv_sec * 1000000 + (uint64_t)now.tv_nsec / 1000, __ATOMIC_RELAXED);
+    __atomic_store_n(&live->drains, drains, __ATOMIC_RELAXED);
+    __atomic_store_n(&live->total, total, __ATOMIC_RELAXED);
+
+    __atomic_store_n(&live->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+//==================================================FUNCTION========================|
+//Name:           live_read                                                          |
+//Params:         const LiveHistogram* live  The shared live histogram.              |
+//                LiveHistogram* out      Receives a consistent copy.                |
+//Returns:        int                     0 on success, -1 if DC was writing on each |
+//                                        of LIVE_READ_TRIES attempts.               |
+//Outputs:        NONE                                                              |
+//Description:    This function takes a snapshot without writing to the segment, so |
+//                it works on a read-only attachment and costs DC nothing.           |
+//==================================================================================|
+int live_read(const LiveHistogram *live, LiveHistogram *out) {
+    uint32_t before;
+    uint32_t after;
+    uint32_t count;
+    uint32_t i;
+    int tries;
+
+    for (tries = 0; tries < LIVE_READ_TRIES; tries++) {
+        before = __atomic_load_n(&live->seq, __ATOMIC_ACQUIRE);
+        if (before & 1) {
+            continue;
+        }
+
+        count = __atomic_load_n(&live->bin_count, __ATOMIC_RELAXED);
+        if (count > LIVE_MAX_BINS) {
+            continue;
+        }
+        for (i = 0; i < count; i++) {
+            out->counts[i] = __atomic_load_n(&live->counts[i], __ATOMIC_RELAXED);
+        }
+        out->first_key = __atomic_load_n(&live->first_key, __ATOMIC_RELAXED);
+        out->updated_us = __atomic_load_n(&live->updated_us, __ATOMIC_RELAXED);
+        out->drains = __atomic_load_n(&live->drains, __ATOMIC_RELAXED);
+        out->total = __atomic_load_n(&live->total, __ATOMIC_RELAXED);
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        after = __atomic_load_n(&live->seq, __ATOMIC_RELAXED);
+        if (after == before) {
+            out->seq = before;
+            out->bin_count = count;
+            out->reserved = 0;
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+//==================================================FUNCTION========================|
+//Name:           live_attach                                                        |
+//Params:         key_t shm_key           The pipeline's shared memory key, see      |
+//                                        instance_keys.                             |
+//Returns:        const LiveHistogram*    The running pipeline's live histogram, or  |
+//                                        NULL if there is none.                     |
+//Outputs:        NONE                                                              |
+//Description:    This function attaches the shared segment read-only, so a reader   |
+//                can neither create the segment nor disturb it.                     |
+//==================================================================================|
+const LiveHistogram *live_attach(key_t shm_key) {
+    CircularBuffer *cb;
+    int shm_id;
+
+    shm_id = shmget(shm_key, sizeof(CircularBuffer), 0);
+    if (shm_id == -1) {
+        perror("shmget");
+        return NULL;
+    }
+
+    cb = (CircularBuffer *)shmat(shm_id, NULL, SHM_RDONLY);
+    if (cb == (void *)-1) {
+        perror("shmat");
+        return NULL;
+    }
+
+    return &cb->live;
+}
+
+//==================================================FUNCTION========================|
+//Name:           live_detach                                                        |
+//Params:         const LiveHistogram* live  A pointer from live_attach.             |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function detaches the segment attached by live_attach.        |
+//==================================================================================|
+void live_detach(const LiveHistogram *live) {
+    if (live != NULL) {
+        shmdt((const char *)live - offsetof(CircularBuffer, live));
+    }
+}
@@ -0,0 +1,596 @@
+/*
+*	FILE:			record.c
+*	ASSIGNMENT:	    Histogram System
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This file implements encoding and incremental decoding of the
+*                 records carried in the circular buffer.
+*/
+#include <string.h>
+#include "../inc/record.h"
+
+//==================================================FUNCTION========================|
+//Name:           rec_payload_size                                                   |
+//Params:         int tag                 A record tag byte.                         |
+//Returns:        int                     Payload bytes following the tag, -1 if the |
+//                                        tag is unknown.                            |
+//Outputs:        NONE                                                              |
+//Description:    This function maps a tag to the size of its fixed payload. For a   |
+//                delta record that is only the length byte; see rec_payload_need.   |
+//==================================================================================|
+static int rec_payload_size(int tag) {
+    switch (tag) {
+    case REC_TAG_SAMPLE:
+        return REC_SAMPLE_SIZE - 1;
+    case REC_TAG_CHANNEL:
+        return REC_CHANNEL_HEADER - 1;
+    case REC_TAG_DELTA:
+        return 1;
+    case REC_TAG_PACKED:
+        return REC_PACKED_HEADER - 1;
+    default:
+        return -1;
+    }
+}
+
+//==================================================FUNCTION========================|
+//Name:           rec_packed_words                                                   |
+//Params:         int count               Symbols in a packed record.                |
+//                int bits                Bits per symbol.                           |
+//Returns:        int                     64-bit words that follow the header, 0 if  |
+//                                        'bits' is not valid.                       |
+//Outputs:        NONE                                                              |
+//Description:    This function sizes the body of a packed record. The count is not  |
+//                checked; see rec_packed_valid.                                     |
+//==================================================================================|
+static int rec_packed_words(int count, int bits) {
+    int per_word;
+
+    if (bits < 1 || bits > REC_PACKED_MAX_BITS) {
+        return 0;
+    }
+    per_word = 64 / bits;
+    return (count + per_word - 1) / per_word;
+}
+
+//==================================================FUNCTION========================|
+//Name:           rec_packed_valid                                                   |
+//Params:         int count               Symbols in a packed record.                |
+//                int bits                Bits per symbol.                           |
+//Returns:        int                     1 if a packed header is one a producer     |
+//                                        writes, 0 otherwise.                       |
+//Outputs:        NONE                                                              |
+//Description:    This function checks a packed header before its body is read.      |
+//==================================================================================|
+static int rec_packed_valid(int count, int bits) {
+    return bits >= 1 && bits <= REC_PACKED_MAX_BITS && count <= REC_PACKED_MAX_SYMBOLS;
+}
+
+//==================================================FUNCTION========================|
+//Name:           rec_payload_need                                                   |
+//Params:         const RecordDecoder* dec  Decoder with a pending record.           |
+//Returns:        int                     Payload bytes the pending record needs.    |
+//Outputs:        NONE                                                              |
+//Description:    This function returns the full payload size of the pending record, |
+//                which for a delta or packed record is known once its header        |
+//                arrived.                                                           |
+//==================================================================================|
+static int rec_payload_need(const RecordDecoder *dec) {
+    if (dec->pending_tag == REC_TAG_DELTA && dec->have > 0) {
+        return 1 + dec->payload[0];
+    }
+    if (dec->pending_tag == REC_TAG_PACKED && dec->have >= REC_PACKED_HEADER - 1) {
+        return REC_PACKED_HEADER - 1 + 8 * rec_packed_words(dec->payload[0], dec->payload[1]);
+    }
+    return rec_payload_size(dec->pending_tag);
+}
+
+//==================================================FUNCTION========================|
+//Name:           rec_get_varint                                                     |
+//Params:         const unsigned char* p  Start of the varint.                       |
+//                const unsigned char* end  End of the readable bytes.               |
+//                uint32_t* value         Receives the decoded value.                |
+//Returns:        int                     Bytes consumed, -1 if the varint is cut    |
+//                                        off or too long.                           |
+//Outputs:        NONE                                                              |
+//Description:    This function reads an unsigned LEB128 value of up to 32 bits.     |
+//==================================================================================|
+static int rec_get_varint(const unsigned char *p, const unsigned char *end, uint32_t *value) {
+    uint32_t result = 0;
+    int shift = 0;
+    int i = 0;
+
+    while (p + i < end && shift < 32) {
+        result |= (uint32_t)(p[i] & 0x7f) << shift;
+        if ((p[i++] & 0x80) == 0) {
+            *value = result;
+            return i;
+        }
+        shift += 7;
+    }
+
+    return -1;
+}
+
+//==================================================FUNCTION========================|
+//Name:           rec_dispatch_delta                                                 |
+//Params:         const unsigned char* p  The delta payload, after its length byte.  |
+//                int len                 Payload length.                            |
+//                const RecordSink* sink  Callbacks for non-symbol records.          |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function decodes the bin counts of a delta record and hands   |
+//                them to the sink. A malformed delta is dropped whole.              |
+//==================================================================================|
+static void rec_dispatch_delta(const unsigned char *p, int len, const RecordSink *sink) {
+    uint32_t bins[REC_DELTA_MAX_BINS];
+    const unsigned char *end = p + len;
+    const unsigned char *at;
+    int count;
+    int used;
+    int i;
+
+    if (sink == NULL || sink->on_delta == NULL || len < REC_DELTA_HEADER - 2) {
+        return;
+    }
+
+    count = p[3];
+    if (count > REC_DELTA_MAX_BINS) {
+        return;
+    }
+
+    at = p + REC_DELTA_HEADER - 2;
+    for (i = 0; i < count; i++) {
+        used = rec_get_varint(at, end, &bins[i]);
+        if (used < 0) {
+            return;
+        }
+        at += used;
+    }
+
+    sink->on_delta(sink->ctx, p[0] | (p[1] << 8), p[2], bins, count);
+}
+
+//==================================================FUNCTION========================|
+//Name:           rec_get_u64                                                        |
+//Params:         const unsigned char* p  Eight little-endian bytes.                 |
+//Returns:        uint64_t                The decoded value.                         |
+//Outputs:        NONE                                                              |
+//Description:    This function reads a little-endian 64-bit value.                  |
+//==================================================================================|
+static uint64_t rec_get_u64(const unsigned char *p) {
+    uint64_t value = 0;
+    int i;
+
+    for (i = 7; i >= 0; i--) {
+        value = (value << 8) | p[i];
+    }
+
+    return value;
+}
+
+//==================================================FUNCTION========================|
+//Name:           rec_dispatch                                                       |
+//Params:         RecordDecoder* dec      Decoder holding a complete record.         |
+//                const RecordSink* sink  Callbacks for non-symbol records.          |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function hands a completed record to its callback. A channel  |
+//                header only opens the span; its symbols follow in the stream.      |
+//==================================================================================|
+static void rec_dispatch(RecordDecoder *dec, const RecordSink *sink) {
+    switch (dec->pending_tag) {
+    case REC_TAG_SAMPLE:
+        if (sink && sink->on_sample) {
+            sink->on_sample(sink->ctx, rec_get_u64(dec->payload));
+        }
+        break;
+    case REC_TAG_CHANNEL:
+        dec->span_channel = dec->payload[0] | (dec->payload[1] << 8);
+        dec->span_left = dec->payload[2];
+        break;
+    case REC_TAG_DELTA:
+        rec_dispatch_delta(dec->payload + 1, dec->payload[0], sink);
+        break;
+    case REC_TAG_PACKED:
+        if (sink && sink->on_packed && dec->payload[0] > 0) {
+            sink->on_packed(sink->ctx, dec->payload[2], dec->payload[1],
+                            dec->payload + REC_PACKED_HEADER - 1, dec->payload[0]);
+        }
+        break;
+    default:
+        break;
+    }
+
+    dec->pending_tag = 0;
+    dec->have = 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           rec_decoder_init                                                   |
+//Params:         RecordDecoder* dec      The decoder to reset.                      |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function resets the decoder to the start of a record.         |
+//==================================================================================|
+void rec_decoder_init(RecordDecoder *dec) {
+    memset(dec, 0, sizeof(*dec));
+}
+
+//==================================================FUNCTION========================|
+//Name:           rec_decoder_pending                                                |
+//Params:         const RecordDecoder* dec  The decoder.                             |
+//Returns:        int                     Bytes to read before the decoder is on a   |
+//                                        record boundary, 0 if it already is.       |
+//Outputs:        NONE                                                              |
+//Description:    This function tells a consumer how far to read to finish the       |
+//                record in progress. The answer can grow once a record header is    |
+//                complete, so the caller repeats until it returns 0.                |
+//==================================================================================|
+int rec_decoder_pending(const RecordDecoder *dec) {
+    if (dec->span_left > 0) {
+        return dec->span_left;
+    }
+    if (dec->skip_left > 0) {
+        return dec->skip_left;
+    }
+    if (dec->pending_tag != 0) {
+        return rec_payload_need(dec) - dec->have;
+    }
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           rec_decode                                                         |
+//Params:         RecordDecoder* dec      Decoder state carried between calls.       |
+//                const char* in          Bytes drained from the circular buffer.    |
+//                int len                 Number of bytes in 'in'.                   |
+//                char* symbols           Receives the plain symbols (at most len).  |
+//                const RecordSink* sink  Callbacks for non-symbol records.          |
+//Returns:        int                     Number of symbols written to 'symbols'.    |
+//Outputs:        NONE                                                              |
+//Description:    This function splits a drained span into plain symbols, which are  |
+//                compacted into 'symbols', and records, which go to 'sink'. A record |
+//                cut off at the end of 'in' is completed on the next call, and a    |
+//                channel span cut off that way is delivered in pieces. Unknown tag  |
+//                bytes are dropped, and so is a delta record longer than            |
+//                REC_DELTA_MAX_PAYLOAD, whose payload is skipped without buffering. |
+//                A packed record with more than REC_PACKED_MAX_SYMBOLS symbols is   |
+//                skipped the same way; one with an invalid width has no knowable    |
+//                length, so only its header is dropped. Producers in the tree never |
+//                write either, and ingest and replay refuse them.                   |
+//==================================================================================|
+int rec_decode(RecordDecoder *dec, const char *in, int len, char *symbols, const RecordSink *sink) {
+    const unsigned char *p = (const unsigned char *)in;
+    int count = 0;
+    int need;
+    int take;
+    int i = 0;
+
+    while (i < len) {
+        if (dec->span_left > 0) {
+            take = (len - i < dec->span_left) ? len - i : dec->span_left;
+            if (sink && sink->on_span) {
+                sink->on_span(sink->ctx, dec->span_channel, in + i, take);
+            }
+            dec->span_left -= take;
+            i += take;
+            continue;
+        }
+
+        if (dec->skip_left > 0) {
+            take = (len - i < dec->skip_left) ? len - i : dec->skip_left;
+            dec->skip_left -= take;
+            i += take;
+            continue;
+        }
+
+        if (dec->pending_tag != 0) {
+            need = rec_payload_need(dec) - dec->have;
+            take = (len - i < need) ? len - i : need;
+            memcpy(dec->payload + dec->have, p + i, (size_t)take);
+            dec->have += take;
+            i += take;
+            if (dec->pending_tag == REC_TAG_DELTA && dec->have == 1 &&
+                dec->payload[0] > REC_DELTA_MAX_PAYLOAD) {
+                dec->skip_left = dec->payload[0];
+                dec->pending_tag = 0;
+                dec->have = 0;
+                continue;
+            }
+            if (dec->pending_tag == REC_TAG_PACKED && dec->have == REC_PACKED_HEADER - 1 &&
+                !rec_packed_valid(dec->payload[0], dec->payload[1])) {
+                dec->skip_left = 8 * rec_packed_words(dec->payload[0], dec->payload[1]);
+                dec->pending_tag = 0;
+                dec->have = 0;
+                continue;
+            }
+            if (dec->have == rec_payload_need(dec)) {
+                rec_dispatch(dec, sink);
+            }
+            continue;
+        }
+
+        if (p[i] >= REC_TAG_LIMIT) {
+            symbols[count++] = (char)p[i++];
+            continue;
+        }
+
+        if (rec_payload_size(p[i]) > 0) {
+            dec->pending_tag = p[i];
+            dec->have = 0;
+        }
+        i++;
+    }
+
+    return count;
+}
+
+//==================================================FUNCTION========================|
+//Name:           rec_record_size                                                    |
+//Params:         const char* in          Bytes starting on a record boundary.       |
+//                int len                 Number of bytes in 'in' (> 0).             |
+//Returns:        int                     Size of the record at 'in', 0 if its header|
+//                                        is not complete yet, -1 if it is a delta   |
+//                                        record longer than REC_DELTA_MAX_SIZE or a |
+//                                        packed record rec_decode would not accept. |
+//Outputs:        NONE                                                              |
+//Description:    This function sizes the next record of a foreign byte stream. A    |
+//                plain symbol or an unknown tag is one byte.                        |
+//==================================================================================|
+int rec_record_size(const char *in, int len) {
+    const unsigned char *p = (const unsigned char *)in;
+    int size = (p[0] < REC_TAG_LIMIT) ? rec_payload_size(p[0]) + 1 : 1;
+
+    if (size <= 0) {
+        return 1;
+    }
+    if (p[0] == REC_TAG_CHANNEL) {
+        if (len < REC_CHANNEL_HEADER) {
+            return 0;
+        }
+        size += p[3];
+    } else if (p[0] == REC_TAG_DELTA) {
+        if (len < 2) {
+            return 0;
+        }
+        if (p[1] > REC_DELTA_MAX_PAYLOAD) {
+            return -1;
+        }
+        size += p[1];
+    } else if (p[0] == REC_TAG_PACKED) {
+        if (len < REC_PACKED_HEADER) {
+            return 0;
+        }
+        if (!rec_packed_valid(p[1], p[2])) {
+            return -1;
+        }
+        size += 8 * rec_packed_words(p[1], p[2]);
+    }
+
+    return size;
+}
+
+//==================================================FUNCTION========================|
+//Name:           rec_whole_prefix                                                   |
+//Params:         const char* in          Bytes starting on a record boundary.       |
+//                int len                 Number of bytes in 'in'.                   |
+//                int limit               Most bytes the caller can write.           |
+//Returns:        int                     Length of the longest prefix, no longer    |
+//                                        than 'limit', that ends on a boundary.     |
+//Outputs:        NONE                                                              |
+//Description:    This function lets producers that forward foreign byte streams     |
+//                write only whole records, so a record is never interleaved with    |
+//                another producer's data. The prefix stops before a record          |
+//                rec_record_size rejects, so such a record never reaches the ring;  |
+//                the caller decides what to do with it.                             |
+//==================================================================================|
+int rec_whole_prefix(const char *in, int len, int limit) {
+    int end = (len < limit) ? len : limit;
+    int size;
+    int i = 0;
+
+    while (i < end) {
+        size = rec_record_size(in + i, end - i);
+        if (size <= 0 || i + size > end) {
+            break;
+        }
+        i += size;
+    }
+
+    return i;
+}
+
+//==================================================FUNCTION========================|
+//Name:           rec_encode_sample                                                  |
+//Params:         char* out               Receives REC_SAMPLE_SIZE bytes.            |
+//                uint64_t value          The numeric sample.                        |
+//Returns:        int                     Number of bytes written.                   |
+//Outputs:        NONE                                                              |
+//Description:    This function encodes a numeric sample record.                     |
+//==================================================================================|
+int rec_encode_sample(char *out, uint64_t value) {
+    int i;
+
+    out[0] = REC_TAG_SAMPLE;
+    for (i = 0; i < 8; i++) {
+        out[1 + i] = (char)(value >> (8 * i));
+    }
+
+    return REC_SAMPLE_SIZE;
+}
+
+//==================================================FUNCTION========================|
+//Name:           rec_encode_span                                                    |
+//Params:         char* out               Receives REC_CHANNEL_HEADER + count bytes. |
+//                int channel             Channel id, 0 to 65535.                    |
+//                const char* symbols     The channel's symbols.                     |
+//                int count               Number of symbols, at most REC_SPAN_MAX.   |
+//Returns:        int                     Number of bytes written.                   |
+//Outputs:        NONE                                                              |
+//Description:    This function encodes a run of symbols for one channel.            |
+//==================================================================================|
+int rec_encode_span(char *out, int channel, const char *symbols, int count) {
+    if (count > REC_SPAN_MAX) {
+        count = REC_SPAN_MAX;
+    }
+
+    out[0] = REC_TAG_CHANNEL;
+    out[1] = (char)(channel & 0xff);
+    out[2] = (char)((channel >> 8) & 0xff);
+    out[3] = (char)count;
+    memcpy(out + REC_CHANNEL_HEADER, symbols, (size_t)count);
+
+    return REC_CHANNEL_HEADER + count;
+}
+
+//==================================================FUNCTION========================|
+//Name:           rec_encode_delta                                                   |
+//Params:         char* out               Receives at most REC_DELTA_MAX_SIZE bytes. |
+//                int channel             Channel id, 0 to 65535.                    |
+//                int first_key           Key of bins[0].                            |
+//                const uint32_t* bins    Counts for consecutive keys.               |
+//                int count               Number of bins, at most REC_DELTA_MAX_BINS.|
+//Returns:        int                     Number of bytes written.                   |
+//Outputs:        NONE                                                              |
+//Description:    This function encodes counts a producer aggregated itself. Counts  |
+//                are varints, so a quiet interval costs about one byte per bin.     |
+//==================================================================================|
+int rec_encode_delta(char *out, int channel, int first_key, const uint32_t *bins, int count) {
+    uint32_t value;
+    int len = REC_DELTA_HEADER;
+    int i;
+
+    if (count > REC_DELTA_MAX_BINS) {
+        count = REC_DELTA_MAX_BINS;
+    }
+
+    out[0] = REC_TAG_DELTA;
+    out[2] = (char)(channel & 0xff);
+    out[3] = (char)((channel >> 8) & 0xff);
+    out[4] = (char)first_key;
+    out[5] = (char)count;
+    for (i = 0; i < count; i++) {
+        value = bins[i];
+        while (value >= 0x80) {
+            out[len++] = (char)((value & 0x7f) | 0x80);
+            value >>= 7;
+        }
+        out[len++] = (char)value;
+    }
+    out[1] = (char)(len - 2);
+
+    return len;
+}
+
+//==================================================FUNCTION========================|
+//Name:           rec_packed_bits                                                    |
+//Params:         int alphabet            Number of distinct symbols.                |
+//Returns:        int                     Bits per symbol in a packed record, or -1  |
+//                                        if the alphabet is too large to pack.      |
+//Outputs:        NONE                                                              |
+//Description:    This function picks the packing width from the alphabet size.      |
+//==================================================================================|
+int rec_packed_bits(int alphabet) {
+    int bits = 1;
+
+    while ((1 << bits) < alphabet) {
+        bits++;
+    }
+    return (bits <= REC_PACKED_MAX_BITS) ? bits : -1;
+}
+
+//==================================================FUNCTION========================|
+//Name:           rec_packed_size                                                    |
+//Params:         int count               Symbols to pack.                           |
+//                int bits                Bits per symbol.                           |
+//Returns:        int                     Bytes of the packed record.                |
+//Outputs:        NONE                                                              |
+//Description:    This function sizes a packed record, so a producer can fit one in  |
+//                the free space of the ring. The count is capped as in              |
+//                rec_encode_packed.                                                 |
+//==================================================================================|
+int rec_packed_size(int count, int bits) {
+    if (count > REC_PACKED_MAX_SYMBOLS) {
+        count = REC_PACKED_MAX_SYMBOLS;
+    }
+    return REC_PACKED_HEADER + 8 * rec_packed_words(count, bits);
+}
+
+//==================================================FUNCTION========================|
+//Name:           rec_encode_packed                                                  |
+//Params:         char* out               Receives rec_packed_size(count, bits)      |
+//                                        bytes.                                     |
+//                const char* symbols     Symbols from first_key to                  |
+//                                        first_key + 2^bits - 1.                    |
+//                int count               Number of symbols, at most                 |
+//                                        REC_PACKED_MAX_SYMBOLS.                    |
+//                int first_key           The lowest symbol.                         |
+//                int bits                Bits per symbol, from rec_packed_bits.     |
+//Returns:        int                     Number of bytes written.                   |
+//Outputs:        NONE                                                              |
+//Description:    This function packs a run of channel-0 symbols into 64-bit words.  |
+//==================================================================================|
+int rec_encode_packed(char *out, const char *symbols, int count, int first_key, int bits) {
+    uint64_t mask = ((uint64_t)1 << bits) - 1;
+    uint64_t word;
+    int per_word = 64 / bits;
+    int len = REC_PACKED_HEADER;
+    int i, j, n;
+
+    if (count > REC_PACKED_MAX_SYMBOLS) {
+        count = REC_PACKED_MAX_SYMBOLS;
+    }
+
+    out[0] = REC_TAG_PACKED;
+    out[1] = (char)count;
+    out[2] = (char)bits;
+    out[3] = (char)first_key;
+    for (i = 0; i < count; i += per_word) {
+        n = (count - i < per_word) ? count - i : per_word;
+        word = 0;
+        for (j = 0; j < n; j++) {
+            word |= ((uint64_t)((unsigned char)symbols[i + j] - first_key) & mask) << (j * bits);
+        }
+        for (j = 0; j < 8; j++) {
+            out[len++] = (char)(word >> (8 * j));
+        }
+    }
+
+    return len;
+}
+
+//==================================================FUNCTION========================|
+//Name:           rec_unpack                                                         |
+//Params:         const unsigned char* words  The words of a packed record.          |
+//                int count               Symbols in the record.                     |
+//                int bits                Bits per symbol.                           |
+//                unsigned char* ranks    Receives 'count' values, each a symbol     |
+//                                        minus the record's first key.              |
+//Returns:        int                     Number of values written.                  |
+//Outputs:        NONE                                                              |
+//Description:    This function unpacks a packed record. Every field of a word sits  |
+//                at a fixed shift and no state crosses words, so the inner loop     |
+//                unrolls and vectorises; a last partial word is handled apart.      |
+//==================================================================================|
+int rec_unpack(const unsigned char *words, int count, int bits, unsigned char *ranks) {
+    uint64_t mask = ((uint64_t)1 << bits) - 1;
+    uint64_t word;
+    int per_word = 64 / bits;
+    int full = count / per_word;
+    int w, j;
+
+    for (w = 0; w < full; w++) {
+        word = rec_get_u64(words + 8 * w);
+        for (j = 0; j < per_word; j++) {
+            ranks[w * per_word + j] = (unsigned char)((word >> (j * bits)) & mask);
+        }
+    }
+    if (full * per_word < count) {
+        word = rec_get_u64(words + 8 * full);
+        for (j = 0; full * per_word + j < count; j++) {
+            ranks[full * per_word + j] = (unsigned char)((word >> (j * bits)) & mask);
+        }
+    }
+
+    return count;
+}
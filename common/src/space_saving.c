@@ -0,0 +1,286 @@
+/*
+*	FILE:			space_saving.c
+*	ASSIGNMENT:	    Histogram System
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This file implements the Space-Saving top-K summary. When a new key
+*                 arrives and the summary is full, the key with the smallest count is
+*                 replaced and the new key inherits that count as its error.
+*/
+#include <stdlib.h>
+#include <string.h>
+#include "../inc/space_saving.h"
+#include "../inc/hash_utils.h"
+
+//==================================================FUNCTION========================|
+//Name:           ss_swap                                                            |
+//Params:         SpaceSaving* ss         The summary.                               |
+//                int a, int b            Heap positions to exchange.                |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function swaps two heap positions and fixes their back links. |
+//==================================================================================|
+static void ss_swap(SpaceSaving *ss, int a, int b) {
+    int tmp = ss->heap[a];
+
+    ss->heap[a] = ss->heap[b];
+    ss->heap[b] = tmp;
+    ss->entries[ss->heap[a]].heap_pos = a;
+    ss->entries[ss->heap[b]].heap_pos = b;
+}
+
+//==================================================FUNCTION========================|
+//Name:           ss_sift_down                                                       |
+//Params:         SpaceSaving* ss         The summary.                               |
+//                int pos                 Heap position whose count grew.            |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function restores the min-heap order after a count increase.  |
+//==================================================================================|
+static void ss_sift_down(SpaceSaving *ss, int pos) {
+    int child;
+
+    for (;;) {
+        child = 2 * pos + 1;
+        if (child >= ss->size) {
+            break;
+        }
+        if (child + 1 < ss->size &&
+            ss->entries[ss->heap[child + 1]].count < ss->entries[ss->heap[child]].count) {
+            child++;
+        }
+        if (ss->entries[ss->heap[pos]].count <= ss->entries[ss->heap[child]].count) {
+            break;
+        }
+        ss_swap(ss, pos, child);
+        pos = child;
+    }
+}
+
+//==================================================FUNCTION========================|
+//Name:           ss_sift_up                                                         |
+//Params:         SpaceSaving* ss         The summary.                               |
+//                int pos                 Heap position of a newly added entry.      |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function moves a new entry up to its place in the min-heap.   |
+//==================================================================================|
+static void ss_sift_up(SpaceSaving *ss, int pos) {
+    int parent;
+
+    while (pos > 0) {
+        parent = (pos - 1) / 2;
+        if (ss->entries[ss->heap[parent]].count <= ss->entries[ss->heap[pos]].count) {
+            break;
+        }
+        ss_swap(ss, pos, parent);
+        pos = parent;
+    }
+}
+
+//==================================================FUNCTION========================|
+//Name:           ss_find_slot                                                       |
+//Params:         const SpaceSaving* ss   The summary.                               |
+//                uint64_t key            Key to look for.                           |
+//Returns:        int                     Slot holding the key, or the empty slot    |
+//                                        where it would be inserted.                |
+//Outputs:        NONE                                                              |
+//Description:    This function probes the index linearly from the key's home slot.  |
+//==================================================================================|
+static int ss_find_slot(const SpaceSaving *ss, uint64_t key) {
+    int slot = (int)(hash_u64(key) & (uint64_t)ss->slot_mask);
+
+    while (ss->slots[slot] != 0 && ss->entries[ss->slots[slot] - 1].key != key) {
+        slot = (slot + 1) & ss->slot_mask;
+    }
+
+    return slot;
+}
+
+//==================================================FUNCTION========================|
+//Name:           ss_remove_slot                                                     |
+//Params:         SpaceSaving* ss         The summary.                               |
+//                int slot                Occupied slot to clear.                    |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function deletes from the linear probing index by shifting    |
+//                later members of the probe run back, so no tombstones are needed.  |
+//==================================================================================|
+static void ss_remove_slot(SpaceSaving *ss, int slot) {
+    int next = slot;
+    int home;
+
+    for (;;) {
+        next = (next + 1) & ss->slot_mask;
+        if (ss->slots[next] == 0) {
+            break;
+        }
+        home = (int)(hash_u64(ss->entries[ss->slots[next] - 1].key) & (uint64_t)ss->slot_mask);
+        /* move 'next' into the hole unless its home lies cyclically in (slot, next] */
+        if ((next > slot && (home <= slot || home > next)) ||
+            (next < slot && (home <= slot && home > next))) {
+            ss->slots[slot] = ss->slots[next];
+            slot = next;
+        }
+    }
+    ss->slots[slot] = 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           ss_init                                                            |
+//Params:         SpaceSaving* ss         The summary to initialize.                 |
+//                int capacity            Number of keys to monitor (K).             |
+//Returns:        int                     Returns 0 on success, -1 on failure.       |
+//Outputs:        NONE                                                              |
+//Description:    This function allocates all memory for the summary up front.       |
+//==================================================================================|
+int ss_init(SpaceSaving *ss, int capacity) {
+    int slots = 1;
+
+    if (!ss || capacity <= 0) {
+        return -1;
+    }
+
+    while (slots < capacity * 2) {
+        slots <<= 1;
+    }
+
+    memset(ss, 0, sizeof(*ss));
+    ss->capacity = capacity;
+    ss->slot_mask = slots - 1;
+    ss->entries = calloc((size_t)capacity, sizeof(SsEntry));
+    ss->heap = calloc((size_t)capacity, sizeof(int));
+    ss->slots = calloc((size_t)slots, sizeof(int));
+    if (!ss->entries || !ss->heap || !ss->slots) {
+        ss_free(ss);
+        return -1;
+    }
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           ss_update                                                          |
+//Params:         SpaceSaving* ss         The summary to update.                     |
+//                uint64_t key            The key being counted.                     |
+//                uint64_t count          How many occurrences to add.               |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function adds to a monitored key, or takes over the entry with |
+//                the minimum count when the key is not monitored and the summary is full. |
+//==================================================================================|
+void ss_update(SpaceSaving *ss, uint64_t key, uint64_t count) {
+    int slot = ss_find_slot(ss, key);
+    int index;
+    SsEntry *e;
+
+    ss->total += count;
+
+    if (ss->slots[slot] != 0) {
+        e = &ss->entries[ss->slots[slot] - 1];
+        e->count += count;
+        ss_sift_down(ss, e->heap_pos);
+        return;
+    }
+
+    if (ss->size < ss->capacity) {
+        index = ss->size;
+        e = &ss->entries[index];
+        e->key = key;
+        e->count = count;
+        e->error = 0;
+        e->heap_pos = ss->size;
+        ss->heap[ss->size] = index;
+        ss->size++;
+        ss->slots[slot] = index + 1;
+        ss_sift_up(ss, e->heap_pos);
+        return;
+    }
+
+    index = ss->heap[0];
+    e = &ss->entries[index];
+    ss_remove_slot(ss, ss_find_slot(ss, e->key));
+    e->key = key;
+    e->error = e->count;
+    e->count += count;
+    ss->slots[ss_find_slot(ss, key)] = index + 1;
+    ss_sift_down(ss, 0);
+}
+
+//==================================================FUNCTION========================|
+//Name:           ss_compare_desc                                                    |
+//Params:         const void* a, const void* b   Entries to compare.                 |
+//Returns:        int                     qsort ordering, largest count first.       |
+//Outputs:        NONE                                                              |
+//Description:    This function is the qsort comparator used by ss_top.              |
+//==================================================================================|
+static int ss_compare_desc(const void *a, const void *b) {
+    const SsEntry *ea = a;
+    const SsEntry *eb = b;
+
+    if (ea->count != eb->count) {
+        return (ea->count < eb->count) ? 1 : -1;
+    }
+    return (ea->key > eb->key) - (ea->key < eb->key);
+}
+
+//==================================================FUNCTION========================|
+//Name:           ss_top                                                             |
+//Params:         const SpaceSaving* ss   The summary to query.                      |
+//                SsEntry* out            Array receiving the heaviest entries.      |
+//                int max_out             Size of 'out'.                             |
+//Returns:        int                     Number of entries written.                 |
+//Outputs:        NONE                                                              |
+//Description:    This function copies the monitored entries sorted by count, largest first. |
+//==================================================================================|
+int ss_top(const SpaceSaving *ss, SsEntry *out, int max_out) {
+    SsEntry *sorted;
+    int n;
+
+    if (!ss || !out || max_out <= 0 || ss->size == 0) {
+        return 0;
+    }
+
+    sorted = malloc((size_t)ss->size * sizeof(SsEntry));
+    if (sorted == NULL) {
+        return 0;
+    }
+    memcpy(sorted, ss->entries, (size_t)ss->size * sizeof(SsEntry));
+    qsort(sorted, (size_t)ss->size, sizeof(SsEntry), ss_compare_desc);
+
+    n = (ss->size < max_out) ? ss->size : max_out;
+    memcpy(out, sorted, (size_t)n * sizeof(SsEntry));
+    free(sorted);
+
+    return n;
+}
+
+//==================================================FUNCTION========================|
+//Name:           ss_memory_size                                                     |
+//Params:         const SpaceSaving* ss   The summary to query.                      |
+//Returns:        size_t                  Bytes used by the summary's arrays.        |
+//Outputs:        NONE                                                              |
+//Description:    This function reports the fixed memory footprint of the summary.   |
+//==================================================================================|
+size_t ss_memory_size(const SpaceSaving *ss) {
+    return (size_t)ss->capacity * (sizeof(SsEntry) + sizeof(int)) +
+           (size_t)(ss->slot_mask + 1) * sizeof(int);
+}
+
+//==================================================FUNCTION========================|
+//Name:           ss_free                                                            |
+//Params:         SpaceSaving* ss         The summary to release.                    |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function frees the summary's arrays.                          |
+//==================================================================================|
+void ss_free(SpaceSaving *ss) {
+    if (!ss) {
+        return;
+    }
+    free(ss->entries);
+    free(ss->heap);
+    free(ss->slots);
+    ss->entries = NULL;
+    ss->heap = NULL;
+    ss->slots = NULL;
+}
@@ -0,0 +1,607 @@
+/*
+*	FILE:			stream_log.c
+*	ASSIGNMENT:	    Histogram System
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This file implements the stream log described in stream_log.h:
+*                 building blocks in memory, the alphabet-packing codec, and writing
+*                 and reading segment files.
+*/
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "../inc/histo_file.h"
+#include "../inc/stream_log.h"
+
+//==================================================FUNCTION========================|
+//Name:           sl_put_u32 / sl_put_u64                                            |
+//Params:         unsigned char* p        Output position.                           |
+//                value                   Value to store little-endian.              |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    These functions store fixed-size header fields.                    |
+//==================================================================================|
+static void sl_put_u32(unsigned char *p, uint32_t value) {
+    int i;
+
+    for (i = 0; i < 4; i++) {
+        p[i] = (unsigned char)(value >> (8 * i));
+    }
+}
+
+static void sl_put_u64(unsigned char *p, uint64_t value) {
+    int i;
+
+    for (i = 0; i < 8; i++) {
+        p[i] = (unsigned char)(value >> (8 * i));
+    }
+}
+
+//==================================================FUNCTION========================|
+//Name:           sl_get_u32 / sl_get_u64                                            |
+//Params:         const unsigned char* p  Little-endian bytes.                       |
+//Returns:        The decoded value.                                                 |
+//Outputs:        NONE                                                              |
+//Description:    These functions read fixed-size header fields.                     |
+//==================================================================================|
+static uint32_t sl_get_u32(const unsigned char *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+           ((uint32_t)p[3] << 24);
+}
+
+static uint64_t sl_get_u64(const unsigned char *p) {
+    return (uint64_t)sl_get_u32(p) | ((uint64_t)sl_get_u32(p + 4) << 32);
+}
+
+//==================================================FUNCTION========================|
+//Name:           sl_block_init                                                      |
+//Params:         SlBlock* block          The block to set up.                       |
+//                size_t data_cap         Span bytes the block holds before it is    |
+//                                        full.                                      |
+//Returns:        int                     Returns 0 on success, -1 on failure.        |
+//Outputs:        NONE                                                              |
+//Description:    This function allocates a block's buffers once; blocks are reset   |
+//                and reused rather than freed.                                      |
+//==================================================================================|
+int sl_block_init(SlBlock *block, size_t data_cap) {
+    memset(block, 0, sizeof(*block));
+    block->data_cap = data_cap;
+    block->index_cap = data_cap + 2 * HF_MAX_VARINT;
+    block->data = malloc(block->data_cap);
+    block->index = malloc(block->index_cap);
+    if (block->data == NULL || block->index == NULL) {
+        sl_block_free(block);
+        return -1;
+    }
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           sl_block_add                                                       |
+//Params:         SlBlock* block          The block being filled.                    |
+//                uint64_t now_us         When the span was drained.                 |
+//                const char* span        The drained bytes.                         |
+//                int len                 Number of bytes.                           |
+//Returns:        int                     0 if added, -1 if the block is full.       |
+//Outputs:        NONE                                                              |
+//Description:    This function appends one drained span and its time to the block.  |
+//==================================================================================|
+int sl_block_add(SlBlock *block, uint64_t now_us, const char *span, int len) {
+    if (len <= 0) {
+        return 0;
+    }
+    if (block->data_len + (size_t)len > block->data_cap ||
+        block->index_len + 2 * HF_MAX_VARINT > block->index_cap) {
+        return -1;
+    }
+
+    if (block->span_count == 0) {
+        block->base_us = now_us;
+        block->last_us = now_us;
+    }
+    if (now_us < block->last_us) {
+        now_us = block->last_us;
+    }
+
+    block->index_len += (size_t)hf_put_varint(block->index + block->index_len, now_us - block->last_us);
+    block->index_len += (size_t)hf_put_varint(block->index + block->index_len, (uint64_t)len);
+    memcpy(block->data + block->data_len, span, (size_t)len);
+    block->data_len += (size_t)len;
+    block->last_us = now_us;
+    block->span_count++;
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           sl_block_reset                                                     |
+//Params:         SlBlock* block          The block to empty.                        |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function empties a block, keeping its buffers.                |
+//==================================================================================|
+void sl_block_reset(SlBlock *block) {
+    block->base_us = 0;
+    block->last_us = 0;
+    block->span_count = 0;
+    block->index_len = 0;
+    block->data_len = 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           sl_block_free                                                      |
+//Params:         SlBlock* block          The block to release.                      |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function frees a block's buffers.                             |
+//==================================================================================|
+void sl_block_free(SlBlock *block) {
+    free(block->data);
+    free(block->index);
+    memset(block, 0, sizeof(*block));
+}
+
+//==================================================FUNCTION========================|
+//Name:           sl_cursor_init                                                     |
+//Params:         const SlBlock* block    Block to walk.                             |
+//                SlCursor* cursor        Cursor to position at the first span.      |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function starts a walk over a block's spans.                  |
+//==================================================================================|
+void sl_cursor_init(const SlBlock *block, SlCursor *cursor) {
+    cursor->index_pos = 0;
+    cursor->data_pos = 0;
+    cursor->at_us = block->base_us;
+}
+
+//==================================================FUNCTION========================|
+//Name:           sl_block_next_span                                                 |
+//Params:         const SlBlock* block    Block being walked.                        |
+//                SlCursor* cursor        Position, advanced past the span.          |
+//                const char** span       Receives a pointer into the block's data.  |
+//                int* len                Receives the span length.                  |
+//Returns:        int                     1 for a span, 0 at the end, -1 if the      |
+//                                        index does not match the data.             |
+//Outputs:        NONE                                                              |
+//Description:    This function returns the next span and sets cursor->at_us to the |
+//                time it was drained.                                               |
+//==================================================================================|
+int sl_block_next_span(const SlBlock *block, SlCursor *cursor, const char **span, int *len) {
+    const unsigned char *p = block->index + cursor->index_pos;
+    const unsigned char *end = block->index + block->index_len;
+    uint64_t delta;
+    uint64_t size;
+
+    if (p == end) {
+        return 0;
+    }
+    if (hf_get_varint(&p, end, &delta) == -1 || hf_get_varint(&p, end, &size) == -1 ||
+        size > block->data_len - cursor->data_pos) {
+        return -1;
+    }
+
+    cursor->index_pos = (size_t)(p - block->index);
+    cursor->at_us += delta;
+    *span = (const char *)block->data + cursor->data_pos;
+    *len = (int)size;
+    cursor->data_pos += (size_t)size;
+
+    return 1;
+}
+
+//==================================================FUNCTION========================|
+//Name:           sl_pack                                                            |
+//Params:         const unsigned char* in  Bytes to code.                            |
+//                size_t len              Number of bytes.                           |
+//                unsigned char* out      Receives at most 1 + SL_PACK_MAX_SYMBOLS + |
+//                                        len bytes.                                 |
+//Returns:        size_t                  Coded length, or 0 if the alphabet is too |
+//                                        large for packing to pay off.              |
+//Outputs:        NONE                                                              |
+//Description:    This function codes each byte as its rank in the block's sorted    |
+//                alphabet, using ceil(log2(alphabet size)) bits LSB-first.          |
+//==================================================================================|
+size_t sl_pack(const unsigned char *in, size_t len, unsigned char *out) {
+    unsigned char rank[256];
+    unsigned char seen[256] = {0};
+    unsigned char *p;
+    uint64_t acc = 0;
+    int acc_bits = 0;
+    int symbols = 0;
+    int bits = 1;
+    size_t i;
+    int c;
+
+    for (i = 0; i < len; i++) {
+        seen[in[i]] = 1;
+    }
+
+    p = out + 1;
+    for (c = 0; c < 256; c++) {
+        if (seen[c]) {
+            if (symbols == SL_PACK_MAX_SYMBOLS) {
+                return 0;
+            }
+            rank[c] = (unsigned char)symbols++;
+            *p++ = (unsigned char)c;
+        }
+    }
+    out[0] = (unsigned char)symbols;
+    while ((1 << bits) < symbols) {
+        bits++;
+    }
+
+    for (i = 0; i < len; i++) {
+        acc |= (uint64_t)rank[in[i]] << acc_bits;
+        acc_bits += bits;
+        if (acc_bits >= 32) {
+            sl_put_u32(p, (uint32_t)acc);
+            p += 4;
+            acc >>= 32;
+            acc_bits -= 32;
+        }
+    }
+    while (acc_bits > 0) {
+        *p++ = (unsigned char)acc;
+        acc >>= 8;
+        acc_bits -= 8;
+    }
+
+    return (size_t)(p - out);
+}
+
+//==================================================FUNCTION========================|
+//Name:           sl_unpack                                                          |
+//Params:         const unsigned char* in  Coded bytes from sl_pack.                 |
+//                size_t in_len           Number of coded bytes.                     |
+//                unsigned char* out      Receives 'out_len' bytes.                  |
+//                size_t out_len          Original length.                           |
+//Returns:        int                     Returns 0 on success, -1 if corrupt.       |
+//Outputs:        NONE                                                              |
+//Description:    This function reverses sl_pack.                                    |
+//==================================================================================|
+int sl_unpack(const unsigned char *in, size_t in_len, unsigned char *out, size_t out_len) {
+    const unsigned char *alphabet;
+    const unsigned char *p;
+    const unsigned char *end = in + in_len;
+    uint64_t acc = 0;
+    uint32_t mask;
+    int acc_bits = 0;
+    int symbols;
+    int bits = 1;
+    unsigned int code;
+    size_t i;
+
+    if (in_len < 1 || in[0] == 0 || (size_t)in[0] + 1 > in_len) {
+        return -1;
+    }
+    symbols = in[0];
+    alphabet = in + 1;
+    p = in + 1 + symbols;
+    while ((1 << bits) < symbols) {
+        bits++;
+    }
+    mask = (1u << bits) - 1;
+
+    for (i = 0; i < out_len; i++) {
+        while (acc_bits < bits) {
+            if (p == end) {
+                return -1;
+            }
+            acc |= (uint64_t)*p++ << acc_bits;
+            acc_bits += 8;
+        }
+        code = (unsigned int)(acc & mask);
+        acc >>= bits;
+        acc_bits -= bits;
+        if (code >= (unsigned int)symbols) {
+            return -1;
+        }
+        out[i] = alphabet[code];
+    }
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           sl_writer_open                                                     |
+//Params:         SlWriter* writer        The writer to set up.                      |
+//                const char* prefix      Segment files are "<prefix>.NNNNNN.hsl".   |
+//                uint64_t segment_limit  Bytes after which a new segment starts.    |
+//Returns:        int                     Returns 0 on success, -1 on failure.        |
+//Outputs:        NONE                                                              |
+//Description:    This function prepares a writer; the first segment is created by   |
+//                the first block. Numbering continues after the last segment       |
+//                already on disk, so a restarted DC adds to an earlier recording   |
+//                instead of overwriting it.                                         |
+//==================================================================================|
+int sl_writer_open(SlWriter *writer, const char *prefix, uint64_t segment_limit) {
+    char path[4096 + 16];
+    struct stat info;
+
+    memset(writer, 0, sizeof(*writer));
+    if (strlen(prefix) + 16 > sizeof(writer->prefix)) {
+        fprintf(stderr, "stream log: prefix too long\n");
+        return -1;
+    }
+    strcpy(writer->prefix, prefix);
+    writer->segment_limit = segment_limit;
+
+    for (;;) {
+        snprintf(path, sizeof(path), "%s.%06d.hsl", prefix, writer->sequence);
+        if (stat(path, &info) == -1) {
+            break;
+        }
+        writer->sequence++;
+    }
+
+    /* build the CRC table now, before any thread uses it */
+    hf_crc32((const unsigned char *)"", 0);
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           sl_writer_rotate                                                   |
+//Params:         SlWriter* writer        The writer.                                |
+//Returns:        int                     Returns 0 on success, -1 on failure.        |
+//Outputs:        Creates the next segment file                                     |
+//Description:    This function closes the current segment and starts the next one. |
+//                Segments are created exclusively: a number taken in the meantime  |
+//                is skipped, and an existing segment is never truncated.           |
+//==================================================================================|
+static int sl_writer_rotate(SlWriter *writer) {
+    char path[4096 + 16];
+    int fd;
+
+    if (writer->fp != NULL) {
+        fclose(writer->fp);
+        writer->fp = NULL;
+    }
+
+    do {
+        snprintf(path, sizeof(path), "%s.%06d.hsl", writer->prefix, writer->sequence++);
+        fd = open(path, O_WRONLY | O_CREAT | O_EXCL, 0644);
+    } while (fd == -1 && errno == EEXIST);
+    if (fd == -1) {
+        perror("stream log open");
+        return -1;
+    }
+    writer->fp = fdopen(fd, "wb");
+    if (writer->fp == NULL) {
+        perror("stream log fdopen");
+        close(fd);
+        return -1;
+    }
+    if (fwrite(SL_MAGIC, 1, SL_MAGIC_SIZE, writer->fp) != SL_MAGIC_SIZE) {
+        perror("stream log write");
+        return -1;
+    }
+    writer->segment_bytes = SL_MAGIC_SIZE;
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           sl_writer_write_block                                              |
+//Params:         SlWriter* writer        The writer.                                |
+//                const SlBlock* block    A filled block.                            |
+//Returns:        int                     Returns 0 on success, -1 on failure.        |
+//Outputs:        Appends the block to the current segment                          |
+//Description:    This function codes the block's data, packing it when that is      |
+//                smaller, and appends the block, starting a new segment when the    |
+//                current one would pass its size limit.                             |
+//==================================================================================|
+int sl_writer_write_block(SlWriter *writer, const SlBlock *block) {
+    unsigned char header[SL_BLOCK_HEADER];
+    const unsigned char *stored = block->data;
+    size_t stored_len = block->data_len;
+    size_t need = 1 + SL_PACK_MAX_SYMBOLS + block->data_len;
+    unsigned char *grown;
+    uint64_t size;
+    uint32_t crc;
+    int codec = SL_CODEC_RAW;
+    size_t packed;
+
+    if (block->span_count == 0) {
+        return 0;
+    }
+
+    if (need > writer->stored_cap) {
+        grown = realloc(writer->stored, need);
+        if (grown == NULL) {
+            return -1;
+        }
+        writer->stored = grown;
+        writer->stored_cap = need;
+    }
+    packed = sl_pack(block->data, block->data_len, writer->stored);
+    if (packed > 0 && packed < block->data_len) {
+        stored = writer->stored;
+        stored_len = packed;
+        codec = SL_CODEC_PACKED;
+    }
+
+    size = SL_BLOCK_HEADER + block->index_len + stored_len;
+    if (writer->fp == NULL ||
+        (writer->segment_bytes > SL_MAGIC_SIZE && writer->segment_bytes + size > writer->segment_limit)) {
+        if (sl_writer_rotate(writer) == -1) {
+            return -1;
+        }
+    }
+
+    crc = hf_crc32(block->index, block->index_len) ^ hf_crc32(stored, stored_len);
+
+    memset(header, 0, sizeof(header));
+    sl_put_u32(header, (uint32_t)block->index_len);
+    sl_put_u32(header + 4, (uint32_t)block->data_len);
+    sl_put_u32(header + 8, (uint32_t)stored_len);
+    sl_put_u32(header + 12, block->span_count);
+    sl_put_u64(header + 16, block->base_us);
+    header[24] = (unsigned char)codec;
+    sl_put_u32(header + 28, crc);
+
+    if (fwrite(header, 1, sizeof(header), writer->fp) != sizeof(header) ||
+        fwrite(block->index, 1, block->index_len, writer->fp) != block->index_len ||
+        fwrite(stored, 1, stored_len, writer->fp) != stored_len || fflush(writer->fp) != 0) {
+        perror("stream log write");
+        return -1;
+    }
+    writer->segment_bytes += size;
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           sl_writer_close                                                    |
+//Params:         SlWriter* writer        The writer.                                |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function closes the current segment and frees the buffer.     |
+//==================================================================================|
+void sl_writer_close(SlWriter *writer) {
+    if (writer->fp != NULL) {
+        fclose(writer->fp);
+        writer->fp = NULL;
+    }
+    free(writer->stored);
+    writer->stored = NULL;
+    writer->stored_cap = 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           sl_reader_open                                                     |
+//Params:         SlReader* reader        The reader to set up.                      |
+//                const char* path        A segment file.                            |
+//Returns:        int                     Returns 0 on success, -1 on failure.        |
+//Outputs:        Prints an error for unreadable or foreign files                   |
+//Description:    This function opens a segment and checks its magic.                |
+//==================================================================================|
+int sl_reader_open(SlReader *reader, const char *path) {
+    char magic[SL_MAGIC_SIZE];
+
+    memset(reader, 0, sizeof(*reader));
+    reader->fp = fopen(path, "rb");
+    if (reader->fp == NULL) {
+        perror(path);
+        return -1;
+    }
+    if (fread(magic, 1, SL_MAGIC_SIZE, reader->fp) != SL_MAGIC_SIZE ||
+        memcmp(magic, SL_MAGIC, SL_MAGIC_SIZE) != 0) {
+        fprintf(stderr, "%s: not a stream log segment\n", path);
+        fclose(reader->fp);
+        reader->fp = NULL;
+        return -1;
+    }
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           sl_reader_grow                                                     |
+//Params:         unsigned char** buffer  Buffer to grow.                            |
+//                size_t* cap             Its capacity.                              |
+//                size_t need             Bytes required.                            |
+//Returns:        int                     Returns 0 on success, -1 on failure.        |
+//Outputs:        NONE                                                              |
+//Description:    This function grows a reused buffer when a block needs more room.  |
+//==================================================================================|
+static int sl_reader_grow(unsigned char **buffer, size_t *cap, size_t need) {
+    unsigned char *grown;
+
+    if (need <= *cap) {
+        return 0;
+    }
+    grown = realloc(*buffer, need);
+    if (grown == NULL) {
+        return -1;
+    }
+    *buffer = grown;
+    *cap = need;
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           sl_reader_next                                                     |
+//Params:         SlReader* reader        An open reader.                            |
+//                SlBlock* block          Receives the block; its buffers are grown  |
+//                                        as needed (zero it before first use).      |
+//Returns:        int                     1 for a block, 0 at the end of the segment,|
+//                                        -1 if the block is truncated or corrupt.   |
+//Outputs:        NONE                                                              |
+//Description:    This function reads, checks and decodes the next block.            |
+//==================================================================================|
+int sl_reader_next(SlReader *reader, SlBlock *block) {
+    unsigned char header[SL_BLOCK_HEADER];
+    size_t index_len, data_len, stored_len;
+    const unsigned char *stored;
+    size_t got;
+    uint32_t crc;
+
+    got = fread(header, 1, sizeof(header), reader->fp);
+    if (got == 0) {
+        return 0;
+    }
+    if (got != sizeof(header)) {
+        return -1;
+    }
+
+    index_len = sl_get_u32(header);
+    data_len = sl_get_u32(header + 4);
+    stored_len = sl_get_u32(header + 8);
+    if (sl_reader_grow(&block->index, &block->index_cap, index_len + 1) == -1 ||
+        sl_reader_grow(&block->data, &block->data_cap, data_len + 1) == -1 ||
+        sl_reader_grow(&reader->stored, &reader->stored_cap, stored_len + 1) == -1) {
+        return -1;
+    }
+
+    if (fread(block->index, 1, index_len, reader->fp) != index_len ||
+        fread(reader->stored, 1, stored_len, reader->fp) != stored_len) {
+        return -1;
+    }
+    crc = hf_crc32(block->index, index_len) ^ hf_crc32(reader->stored, stored_len);
+    if (crc != sl_get_u32(header + 28)) {
+        return -1;
+    }
+
+    stored = reader->stored;
+    if (header[24] == SL_CODEC_PACKED) {
+        if (sl_unpack(stored, stored_len, block->data, data_len) == -1) {
+            return -1;
+        }
+    } else if (header[24] == SL_CODEC_RAW && stored_len == data_len) {
+        memcpy(block->data, stored, data_len);
+    } else {
+        return -1;
+    }
+
+    block->index_len = index_len;
+    block->data_len = data_len;
+    block->span_count = sl_get_u32(header + 12);
+    block->base_us = sl_get_u64(header + 16);
+    block->last_us = block->base_us;
+
+    return 1;
+}
+
+//==================================================FUNCTION========================|
+//Name:           sl_reader_close                                                    |
+//Params:         SlReader* reader        The reader.                                |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function closes the segment and frees the buffer.             |
+//==================================================================================|
+void sl_reader_close(SlReader *reader) {
+    if (reader->fp != NULL) {
+        fclose(reader->fp);
+        reader->fp = NULL;
+    }
+    free(reader->stored);
+    reader->stored = NULL;
+    reader->stored_cap = 0;
+}
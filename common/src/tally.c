@@ -0,0 +1,90 @@
+/*
+*	FILE:			tally.c
+*	ASSIGNMENT:	    Histogram System
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This file implements DC's counting loops for plain symbols and
+*                 packed records.
+*/
+#include <string.h>
+#include "../inc/constants.h"
+#include "../inc/record.h"
+#include "../inc/tally.h"
+
+//==================================================FUNCTION========================|
+//Name:           tally_symbols                                                      |
+//Params:         const char* symbols     Plain symbols.                             |
+//                int n                   Number of symbols.                         |
+//                uint64_t* counts        The histogram, indexed by symbol -         |
+//                                        CHAR_START.                                |
+//                uint32_t* bins          A channel histogram counted alongside, or  |
+//                                        NULL.                                      |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function counts every symbol in CHAR_START..CHAR_END and      |
+//                ignores the rest.                                                  |
+//==================================================================================|
+void tally_symbols(const char *symbols, int n, uint64_t *counts, uint32_t *bins) {
+    int i;
+
+    for (i = 0; i < n; i++) {
+        if (symbols[i] >= CHAR_START && symbols[i] <= CHAR_END) {
+            counts[symbols[i] - CHAR_START]++;
+            if (bins != NULL) {
+                bins[symbols[i] - CHAR_START]++;
+            }
+        }
+    }
+}
+
+//==================================================FUNCTION========================|
+//Name:           tally_packed                                                       |
+//Params:         const unsigned char* words  The packed words.                      |
+//                int count               Number of symbols.                         |
+//                int bits                Bits per symbol.                           |
+//                int first_key           The record's lowest symbol.                |
+//                unsigned char* ranks    Receives the unpacked ranks (symbol -      |
+//                                        first_key), REC_PACKED_MAX_SYMBOLS long.   |
+//                uint64_t* counts        The histogram, as for tally_symbols.       |
+//                uint32_t* bins          A channel histogram, or NULL.              |
+//Returns:        int                     Number of symbols unpacked.                |
+//Outputs:        NONE                                                              |
+//Description:    This function unpacks a packed record and counts it into four      |
+//                interleaved tallies, so a run of one symbol does not make each     |
+//                increment wait on the last; the tallies are then folded into       |
+//                'counts' once per symbol value.                                    |
+//==================================================================================|
+int tally_packed(const unsigned char *words, int count, int bits, int first_key,
+                 unsigned char *ranks, uint64_t *counts, uint32_t *bins) {
+    uint32_t tally[4][1 << REC_PACKED_MAX_BITS];
+    uint32_t sum;
+    int key;
+    int n;
+    int i;
+
+    memset(tally, 0, sizeof(tally));
+    n = rec_unpack(words, count, bits, ranks);
+
+    for (i = 0; i + 4 <= n; i += 4) {
+        tally[0][ranks[i]]++;
+        tally[1][ranks[i + 1]]++;
+        tally[2][ranks[i + 2]]++;
+        tally[3][ranks[i + 3]]++;
+    }
+    for (; i < n; i++) {
+        tally[0][ranks[i]]++;
+    }
+
+    for (i = 0; i < (1 << bits); i++) {
+        sum = tally[0][i] + tally[1][i] + tally[2][i] + tally[3][i];
+        key = first_key + i;
+        if (sum == 0 || key < CHAR_START || key > CHAR_END) {
+            continue;
+        }
+        counts[key - CHAR_START] += sum;
+        if (bins != NULL) {
+            bins[key - CHAR_START] += sum;
+        }
+    }
+
+    return n;
+}
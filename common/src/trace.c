@@ -0,0 +1,247 @@
+/*
+*	FILE:			trace.c
+*	ASSIGNMENT:	    Histogram System
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This file implements the per-process trace ring. The ring lives in
+*                 a memory-mapped file so it survives the process and can be read by
+*                 trace-export while the pipeline is still running.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "../inc/trace.h"
+#include "../inc/config.h"
+
+int trace_enabled = 0;
+
+static TraceRing *ring = NULL;
+static size_t ring_bytes = 0;
+static uint64_t ring_mask = 0;
+static char process_name[TRACE_NAME_LEN];
+static uint64_t base_tsc = 0;
+static uint64_t base_ns = 0;
+static double tsc_per_ns = 1.0;
+
+static const char *event_names[TRACE_EVENT_COUNT] = {
+    "lock_wait", "lock_held", "write", "ring_full", "read", "render"
+};
+
+//==================================================FUNCTION========================|
+//Name:           trace_clock                                                        |
+//Params:         NONE                                                              |
+//Returns:        uint64_t                The current timestamp counter.             |
+//Outputs:        NONE                                                              |
+//Description:    This function reads the TSC, or the monotonic clock in ns where no |
+//                TSC is available.                                                  |
+//==================================================================================|
+static uint64_t trace_clock(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+//==================================================FUNCTION========================|
+//Name:           trace_wall_ns                                                      |
+//Params:         NONE                                                              |
+//Returns:        uint64_t                CLOCK_REALTIME in nanoseconds.             |
+//Outputs:        NONE                                                              |
+//Description:    This function reads the wall clock shared by all processes.        |
+//==================================================================================|
+static uint64_t trace_wall_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+//==================================================FUNCTION========================|
+//Name:           trace_calibrate                                                    |
+//Params:         NONE                                                              |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function measures the TSC rate over everything since          |
+//                trace_init took its base readings, so the estimate gets better the |
+//                longer the process runs and costs no sleep. The mapped ring gets   |
+//                the new rate at once.                                              |
+//==================================================================================|
+static void trace_calibrate(void) {
+    uint64_t tsc = trace_clock();
+    uint64_t ns = trace_wall_ns();
+
+    if (ns > base_ns && tsc > base_tsc) {
+        tsc_per_ns = (double)(tsc - base_tsc) / (double)(ns - base_ns);
+    }
+    if (ring != NULL) {
+        ring->tsc_per_ns = tsc_per_ns;
+    }
+}
+
+//==================================================FUNCTION========================|
+//Name:           trace_map                                                          |
+//Params:         NONE                                                              |
+//Returns:        int                     Returns 0 on success, -1 on failure.       |
+//Outputs:        Creates HISTO_TRACE_DIR/histo-trace.<pid>                         |
+//Description:    This function creates and maps the ring, stamped with the base     |
+//                readings trace_init took and the latest TSC rate.                  |
+//==================================================================================|
+static int trace_map(void) {
+    char path[4096];
+    int capacity;
+    int fd;
+
+    capacity = config_get_int("HISTO_TRACE_EVENTS", TRACE_DEFAULT_CAPACITY);
+    if (capacity <= 0 || (capacity & (capacity - 1)) != 0) {
+        capacity = TRACE_DEFAULT_CAPACITY;
+    }
+    ring_bytes = sizeof(TraceRing) + (size_t)capacity * sizeof(TraceEvent);
+
+    snprintf(path, sizeof(path), "%s/%s%d", config_get_str("HISTO_TRACE_DIR", "/dev/shm"),
+             TRACE_FILE_PREFIX, (int)getpid());
+    fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) {
+        perror("trace open");
+        return -1;
+    }
+    if (ftruncate(fd, (off_t)ring_bytes) == -1) {
+        perror("trace ftruncate");
+        close(fd);
+        return -1;
+    }
+    ring = mmap(NULL, ring_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (ring == MAP_FAILED) {
+        perror("trace mmap");
+        ring = NULL;
+        return -1;
+    }
+
+    ring->pid = (uint32_t)getpid();
+    memcpy(ring->name, process_name, TRACE_NAME_LEN);
+    ring->capacity = (uint32_t)capacity;
+    ring_mask = (uint64_t)capacity - 1;
+
+    ring->base_tsc = base_tsc;
+    ring->base_ns = base_ns;
+    ring->tsc_per_ns = tsc_per_ns;
+    ring->position = 0;
+    __atomic_store_n(&ring->magic, TRACE_MAGIC, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           trace_init                                                         |
+//Params:         const char* name        Process name shown in the trace viewer.    |
+//Returns:        int                     Returns 0 on success, -1 on failure.       |
+//Outputs:        NONE                                                              |
+//Description:    This function records the process name and the base TSC and wall   |
+//                clock readings, and switches tracing on if HISTO_TRACE is set.     |
+//                Only then does it wait a few milliseconds for a first TSC rate; a  |
+//                process that never traces starts without the wait, and one traced  |
+//                later by histo-ctl gets its rate from the time since start.        |
+//                Tracing failures never stop the process.                           |
+//==================================================================================|
+int trace_init(const char *name) {
+    strncpy(process_name, name, TRACE_NAME_LEN - 1);
+
+    base_tsc = trace_clock();
+    base_ns = trace_wall_ns();
+
+    if (config_get_int("HISTO_TRACE", 0)) {
+        usleep(10000);
+        return trace_set_enabled(1);
+    }
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           trace_set_enabled                                                  |
+//Params:         int enabled             1 to record events, 0 to stop.             |
+//Returns:        int                     Returns 0 on success, -1 on failure.       |
+//Outputs:        NONE                                                              |
+//Description:    This function toggles tracing at run time. The ring is mapped the  |
+//                first time tracing is switched on and kept when it is switched     |
+//                off, so toggling again costs nothing. Every toggle refreshes the   |
+//                TSC rate.                                                          |
+//==================================================================================|
+int trace_set_enabled(int enabled) {
+    trace_calibrate();
+    if (enabled && ring == NULL && trace_map() == -1) {
+        return -1;
+    }
+
+    trace_enabled = enabled ? 1 : 0;
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           trace_emit                                                         |
+//Params:         int id                  Event id (TRACE_LOCK_WAIT, ...).           |
+//                int phase               TRACE_PHASE_BEGIN, _END or _INSTANT.       |
+//                uint32_t arg            Event argument, e.g. a byte count.         |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function appends one event to the ring. The slot is claimed   |
+//                with an atomic add, so threads of one process may share the ring.  |
+//==================================================================================|
+void trace_emit(int id, int phase, uint32_t arg) {
+    TraceEvent *ev;
+    uint64_t pos;
+
+    if (ring == NULL) {
+        return;
+    }
+
+    pos = __atomic_fetch_add(&ring->position, 1, __ATOMIC_RELAXED);
+    ev = &ring->events[pos & ring_mask];
+    ev->tsc = trace_clock();
+    ev->arg = arg;
+    ev->id = (uint16_t)id;
+    ev->phase = (uint8_t)phase;
+}
+
+//==================================================FUNCTION========================|
+//Name:           trace_event_name                                                   |
+//Params:         int id                  Event id.                                  |
+//Returns:        const char*             Name used in the exported trace.           |
+//Outputs:        NONE                                                              |
+//Description:    This function maps an event id to its display name.                |
+//==================================================================================|
+const char *trace_event_name(int id) {
+    if (id < 0 || id >= TRACE_EVENT_COUNT) {
+        return "unknown";
+    }
+
+    return event_names[id];
+}
+
+//==================================================FUNCTION========================|
+//Name:           trace_close                                                        |
+//Params:         NONE                                                              |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function stops tracing and unmaps the ring, leaving it the    |
+//                TSC rate measured over the whole run. The file is kept for         |
+//                trace-export.                                                      |
+//==================================================================================|
+void trace_close(void) {
+    trace_enabled = 0;
+    if (ring != NULL) {
+        trace_calibrate();
+        munmap(ring, ring_bytes);
+        ring = NULL;
+    }
+}
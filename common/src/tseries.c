@@ -0,0 +1,725 @@
+/*
+*	FILE:			tseries.c
+*	ASSIGNMENT:	    Histogram System
+*	PROGRAMMERS:	Quang Minh Vu
+*	DESCRIPTION:	This file implements the histogram time series: the segment
+*                 writer DC appends interval records with, the rollups into the hour
+*                 and day levels, and the scans and range sums the query tool uses.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "../inc/tseries.h"
+
+static const uint32_t level_spans[TS_LEVELS] = { 0, 3600, 86400 };
+
+typedef struct {
+    TsWriter *upper;
+    uint32_t span;
+    TsRecord sum;
+    int failed;
+} TsRollup;
+
+//==================================================FUNCTION========================|
+//Name:           ts_level_span                                                      |
+//Params:         int level              A level below TS_LEVELS.                    |
+//Returns:        uint32_t               Seconds per record at a rollup level, 0 for |
+//                                       level 0, whose interval is per segment.     |
+//Outputs:        NONE                                                              |
+//Description:    This function gives the period a rollup record covers.             |
+//==================================================================================|
+uint32_t ts_level_span(int level) {
+    return (level > 0 && level < TS_LEVELS) ? level_spans[level] : 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           ts_segment_path                                                    |
+//Params:         const char* prefix     The series prefix.                          |
+//                int level              The level.                                  |
+//                int sequence           The segment number.                         |
+//                char* out              Receives the path.                          |
+//                size_t size            Size of 'out'.                              |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function names a segment file.                                |
+//==================================================================================|
+static void ts_segment_path(const char *prefix, int level, int sequence, char *out, size_t size) {
+    snprintf(out, size, "%s.L%d.%06d.hts", prefix, level, sequence);
+}
+
+//==================================================FUNCTION========================|
+//Name:           ts_map                                                             |
+//Params:         const char* path       A segment file.                             |
+//                int level              The level it must belong to.                |
+//                int writable           1 to map it for appending.                  |
+//                size_t* size           Receives the mapped size.                   |
+//Returns:        TsHeader*              The mapped segment, or NULL. errno is       |
+//                                       ENOENT if the file does not exist.          |
+//Outputs:        Prints an error for a file that is not a segment of this level     |
+//Description:    This function maps a whole segment.                                |
+//==================================================================================|
+static TsHeader *ts_map(const char *path, int level, int writable, size_t *size) {
+    struct stat info;
+    TsHeader *header;
+    int fd;
+
+    fd = open(path, writable ? O_RDWR : O_RDONLY);
+    if (fd == -1) {
+        return NULL;
+    }
+    if (fstat(fd, &info) == -1 || (size_t)info.st_size < TS_HEADER_SIZE) {
+        fprintf(stderr, "%s: not a time series segment\n", path);
+        close(fd);
+        errno = EINVAL;
+        return NULL;
+    }
+
+    header = mmap(NULL, (size_t)info.st_size, writable ? PROT_READ | PROT_WRITE : PROT_READ,
+                  MAP_SHARED, fd, 0);
+    close(fd);
+    if (header == MAP_FAILED) {
+        perror(path);
+        return NULL;
+    }
+    if (memcmp(header->magic, TS_MAGIC, TS_MAGIC_SIZE) != 0 || header->level != (uint32_t)level ||
+        TS_HEADER_SIZE + header->data_size > (uint64_t)info.st_size) {
+        fprintf(stderr, "%s: not a level %d time series segment\n", path, level);
+        munmap(header, (size_t)info.st_size);
+        errno = EINVAL;
+        return NULL;
+    }
+
+    *size = (size_t)info.st_size;
+    return header;
+}
+
+//==================================================FUNCTION========================|
+//Name:           ts_encode                                                          |
+//Params:         const TsRecord* record The record.                                 |
+//                uint64_t start_s       Start time to store.                        |
+//                unsigned char* out     TS_RECORD_MAX bytes.                        |
+//Returns:        int                    Bytes written.                              |
+//Outputs:        NONE                                                              |
+//Description:    This function lays out a record, counts as LEB128 varints.         |
+//==================================================================================|
+static int ts_encode(const TsRecord *record, uint64_t start_s, unsigned char *out) {
+    unsigned char *p = out + TS_RECORD_HEADER;
+    uint64_t value;
+    int i;
+
+    for (i = 0; i < record->bin_count; i++) {
+        value = record->counts[i];
+        while (value >= 0x80) {
+            *p++ = (unsigned char)(value | 0x80);
+            value >>= 7;
+        }
+        *p++ = (unsigned char)value;
+    }
+
+    memcpy(out, &start_s, sizeof(start_s));
+    out[8] = (unsigned char)((p - out - TS_RECORD_HEADER) & 0xff);
+    out[9] = (unsigned char)((p - out - TS_RECORD_HEADER) >> 8);
+    out[10] = (unsigned char)record->first_key;
+    out[11] = (unsigned char)record->bin_count;
+    memset(out + 12, 0, 4);
+
+    return (int)(p - out);
+}
+
+//==================================================FUNCTION========================|
+//Name:           ts_decode                                                          |
+//Params:         const unsigned char* in  Start of a record.                        |
+//                uint64_t avail         Bytes left in the data area.                |
+//                TsRecord* record       Receives the record.                        |
+//Returns:        int                    Bytes used, or -1 if the record is corrupt. |
+//Outputs:        NONE                                                              |
+//Description:    This function reads a record written by ts_encode.                 |
+//==================================================================================|
+static int ts_decode(const unsigned char *in, uint64_t avail, TsRecord *record) {
+    const unsigned char *p;
+    const unsigned char *end;
+    uint64_t value;
+    int shift;
+    int len;
+    int i;
+
+    if (avail < TS_RECORD_HEADER) {
+        return -1;
+    }
+    len = in[8] | (in[9] << 8);
+    if ((uint64_t)TS_RECORD_HEADER + (uint64_t)len > avail || in[11] > TS_MAX_BINS) {
+        return -1;
+    }
+
+    memcpy(&record->start_s, in, sizeof(record->start_s));
+    record->first_key = in[10];
+    record->bin_count = in[11];
+    p = in + TS_RECORD_HEADER;
+    end = p + len;
+    for (i = 0; i < record->bin_count; i++) {
+        value = 0;
+        shift = 0;
+        do {
+            if (p >= end || shift > 63) {
+                return -1;
+            }
+            value |= (uint64_t)(*p & 0x7f) << shift;
+            shift += 7;
+        } while (*p++ & 0x80);
+        record->counts[i] = value;
+    }
+
+    return TS_RECORD_HEADER + len;
+}
+
+//==================================================FUNCTION========================|
+//Name:           ts_writer_create                                                   |
+//Params:         TsWriter* writer       The writer; its old segment is unmapped.    |
+//                int sequence           Number of the new segment.                  |
+//                uint64_t covered_until Carried over from the previous segment.     |
+//Returns:        int                    0 on success, -1 on failure.                |
+//Outputs:        Prints an error on failure                                        |
+//Description:    This function creates, sizes and maps a new segment.               |
+//==================================================================================|
+static int ts_writer_create(TsWriter *writer, int sequence, uint64_t covered_until) {
+    char path[4200];
+    size_t size = TS_HEADER_SIZE + (size_t)writer->data_size;
+    void *map;
+    int fd;
+
+    if (writer->header != NULL) {
+        munmap(writer->header, writer->map_size);
+        writer->header = NULL;
+    }
+
+    ts_segment_path(writer->prefix, writer->level, sequence, path, sizeof(path));
+    fd = open(path, O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd == -1) {
+        perror(path);
+        return -1;
+    }
+    if (ftruncate(fd, (off_t)size) == -1) {
+        perror(path);
+        close(fd);
+        return -1;
+    }
+    map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        perror(path);
+        return -1;
+    }
+
+    writer->header = (TsHeader *)map;
+    writer->data = (unsigned char *)map + TS_HEADER_SIZE;
+    writer->map_size = size;
+    writer->sequence = sequence;
+    memcpy(writer->header->magic, TS_MAGIC, TS_MAGIC_SIZE);
+    writer->header->level = (uint32_t)writer->level;
+    writer->header->span_s = writer->span_s;
+    writer->header->data_size = writer->data_size;
+    writer->header->covered_until = covered_until;
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           ts_writer_open                                                     |
+//Params:         TsWriter* writer       The writer to set up.                       |
+//                const char* prefix     The series prefix.                          |
+//                int level              The level this writer appends to.           |
+//                uint32_t span_s        Seconds per record.                         |
+//                uint64_t data_size     Data bytes per new segment.                 |
+//Returns:        int                    0 on success, -1 on failure.                |
+//Outputs:        Prints an error on failure                                        |
+//Description:    This function maps the newest segment of the level to append to,  |
+//                or creates the first one. A new segment is also started when the  |
+//                interval changed, so every segment has one span.                   |
+//==================================================================================|
+int ts_writer_open(TsWriter *writer, const char *prefix, int level, uint32_t span_s,
+                   uint64_t data_size) {
+    char path[4200];
+    struct stat info;
+    size_t size;
+    int sequence = 0;
+
+    memset(writer, 0, sizeof(*writer));
+    if (strlen(prefix) >= sizeof(writer->prefix)) {
+        fprintf(stderr, "time series prefix too long\n");
+        return -1;
+    }
+    strcpy(writer->prefix, prefix);
+    writer->level = level;
+    writer->span_s = span_s;
+    writer->data_size = data_size;
+
+    for (;;) {
+        ts_segment_path(prefix, level, sequence + 1, path, sizeof(path));
+        if (stat(path, &info) == -1) {
+            break;
+        }
+        sequence++;
+    }
+
+    ts_segment_path(prefix, level, sequence, path, sizeof(path));
+    writer->header = ts_map(path, level, 1, &size);
+    if (writer->header == NULL) {
+        if (errno != ENOENT) {
+            return -1;
+        }
+        return ts_writer_create(writer, 0, 0);
+    }
+    writer->data = (unsigned char *)writer->header + TS_HEADER_SIZE;
+    writer->map_size = size;
+    writer->sequence = sequence;
+
+    if (writer->header->span_s != span_s) {
+        return ts_writer_create(writer, sequence + 1, writer->header->covered_until);
+    }
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           ts_writer_append                                                   |
+//Params:         TsWriter* writer       An open writer.                             |
+//                const TsRecord* record The record to append.                       |
+//Returns:        int                    0 on success, -1 on failure.                |
+//Outputs:        NONE                                                              |
+//Description:    This function appends a record, starting a new segment when the   |
+//                data area or the index is full. A start time before the newest    |
+//                record's, after the clock was set back, is raised to it to keep   |
+//                the series in order.                                              |
+//==================================================================================|
+int ts_writer_append(TsWriter *writer, const TsRecord *record) {
+    unsigned char buf[TS_RECORD_MAX];
+    TsHeader *header = writer->header;
+    uint64_t start_s = record->start_s;
+    uint64_t used;
+    int indexed;
+    int len;
+
+    if (header == NULL || record->bin_count < 0 || record->bin_count > TS_MAX_BINS) {
+        return -1;
+    }
+    if (header->record_count > 0 && start_s < header->last_s) {
+        start_s = header->last_s;
+    }
+    len = ts_encode(record, start_s, buf);
+
+    indexed = (header->record_count % TS_INDEX_STRIDE) == 0;
+    if (header->data_used + (uint64_t)len > header->data_size ||
+        (indexed && header->index_count >= TS_INDEX_MAX)) {
+        if (ts_writer_create(writer, writer->sequence + 1, header->covered_until) == -1) {
+            return -1;
+        }
+        header = writer->header;
+        indexed = 1;
+    }
+
+    used = header->data_used;
+    memcpy(writer->data + used, buf, (size_t)len);
+    if (indexed) {
+        header->index[header->index_count].start_s = start_s;
+        header->index[header->index_count].offset = (uint32_t)used;
+        __atomic_store_n(&header->index_count, header->index_count + 1, __ATOMIC_RELEASE);
+    }
+    if (header->record_count == 0) {
+        header->first_s = start_s;
+    }
+    header->last_s = start_s;
+    header->record_count++;
+    __atomic_store_n(&header->data_used, used + (uint64_t)len, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           ts_writer_close                                                    |
+//Params:         TsWriter* writer       The writer.                                 |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function unmaps the segment; the kernel writes it back.       |
+//==================================================================================|
+void ts_writer_close(TsWriter *writer) {
+    if (writer->header != NULL) {
+        munmap(writer->header, writer->map_size);
+        writer->header = NULL;
+    }
+}
+
+//==================================================FUNCTION========================|
+//Name:           ts_scan                                                            |
+//Params:         const char* prefix     The series prefix.                          |
+//                int level              The level to read.                          |
+//                uint64_t from_s        First start time wanted.                    |
+//                uint64_t to_s          End of the range, exclusive.                |
+//                TsVisit visit          Called for each record in the range.        |
+//                void* ctx              Passed to 'visit'.                          |
+//                TsStats* stats         Updated with the work done; may be NULL.    |
+//Returns:        int                    0 on success, -1 on a bad segment or when   |
+//                                       'visit' stopped the scan.                   |
+//Outputs:        Prints an error for a corrupt segment                             |
+//Description:    This function visits, in order, the records of a level whose start |
+//                time is in [from_s, to_s). Segments that end before the range are  |
+//                skipped on their header alone, and within a segment the sparse     |
+//                index finds the last indexed record before the range, so at most   |
+//                TS_INDEX_STRIDE records are read before the first one wanted.      |
+//==================================================================================|
+int ts_scan(const char *prefix, int level, uint64_t from_s, uint64_t to_s, TsVisit visit,
+            void *ctx, TsStats *stats) {
+    char path[4200];
+    const TsHeader *header;
+    const unsigned char *data;
+    TsRecord record;
+    uint64_t used;
+    uint64_t offset;
+    uint32_t count;
+    uint32_t lo, hi, mid;
+    size_t size;
+    int sequence;
+    int result = 0;
+    int done = 0;
+    int len;
+
+    for (sequence = 0; !done; sequence++) {
+        ts_segment_path(prefix, level, sequence, path, sizeof(path));
+        header = ts_map(path, level, 0, &size);
+        if (header == NULL) {
+            return (errno == ENOENT) ? result : -1;
+        }
+        if (stats != NULL) {
+            stats->segments++;
+        }
+        data = (const unsigned char *)header + TS_HEADER_SIZE;
+        used = __atomic_load_n(&header->data_used, __ATOMIC_ACQUIRE);
+        count = __atomic_load_n(&header->index_count, __ATOMIC_ACQUIRE);
+
+        if (used == 0 || header->last_s < from_s) {
+            munmap((void *)header, size);
+            continue;
+        }
+        if (header->first_s >= to_s) {
+            munmap((void *)header, size);
+            break;
+        }
+
+        lo = 0;
+        hi = count;
+        while (lo < hi) {
+            mid = lo + (hi - lo) / 2;
+            if (header->index[mid].start_s < from_s) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        offset = (lo > 0) ? header->index[lo - 1].offset : 0;
+
+        while (offset < used) {
+            len = ts_decode(data + offset, used - offset, &record);
+            if (len == -1) {
+                fprintf(stderr, "%s: corrupt record at %llu\n", path, (unsigned long long)offset);
+                result = -1;
+                break;
+            }
+            offset += (uint64_t)len;
+            if (stats != NULL) {
+                stats->records++;
+            }
+            if (record.start_s >= to_s) {
+                done = 1;
+                break;
+            }
+            if (record.start_s >= from_s && visit(ctx, &record) == -1) {
+                result = -1;
+                done = 1;
+                break;
+            }
+        }
+        munmap((void *)header, size);
+    }
+
+    return result;
+}
+
+//==================================================FUNCTION========================|
+//Name:           ts_covered_until                                                   |
+//Params:         const char* prefix     The series prefix.                          |
+//                int level              A rollup level.                             |
+//Returns:        uint64_t               End of the periods rolled up at the level,  |
+//                                       0 if none; UINT64_MAX for level 0.          |
+//Outputs:        NONE                                                              |
+//Description:    This function reads covered_until from the newest segment.         |
+//==================================================================================|
+uint64_t ts_covered_until(const char *prefix, int level) {
+    char path[4200];
+    const TsHeader *header;
+    struct stat info;
+    uint64_t covered;
+    size_t size;
+    int sequence = 0;
+
+    if (level == 0) {
+        return UINT64_MAX;
+    }
+    for (;;) {
+        ts_segment_path(prefix, level, sequence + 1, path, sizeof(path));
+        if (stat(path, &info) == -1) {
+            break;
+        }
+        sequence++;
+    }
+
+    ts_segment_path(prefix, level, sequence, path, sizeof(path));
+    header = ts_map(path, level, 0, &size);
+    if (header == NULL) {
+        return 0;
+    }
+    covered = __atomic_load_n(&header->covered_until, __ATOMIC_ACQUIRE);
+    munmap((void *)header, size);
+
+    return covered;
+}
+
+//==================================================FUNCTION========================|
+//Name:           ts_record_add                                                      |
+//Params:         TsRecord* sum          The running sum.                            |
+//                const TsRecord* record A record to add.                            |
+//Returns:        NONE                                                              |
+//Outputs:        NONE                                                              |
+//Description:    This function adds one record's bins into another's. The bin      |
+//                range grows to cover both, up to TS_MAX_BINS; keys beyond that     |
+//                are left out.                                                      |
+//==================================================================================|
+static void ts_record_add(TsRecord *sum, const TsRecord *record) {
+    int first;
+    int last;
+    int shift;
+    int key;
+    int i;
+
+    if (sum->bin_count == 0) {
+        sum->first_key = record->first_key;
+        sum->bin_count = record->bin_count;
+        memcpy(sum->counts, record->counts, sizeof(uint64_t) * (size_t)record->bin_count);
+        return;
+    }
+
+    first = (record->first_key < sum->first_key) ? record->first_key : sum->first_key;
+    last = sum->first_key + sum->bin_count;
+    if (record->first_key + record->bin_count > last) {
+        last = record->first_key + record->bin_count;
+    }
+    if (last - first > TS_MAX_BINS) {
+        last = first + TS_MAX_BINS;
+    }
+    shift = sum->first_key - first;
+    if (shift > 0) {
+        memmove(sum->counts + shift, sum->counts, sizeof(uint64_t) * (size_t)(TS_MAX_BINS - shift));
+        memset(sum->counts, 0, sizeof(uint64_t) * (size_t)shift);
+    }
+    for (i = sum->bin_count + shift; i < last - first; i++) {
+        sum->counts[i] = 0;
+    }
+    sum->first_key = first;
+    sum->bin_count = last - first;
+
+    for (i = 0; i < record->bin_count; i++) {
+        key = record->first_key + i;
+        if (key < last) {
+            sum->counts[key - first] += record->counts[i];
+        }
+    }
+}
+
+//==================================================FUNCTION========================|
+//Name:           ts_rollup_flush                                                    |
+//Params:         TsRollup* rollup       The rollup with a finished period's sum.    |
+//Returns:        int                    0 on success, -1 if the append failed.      |
+//Outputs:        NONE                                                              |
+//Description:    This function appends the period's sum and moves covered_until to  |
+//                the period's end right after it. A period that already has a      |
+//                record, because DC died between the two steps, is not appended a  |
+//                second time.                                                      |
+//==================================================================================|
+static int ts_rollup_flush(TsRollup *rollup) {
+    TsHeader *header = rollup->upper->header;
+
+    if (header->record_count == 0 || rollup->sum.start_s > header->last_s) {
+        if (ts_writer_append(rollup->upper, &rollup->sum) == -1) {
+            return -1;
+        }
+        header = rollup->upper->header;
+    }
+    __atomic_store_n(&header->covered_until, rollup->sum.start_s + rollup->span,
+                     __ATOMIC_RELEASE);
+    rollup->sum.bin_count = 0;
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           ts_rollup_visit                                                    |
+//Params:         void* ctx              The TsRollup in progress.                   |
+//                const TsRecord* record A record of the level below.                |
+//Returns:        int                    0, or -1 if an append failed.               |
+//Outputs:        NONE                                                              |
+//Description:    This function adds a record to its period's sum, appending the    |
+//                previous period's sum first when the period changes.              |
+//==================================================================================|
+static int ts_rollup_visit(void *ctx, const TsRecord *record) {
+    TsRollup *rollup = (TsRollup *)ctx;
+    uint64_t period = record->start_s / rollup->span * rollup->span;
+
+    if (rollup->sum.bin_count > 0 && rollup->sum.start_s != period) {
+        if (ts_rollup_flush(rollup) == -1) {
+            rollup->failed = 1;
+            return -1;
+        }
+    }
+    ts_record_add(&rollup->sum, record);
+    rollup->sum.start_s = period;
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           ts_rollup                                                          |
+//Params:         TsWriter* upper        Writer of a rollup level.                   |
+//                const char* prefix     The series prefix.                          |
+//                uint64_t until_s       Roll up the periods ending by this time.    |
+//Returns:        int                    0 on success, -1 on failure.                |
+//Outputs:        NONE                                                              |
+//Description:    This function sums the level below into one record per period,    |
+//                from the level's covered_until to until_s rounded down to a whole  |
+//                period, and no further than the level below is complete. Empty    |
+//                periods are skipped. covered_until follows each appended period,  |
+//                so called again after a restart, it catches up on everything      |
+//                missed without counting a period twice.                           |
+//==================================================================================|
+int ts_rollup(TsWriter *upper, const char *prefix, uint64_t until_s) {
+    TsRollup rollup;
+    uint64_t from_s;
+    uint64_t lower;
+
+    memset(&rollup, 0, sizeof(rollup));
+    rollup.upper = upper;
+    rollup.span = ts_level_span(upper->level);
+    if (rollup.span == 0 || upper->header == NULL) {
+        return -1;
+    }
+
+    until_s = until_s / rollup.span * rollup.span;
+    lower = ts_covered_until(prefix, upper->level - 1);
+    if (until_s > lower) {
+        until_s = lower / rollup.span * rollup.span;
+    }
+    from_s = upper->header->covered_until;
+    if (from_s >= until_s) {
+        return 0;
+    }
+
+    if (ts_scan(prefix, upper->level - 1, from_s, until_s, ts_rollup_visit, &rollup, NULL) == -1 &&
+        rollup.failed) {
+        return -1;
+    }
+    if (rollup.sum.bin_count > 0 && ts_rollup_flush(&rollup) == -1) {
+        return -1;
+    }
+    __atomic_store_n(&upper->header->covered_until, until_s, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           ts_sum_visit                                                       |
+//Params:         void* ctx              256 counts indexed by key.                  |
+//                const TsRecord* record A record in the range.                      |
+//Returns:        int                    0                                           |
+//Outputs:        NONE                                                              |
+//Description:    This function adds a record to a query's result.                  |
+//==================================================================================|
+static int ts_sum_visit(void *ctx, const TsRecord *record) {
+    uint64_t *counts = (uint64_t *)ctx;
+    int i;
+
+    for (i = 0; i < record->bin_count && record->first_key + i < 256; i++) {
+        counts[record->first_key + i] += record->counts[i];
+    }
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           ts_sum_level                                                       |
+//Params:         const char* prefix     The series prefix.                          |
+//                int level              Highest level to use.                       |
+//                uint64_t from_s        Start of the range.                         |
+//                uint64_t to_s          End of the range, exclusive.                |
+//                uint64_t* counts       256 counts to add to.                       |
+//                TsStats* stats         Updated with the work done; may be NULL.    |
+//Returns:        int                    0 on success, -1 on failure.                |
+//Outputs:        NONE                                                              |
+//Description:    This function reads the whole periods of 'level' inside the range |
+//                that the level has rolled up, and the ends on either side one     |
+//                level down.                                                       |
+//==================================================================================|
+static int ts_sum_level(const char *prefix, int level, uint64_t from_s, uint64_t to_s,
+                        uint64_t *counts, TsStats *stats) {
+    uint64_t span;
+    uint64_t lo;
+    uint64_t hi;
+    uint64_t covered;
+
+    if (from_s >= to_s) {
+        return 0;
+    }
+    if (level == 0) {
+        return ts_scan(prefix, 0, from_s, to_s, ts_sum_visit, counts, stats);
+    }
+
+    span = ts_level_span(level);
+    lo = (from_s + span - 1) / span * span;
+    hi = to_s / span * span;
+    covered = ts_covered_until(prefix, level);
+    if (hi > covered) {
+        hi = covered;
+    }
+    if (lo >= hi) {
+        return ts_sum_level(prefix, level - 1, from_s, to_s, counts, stats);
+    }
+
+    if (ts_sum_level(prefix, level - 1, from_s, lo, counts, stats) == -1 ||
+        ts_scan(prefix, level, lo, hi, ts_sum_visit, counts, stats) == -1 ||
+        ts_sum_level(prefix, level - 1, hi, to_s, counts, stats) == -1) {
+        return -1;
+    }
+    return 0;
+}
+
+//==================================================FUNCTION========================|
+//Name:           ts_sum                                                             |
+//Params:         const char* prefix     The series prefix.                          |
+//                uint64_t from_s        Start of the range, seconds since the epoch.|
+//                uint64_t to_s          End of the range, exclusive.                |
+//                uint64_t counts[256]   Receives the counts by key.                 |
+//                TsStats* stats         Receives the work done; may be NULL.        |
+//Returns:        int                    0 on success, -1 on failure.                |
+//Outputs:        NONE                                                              |
+//Description:    This function sums every interval that starts in the range, so    |
+//                the ends are as fine as DC's interval. A month costs about 30 day |
+//                records, up to 46 hour records and up to two hours of intervals.  |
+//==================================================================================|
+int ts_sum(const char *prefix, uint64_t from_s, uint64_t to_s, uint64_t counts[256],
+           TsStats *stats) {
+    memset(counts, 0, 256 * sizeof(uint64_t));
+    if (stats != NULL) {
+        memset(stats, 0, sizeof(*stats));
+    }
+
+    return ts_sum_level(prefix, TS_LEVELS - 1, from_s, to_s, counts, stats);
+}